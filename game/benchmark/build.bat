@@ -0,0 +1,22 @@
+REM Build script for benchmark
+@ECHO OFF
+SetLocal EnableDelayedExpansion
+
+REM Engine sources, minus the game entry point.
+SET cFilenames=
+FOR /R ..\engine\src %%f in (*.cpp) do (
+    IF /I NOT "%%~nxf"=="main.cpp" SET cFilenames=!cFilenames! %%f
+)
+
+FOR /R src %%f in (*.cpp) do (
+    SET cFilenames=!cFilenames! %%f
+)
+
+SET assembly=benchmark
+SET compilerFlags=-g -O2 -Wvarargs -Wall -Werror
+SET includeFlags=-std=c++17 -Isrc -I../engine/src -I../engine/src/vendor -I%VULKAN_SDK%/Include
+SET linkerFlags=-luser32 -lglfw3 -lgdi32  -lvulkan-1 -L%VULKAN_SDK%/Lib
+SET defines=-DEM_EXPORT -D_CRT_SECURE_NO_WARNINGS
+
+ECHO "Building %assembly%%..."
+g++ %cFilenames% %compilerFlags% -o ../bin/%assembly%.exe %defines% %includeFlags% %linkerFlags%
@@ -0,0 +1,20 @@
+#!/bin/bash
+# Build script for benchmark (Linux build boxes, e.g. lavapipe)
+set -e
+
+# Engine sources, minus the game entry point.
+cFilenames="$(find ../engine/src -type f -name '*.cpp' ! -path '../engine/src/main.cpp')"
+cFilenames="$cFilenames $(find src -type f -name '*.cpp')"
+
+assembly=benchmark
+compilerFlags="-g -O2 -Wvarargs -Wall -Werror"
+includeFlags="-std=c++17 -Isrc -I../engine/src -I../engine/src/vendor"
+linkerFlags="-lglfw -lvulkan -lpthread"
+defines="-DEM_EXPORT"
+
+# The renderer loads src/shaders/*.spv relative to game/engine.
+(cd ../engine && ./compile-shaders.sh)
+
+mkdir -p ../bin
+echo "Building $assembly..."
+g++ $cFilenames $compilerFlags -o ../bin/$assembly $defines $includeFlags $linkerFlags
@@ -0,0 +1,218 @@
+#include "Benchmark.h"
+#include "core/ECS/EntityCommandBuffer.h"
+#include "core/ECS/World.h"
+#include "core/Jobs/JobSystem.h"
+#include "core/Loop/GameLoop.h"
+#include "core/Memory/AllocationHook.h"
+#include "core/Memory/Memory.h"
+#include "core/Memory/StackAllocator.h"
+#include "core/Renderer/Renderer.h"
+#include <stdio.h>
+
+const u32 ALLOCATION_WARMUP_FRAMES = 60;
+const u32 ALLOCATION_ENTITIES = 10000;
+const u32 ALLOCATION_SPAWNS_PER_FRAME = 64;
+
+struct AllocPosition {
+    f32 X, Y;
+};
+
+struct AllocVelocity {
+    f32 X, Y;
+};
+
+struct AllocLifetime {
+    u32 FramesLeft;
+};
+
+struct FrameCheck {
+    u32 FramesMeasured;
+    u32 FramesAllocating;
+    u64 Violations;
+    u64 Allowed;        // inside a ScopedAllocationAllowance
+    u64 LastViolations;
+};
+
+// Only allocations the guard objects to count against a frame; a resize or
+// a tile rebuild under an allowance does not.
+static void CloseFrame(FrameCheck& check, u32 frame) {
+    Memory::EndFrame();
+
+    u64 violations = AllocationHook::GetGuardViolations();
+    u64 frameViolations = violations - check.LastViolations;
+    check.LastViolations = violations;
+
+    if (frame < ALLOCATION_WARMUP_FRAMES) {
+        return;
+    }
+
+    check.FramesMeasured++;
+    u64 frameAllocations = AllocationHook::GetFrameAllocations();
+    check.Allowed += frameAllocations > frameViolations ? frameAllocations - frameViolations : 0;
+    if (frameViolations > 0) {
+        check.FramesAllocating++;
+        check.Violations += frameViolations;
+    }
+}
+
+static bool PrintCheck(const char* name, const FrameCheck& check) {
+    printf("%-10s %u of %u steady-state frames allocated, %llu allocations (%llu allowed)\n", name, check.FramesAllocating,
+           check.FramesMeasured, (unsigned long long)check.Violations, (unsigned long long)check.Allowed);
+
+    return check.FramesAllocating == 0;
+}
+
+// Game-side frame without the GPU: fixed ticks over an ECS world on the job
+// system, with entities expiring and respawning through command buffers,
+// frame-arena and stack scratch, and sprite batching into a CPU buffer.
+static bool RunSimulationFrames(JobSystem& jobs, u32 frameCount) {
+    World world;
+    world.Initialize(ALLOCATION_ENTITIES + ALLOCATION_SPAWNS_PER_FRAME);
+    for (u32 i = 0; i < ALLOCATION_ENTITIES; i++) {
+        world.Create(AllocPosition{(f32)i, 0.0f}, AllocVelocity{1.0f, 0.5f}, AllocLifetime{1 + i % 200});
+    }
+
+    std::vector<EntityCommandBuffer> commands(jobs.GetWorkerCount());
+    StackAllocator scratch;
+    scratch.Initialize(1024 * 1024, "scratch");
+    SpriteBatch sprites;
+    std::vector<SpriteInstance> instances(MAX_SPRITES_PER_FRAME);
+
+    GameLoop loop;
+    loop.Initialize();
+
+    FrameCheck check{};
+    check.LastViolations = AllocationHook::GetGuardViolations();
+    for (u32 frame = 0; frame < ALLOCATION_WARMUP_FRAMES + frameCount; frame++) {
+        u32 ticks = loop.Advance(1.0 / 60.0);
+        for (u32 t = 0; t < ticks; t++) {
+            world.ParallelForEach<AllocPosition, AllocVelocity, AllocLifetime>(jobs, [&](u32 count, const Entity* entities, AllocPosition* positions, AllocVelocity* velocities, AllocLifetime* lifetimes) {
+                EntityCommandBuffer& buffer = commands[jobs.GetCurrentWorker()];
+                for (u32 i = 0; i < count; i++) {
+                    positions[i].X += velocities[i].X;
+                    positions[i].Y += velocities[i].Y;
+                    if (--lifetimes[i].FramesLeft == 0) {
+                        buffer.Destroy(entities[i]);
+                        Entity spawned = buffer.Create();
+                        buffer.Add(spawned, AllocPosition{0.0f, 0.0f});
+                        buffer.Add(spawned, AllocVelocity{1.0f, 0.5f});
+                        buffer.Add(spawned, AllocLifetime{200});
+                    }
+                }
+            });
+            for (EntityCommandBuffer& buffer : commands) {
+                buffer.Playback(world);
+            }
+        }
+
+        {
+            ScopedStack frameScratch(scratch);
+            u32* visible = frameScratch.AllocateArray<u32>(ALLOCATION_ENTITIES, MEMORY_TAG_SCENE);
+            AllocPosition* positions = Memory::AllocateFrameArray<AllocPosition>(ALLOCATION_ENTITIES, MEMORY_TAG_GAME);
+
+            u32 visibleCount = 0;
+            world.ForEach<AllocPosition>([&](u32 count, const Entity* entities, AllocPosition* chunkPositions) {
+                for (u32 i = 0; i < count && visibleCount < ALLOCATION_ENTITIES; i++) {
+                    positions[visibleCount] = chunkPositions[i];
+                    visible[visibleCount] = entities[i].Index;
+                    visibleCount++;
+                }
+            });
+
+            for (u32 i = 0; i < visibleCount; i++) {
+                Sprite sprite{};
+                sprite.Position = glm::vec2(positions[i].X, positions[i].Y);
+                sprite.Size = glm::vec2(8.0f, 8.0f);
+                sprite.Color = 0xffffffff;
+                sprite.UV = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+                sprite.Layer = visible[i] % 4;
+                sprites.Submit(sprite);
+            }
+        }
+        sprites.Flush(instances.data(), (u32)instances.size());
+
+        CloseFrame(check, frame);
+    }
+
+    scratch.Shutdown();
+    world.Shutdown();
+
+    return PrintCheck("simulation", check);
+}
+
+// The headless renderer's Draw with sprites and objects, recording on the
+// job system's workers. Headless frames render into offscreen images, so
+// swapchain acquire and present and the swapchain framebuffers are not
+// covered; a clean run says nothing about those.
+static bool RunRendererFrames(JobSystem& jobs, u32 frameCount, u32 spriteCount) {
+    Renderer renderer;
+    renderer.Jobs = &jobs;
+    if (!renderer.InitializeHeadless("Splintered Allocation Benchmark", 1280, 720)) {
+        printf("renderer: skipped, no headless renderer\n");
+        return true;
+    }
+
+    FrameCheck check{};
+    check.LastViolations = AllocationHook::GetGuardViolations();
+    for (u32 frame = 0; frame < ALLOCATION_WARMUP_FRAMES + frameCount; frame++) {
+        for (u32 i = 0; i < spriteCount; i++) {
+            Sprite sprite{};
+            sprite.Position = glm::vec2((f32)(i % 1280), (f32)((i / 1280) % 720));
+            sprite.Size = glm::vec2(4.0f, 4.0f);
+            sprite.Color = 0xffffffff;
+            sprite.UV = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            sprite.Layer = (i * 7) % 16;
+            renderer.Sprites.Submit(sprite);
+        }
+        for (u32 i = 0; i < 256; i++) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((f32)(i * 5 % 1280), (f32)(i * 3 % 720), 0.0f));
+            renderer.SubmitObject(glm::scale(model, glm::vec3(16.0f, 16.0f, 1.0f)));
+        }
+
+        renderer.Draw();
+        CloseFrame(check, frame);
+    }
+
+    AllocationHook::SetGuard(ALLOCATION_GUARD_OFF);
+    vkDeviceWaitIdle(renderer.GetLogicalDevice());
+    renderer.Shutdown();
+
+    return PrintCheck("renderer", check);
+}
+
+// Checks that frames stop allocating once warmed up. The guard reports the
+// call stack of every site that still does, and the suite fails if any
+// steady-state frame allocated outside an allowance. Only the simulation and
+// the headless renderer are run; see RunRendererFrames.
+int RunAllocationBenchmark(int argc, char** argv) {
+    u32 frameCount = ParseArgument(argc, argv, 1, 600);
+    u32 spriteCount = ParseArgument(argc, argv, 2, 20000);
+
+    if (!AllocationHook::IsEnabled()) {
+        printf("allocations: skipped, built without EM_ALLOCATION_HOOK\n");
+        return 0;
+    }
+
+    Memory::Initialize();
+    JobSystem jobs;
+    if (!jobs.Initialize()) {
+        printf("failed to initialize job system\n");
+        return 1;
+    }
+
+    printf("allocations: %u frames after %u warmup, %u workers\n", frameCount, ALLOCATION_WARMUP_FRAMES, jobs.GetWorkerCount());
+
+    AllocationHook::SetGuard(ALLOCATION_GUARD_REPORT, ALLOCATION_WARMUP_FRAMES);
+    bool simulationClean = RunSimulationFrames(jobs, frameCount);
+    AllocationHook::SetGuard(ALLOCATION_GUARD_OFF);
+
+    // The guard's warmup starts over for the renderer's own warmup frames.
+    AllocationHook::SetGuard(ALLOCATION_GUARD_REPORT, ALLOCATION_WARMUP_FRAMES);
+    bool rendererClean = RunRendererFrames(jobs, frameCount, spriteCount);
+    AllocationHook::SetGuard(ALLOCATION_GUARD_OFF);
+
+    jobs.Shutdown();
+    Memory::Shutdown();
+
+    return simulationClean && rendererClean ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+static f64 Percentile(const std::vector<f64>& sorted, f64 percentile) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+
+    size_t index = (size_t)(percentile * (f64)(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+SampleStats ComputeSampleStats(std::vector<f64>& samples) {
+    SampleStats stats{};
+    stats.Count = (u32)samples.size();
+
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    f64 sum = 0.0;
+    for (f64 sample : samples) {
+        sum += sample;
+    }
+
+    stats.Average = sum / (f64)samples.size();
+    stats.Min = samples.front();
+    stats.Max = samples.back();
+    stats.P50 = Percentile(samples, 0.50);
+    stats.P95 = Percentile(samples, 0.95);
+    stats.P99 = Percentile(samples, 0.99);
+
+    return stats;
+}
+
+void PrintSampleStats(const char* name, const SampleStats& stats) {
+    printf("%-24s n=%-7u avg=%9.4f min=%9.4f p50=%9.4f p95=%9.4f p99=%9.4f max=%9.4f (ms)\n",
+           name, stats.Count, stats.Average, stats.Min, stats.P50, stats.P95, stats.P99, stats.Max);
+}
+
+u32 ParseArgument(int argc, char** argv, int index, u32 fallback) {
+    if (index >= argc) {
+        return fallback;
+    }
+
+    long value = strtol(argv[index], nullptr, 10);
+    return value > 0 ? (u32)value : fallback;
+}
+
+f64 ElapsedMs(BenchmarkClock::time_point start) {
+    return std::chrono::duration<f64, std::milli>(BenchmarkClock::now() - start).count();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <chrono>
+#include <vector>
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+// Summary of a set of timing samples, all values in milliseconds.
+struct SampleStats {
+    u32 Count;
+    f64 Average;
+    f64 Min;
+    f64 Max;
+    f64 P50;
+    f64 P95;
+    f64 P99;
+};
+
+SampleStats ComputeSampleStats(std::vector<f64>& samples);
+void PrintSampleStats(const char* name, const SampleStats& stats);
+u32 ParseArgument(int argc, char** argv, int index, u32 fallback);
+f64 ElapsedMs(BenchmarkClock::time_point start);
+
+int RunRendererBenchmark(int argc, char** argv);
+int RunRecordingBenchmark(int argc, char** argv);
+int RunSpatialBenchmark(int argc, char** argv);
+int RunTileBenchmark(int argc, char** argv);
+int RunJobBenchmark(int argc, char** argv);
+int RunEcsBenchmark(int argc, char** argv);
+int RunLoopBenchmark(int argc, char** argv);
+int RunMemoryBenchmark(int argc, char** argv);
+int RunAllocationBenchmark(int argc, char** argv);
@@ -0,0 +1,111 @@
+#include "Benchmark.h"
+#include "core/ECS/EntityCommandBuffer.h"
+#include "core/ECS/World.h"
+#include "core/Jobs/JobSystem.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <stdio.h>
+
+const u32 ECS_CHURN_DIVISOR = 100;   // entities replaced per round, as a fraction
+
+struct BenchPosition {
+    glm::vec2 Value;
+};
+
+struct BenchVelocity {
+    glm::vec2 Value;
+};
+
+struct BenchLifetime {
+    f32 Remaining;
+};
+
+static void Integrate(u32 count, const Entity* entities, BenchPosition* positions, const BenchVelocity* velocities) {
+    for (u32 i = 0; i < count; i++) {
+        positions[i].Value += velocities[i].Value * (1.0f / 60.0f);
+    }
+}
+
+// Moves every entity each round, sequentially and on the job system, and
+// replaces a fraction of them through command buffers. Reports the
+// effective bandwidth of the update next to its time.
+int RunEcsBenchmark(int argc, char** argv) {
+    u32 entityCount = ParseArgument(argc, argv, 1, 1000000);
+    u32 roundCount = ParseArgument(argc, argv, 2, 100);
+
+    JobSystem jobs;
+    jobs.Initialize();
+
+    World world;
+    world.Initialize(entityCount);
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (u32 i = 0; i < entityCount; i++) {
+        BenchPosition position = {glm::vec2((f32)(i % 1024), (f32)(i / 1024))};
+        BenchVelocity velocity = {glm::vec2(1.0f, (f32)(i % 7) - 3.0f)};
+        if (i % 4 == 0) {
+            world.Create(position, velocity, BenchLifetime{(f32)(i % ECS_CHURN_DIVISOR)});
+        } else {
+            world.Create(position, velocity);
+        }
+    }
+    f64 createMs = ElapsedMs(start);
+
+    std::vector<EntityCommandBuffer> commandBuffers(jobs.GetWorkerCount() + 1);
+    std::vector<f64> sequentialSamples;
+    std::vector<f64> parallelSamples;
+    std::vector<f64> churnSamples;
+
+    for (u32 round = 0; round < roundCount; round++) {
+        start = BenchmarkClock::now();
+        world.ForEach<BenchPosition, BenchVelocity>(Integrate);
+        sequentialSamples.push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        world.ParallelForEach<BenchPosition, BenchVelocity>(jobs, Integrate);
+        parallelSamples.push_back(ElapsedMs(start));
+
+        // Expired entities are replaced by fresh ones, recorded per worker
+        // while the query runs and applied once it is done.
+        start = BenchmarkClock::now();
+        world.ParallelForEach<BenchLifetime>(jobs, [&commandBuffers, &jobs](u32 count, const Entity* entities, BenchLifetime* lifetimes) {
+            u32 worker = jobs.GetCurrentWorker();
+            EntityCommandBuffer& commands = commandBuffers[worker == JOB_WORKER_NONE ? commandBuffers.size() - 1 : worker];
+
+            for (u32 i = 0; i < count; i++) {
+                lifetimes[i].Remaining -= 1.0f;
+                if (lifetimes[i].Remaining < 0.0f) {
+                    commands.Destroy(entities[i]);
+
+                    Entity replacement = commands.Create();
+                    commands.Add(replacement, BenchPosition{glm::vec2(0.0f)});
+                    commands.Add(replacement, BenchVelocity{glm::vec2(1.0f, 0.0f)});
+                    commands.Add(replacement, BenchLifetime{(f32)ECS_CHURN_DIVISOR});
+                }
+            }
+        });
+        for (EntityCommandBuffer& commands : commandBuffers) {
+            commands.Playback(world);
+        }
+        churnSamples.push_back(ElapsedMs(start));
+    }
+
+    // Position is read and written, velocity read.
+    f64 bytesPerRound = (f64)world.GetEntityCount() * (2.0 * sizeof(BenchPosition) + sizeof(BenchVelocity));
+    SampleStats sequential = ComputeSampleStats(sequentialSamples);
+    SampleStats parallel = ComputeSampleStats(parallelSamples);
+
+    WorldStats stats = world.GetStats();
+    printf("ecs: %u entities in %u archetypes and %u chunks, %u rounds, %u workers\n",
+           stats.EntityCount, stats.ArchetypeCount, stats.ChunkCount, roundCount, jobs.GetWorkerCount());
+    printf("create %.2f ms (%.1f ns per entity)\n", createMs, createMs * 1e6 / entityCount);
+    PrintSampleStats("update sequential", sequential);
+    printf("    %.2f GB/s\n", bytesPerRound / (sequential.Average * 1e6));
+    PrintSampleStats("update jobs", parallel);
+    printf("    %.2f GB/s, speedup %.2fx\n", bytesPerRound / (parallel.Average * 1e6), sequential.Average / parallel.Average);
+    PrintSampleStats("expire and replace", ComputeSampleStats(churnSamples));
+
+    world.Shutdown();
+    jobs.Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,175 @@
+#include "Benchmark.h"
+#include "core/Jobs/JobSystem.h"
+#include "core/Renderer/Renderer.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vendor/glm/glm/gtc/matrix_transform.hpp>
+#include <stdio.h>
+
+const u32 JOB_BATCH_SIZE = 1024;
+const u32 JOB_RECORDING_WARMUP_FRAMES = 30;
+const u32 JOB_RECORDING_DRAWS = 20000;
+
+struct Transform {
+    glm::vec3 Position;
+    f32 Rotation;
+    glm::vec3 Scale;
+};
+
+struct CullBatch {
+    const ObjectData* Objects;
+    const glm::vec4* Planes;
+    u8* Visible;
+    std::atomic<u32> VisibleCount{0};
+};
+
+static void UpdateTransforms(const Transform* transforms, ObjectData* objects, u32 first, u32 count) {
+    for (u32 i = first; i < first + count; i++) {
+        const Transform& transform = transforms[i];
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), transform.Position);
+        model = glm::rotate(model, transform.Rotation, glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, transform.Scale);
+
+        objects[i].model = model;
+        objects[i].bounds = glm::vec4(transform.Position, 0.5f * glm::length(glm::vec2(transform.Scale)));
+    }
+}
+
+static u32 CullObjects(CullBatch& batch, u32 first, u32 count) {
+    u32 visible = 0;
+    for (u32 i = first; i < first + count; i++) {
+        batch.Visible[i] = GpuCulling::IsVisible(batch.Planes, batch.Objects[i].bounds) ? 1 : 0;
+        visible += batch.Visible[i];
+    }
+
+    return visible;
+}
+
+static void PrintComparison(const char* name, std::vector<f64>& sequential, std::vector<f64>& parallel) {
+    SampleStats sequentialStats = ComputeSampleStats(sequential);
+    SampleStats parallelStats = ComputeSampleStats(parallel);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s sequential", name);
+    PrintSampleStats(label, sequentialStats);
+    snprintf(label, sizeof(label), "%s jobs", name);
+    PrintSampleStats(label, parallelStats);
+    printf("    speedup %.2fx\n", sequentialStats.Average / parallelStats.Average);
+}
+
+// Draw-heavy frames through the headless renderer with the recorder on one
+// partition, then on one partition per worker.
+static void RunRecording(JobSystem& jobs, u32 frameCount) {
+    Renderer renderer;
+    renderer.Jobs = &jobs;
+    renderer.RecordThreadCount = 1;
+    if (!renderer.InitializeHeadless("Splintered Job Benchmark", 1280, 720)) {
+        printf("recording: skipped, no headless renderer\n");
+        return;
+    }
+
+    std::vector<f64> samples[2];
+    for (u32 pass = 0; pass < 2; pass++) {
+        renderer.SetRecordThreadCount(pass == 0 ? 1 : jobs.GetWorkerCount());
+        samples[pass].reserve(frameCount);
+
+        for (u32 frame = 0; frame < JOB_RECORDING_WARMUP_FRAMES + frameCount; frame++) {
+            for (u32 draw = 0; draw < JOB_RECORDING_DRAWS; draw++) {
+                Sprite sprite{};
+                sprite.Position = glm::vec2((f32)(draw % 1280), (f32)((draw / 1280) % 720));
+                sprite.Size = glm::vec2(4.0f, 4.0f);
+                sprite.Color = 0xffffffff;
+                sprite.UV = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+                sprite.Layer = draw;
+                renderer.Sprites.Submit(sprite);
+            }
+            renderer.Draw();
+
+            if (frame >= JOB_RECORDING_WARMUP_FRAMES) {
+                samples[pass].push_back(renderer.LastFrameStats.CpuRecordMs);
+            }
+        }
+    }
+
+    vkDeviceWaitIdle(renderer.GetLogicalDevice());
+    renderer.Shutdown();
+
+    PrintComparison("record", samples[0], samples[1]);
+}
+
+// Runs the same per-frame work sequentially and through ParallelFor on every
+// hardware thread: model matrices from transforms, frustum culling of their
+// bounds, and command recording.
+int RunJobBenchmark(int argc, char** argv) {
+    u32 roundCount = ParseArgument(argc, argv, 1, 100);
+    u32 objectCount = ParseArgument(argc, argv, 2, 1000000);
+
+    JobSystem jobs;
+    if (!jobs.Initialize()) {
+        printf("failed to initialize job system\n");
+        return 1;
+    }
+
+    std::vector<Transform> transforms(objectCount);
+    for (u32 i = 0; i < objectCount; i++) {
+        transforms[i].Position = glm::vec3((f32)((i * 37) % 4096), (f32)((i * 91) % 4096), 0.0f);
+        transforms[i].Rotation = (f32)i * 0.01f;
+        transforms[i].Scale = glm::vec3(16.0f, 16.0f, 1.0f);
+    }
+    std::vector<ObjectData> objects(objectCount);
+    std::vector<u8> visible(objectCount);
+
+    // A quarter of the world in view.
+    glm::vec4 planes[6];
+    GpuCulling::ExtractFrustumPlanes(glm::ortho(0.0f, 2048.0f, 0.0f, 2048.0f, -1.0f, 1.0f), planes);
+
+    CullBatch cull;
+    cull.Objects = objects.data();
+    cull.Planes = planes;
+    cull.Visible = visible.data();
+
+    printf("jobs: %u workers, %u rounds, %u objects\n", jobs.GetWorkerCount(), roundCount, objectCount);
+
+    std::vector<f64> transformSamples[2];
+    std::vector<f64> cullSamples[2];
+    u32 visibleCounts[2] = {0, 0};
+
+    for (u32 round = 0; round < roundCount; round++) {
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        UpdateTransforms(transforms.data(), objects.data(), 0, objectCount);
+        transformSamples[0].push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        jobs.ParallelFor(objectCount, JOB_BATCH_SIZE, [&](u32 first, u32 count) {
+            UpdateTransforms(transforms.data(), objects.data(), first, count);
+        });
+        transformSamples[1].push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        visibleCounts[0] = CullObjects(cull, 0, objectCount);
+        cullSamples[0].push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        cull.VisibleCount = 0;
+        jobs.ParallelFor(objectCount, JOB_BATCH_SIZE, [&](u32 first, u32 count) {
+            cull.VisibleCount.fetch_add(CullObjects(cull, first, count), std::memory_order_relaxed);
+        });
+        cullSamples[1].push_back(ElapsedMs(start));
+        visibleCounts[1] = cull.VisibleCount.load();
+    }
+
+    PrintComparison("transforms", transformSamples[0], transformSamples[1]);
+    PrintComparison("culling", cullSamples[0], cullSamples[1]);
+    if (visibleCounts[0] != visibleCounts[1]) {
+        printf("culling mismatch: %u sequential, %u jobs\n", visibleCounts[0], visibleCounts[1]);
+    }
+
+    RunRecording(jobs, roundCount);
+
+    JobSystemStats stats = jobs.GetStats();
+    printf("jobs run %llu, steals %llu\n", (unsigned long long)stats.JobsRun, (unsigned long long)stats.Steals);
+
+    jobs.Shutdown();
+
+    return 0;
+}
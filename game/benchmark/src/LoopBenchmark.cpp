@@ -0,0 +1,142 @@
+#include "Benchmark.h"
+#include "core/Loop/GameLoop.h"
+#include "core/Renderer/FramePacer.h"
+#include <chrono>
+#include <ctime>
+#include <stdio.h>
+#include <string.h>
+
+const u32 LOOP_PACED_FRAMES = 120;
+
+// Stiff enough that its result depends on the step size, so a variable
+// timestep visibly drifts.
+struct Body {
+    f64 Position;
+    f64 Velocity;
+};
+
+static void StepBody(Body& body, f64 seconds) {
+    body.Velocity += (-40.0 * body.Position - 0.02 * body.Velocity) * seconds;
+    body.Position += body.Velocity * seconds;
+}
+
+// Frame times in seconds for a few frame rate shapes, from a fixed seed.
+static f64 NextFrameSeconds(u32 pattern, u32& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    f64 random = (f64)(seed >> 8) / (f64)(1u << 24);
+
+    switch (pattern) {
+        case 0:
+            return 1.0 / 60.0;
+        case 1:
+            return 1.0 / 144.0;
+        case 2:
+            return 0.004 + random * 0.04;
+        default:
+            // 60 Hz with a quarter-second hitch every 100 frames.
+            return seed % 100 == 0 ? 0.25 : 1.0 / 60.0;
+    }
+}
+
+struct LoopRun {
+    Body Fixed;
+    Body Variable;
+    GameLoopStats Stats;
+    u32 MaxFrameTicks;
+};
+
+static LoopRun RunPattern(u32 pattern, f64 seconds) {
+    LoopRun run{};
+    run.Fixed = {1.0, 0.0};
+    run.Variable = {1.0, 0.0};
+
+    GameLoop loop;
+    loop.Initialize();
+
+    u32 seed = 12345;
+    // Stop at a tick boundary so every pattern simulates the same span.
+    u64 tickTarget = (u64)(seconds / loop.GetTickSeconds());
+    while (loop.GetTick() < tickTarget) {
+        f64 frameSeconds = NextFrameSeconds(pattern, seed);
+        u32 ticks = loop.Advance(frameSeconds);
+        for (u32 i = 0; i < ticks && loop.GetTick() - ticks + i < tickTarget; i++) {
+            StepBody(run.Fixed, loop.GetTickSeconds());
+        }
+        StepBody(run.Variable, frameSeconds);
+        if (ticks > run.MaxFrameTicks) {
+            run.MaxFrameTicks = ticks;
+        }
+    }
+    run.Stats = loop.GetStats();
+
+    return run;
+}
+
+// Process CPU time against wall time over LOOP_PACED_FRAMES empty frames at
+// frameRate, first spinning until each is due and then through the pacer.
+static void RunPacing(u32 frameRate) {
+    for (u32 pass = 0; pass < 2; pass++) {
+        FramePacer pacer;
+        pacer.SetTargetFrameRate(pass == 0 ? 0.0 : (f64)frameRate);
+
+        std::vector<f64> frameMs;
+        frameMs.reserve(LOOP_PACED_FRAMES);
+
+        std::clock_t cpuStart = std::clock();
+        BenchmarkClock::time_point wallStart = BenchmarkClock::now();
+        BenchmarkClock::time_point last = wallStart;
+        for (u32 frame = 0; frame < LOOP_PACED_FRAMES; frame++) {
+            if (pass == 0) {
+                // Stands in for a loop that spins until presentation unblocks.
+                while (std::chrono::duration<f64>(BenchmarkClock::now() - last).count() < 1.0 / frameRate) {
+                }
+            } else {
+                pacer.Wait();
+            }
+
+            BenchmarkClock::time_point now = BenchmarkClock::now();
+            frameMs.push_back(std::chrono::duration<f64, std::milli>(now - last).count());
+            last = now;
+        }
+        f64 wallSeconds = std::chrono::duration<f64>(BenchmarkClock::now() - wallStart).count();
+        f64 cpuSeconds = (f64)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        const char* name = pass == 0 ? "busy wait" : "paced";
+        PrintSampleStats(name, ComputeSampleStats(frameMs));
+        printf("    cpu %.1f%% of one core\n", 100.0 * cpuSeconds / wallSeconds);
+    }
+}
+
+// Simulates the same number of ticks under several frame time patterns. The
+// fixed timestep must land on bit-identical state in all of them, even when
+// the spiral-of-death clamp drops real time; the variable timestep drifts.
+int RunLoopBenchmark(int argc, char** argv) {
+    u32 seconds = ParseArgument(argc, argv, 1, 60);
+    u32 frameRate = ParseArgument(argc, argv, 2, 60);
+
+    const char* patterns[] = {"60 Hz", "144 Hz", "jitter 4-44 ms", "hitches"};
+    const u32 patternCount = sizeof(patterns) / sizeof(patterns[0]);
+
+    printf("loop: %u simulated seconds at %.0f ticks/s\n", seconds, DEFAULT_TICK_RATE);
+
+    LoopRun runs[patternCount];
+    bool deterministic = true;
+    for (u32 pattern = 0; pattern < patternCount; pattern++) {
+        runs[pattern] = RunPattern(pattern, (f64)seconds);
+        const LoopRun& run = runs[pattern];
+
+        printf("%-16s fixed %+.9f variable %+.9f frames %llu ticks %llu max/frame %u dropped %llu\n",
+               patterns[pattern], run.Fixed.Position, run.Variable.Position,
+               (unsigned long long)run.Stats.Frames, (unsigned long long)run.Stats.Ticks,
+               run.MaxFrameTicks, (unsigned long long)run.Stats.DroppedTicks);
+
+        if (memcmp(&run.Fixed, &runs[0].Fixed, sizeof(Body)) != 0) {
+            deterministic = false;
+        }
+    }
+    printf("fixed timestep %s\n", deterministic ? "deterministic" : "DIVERGED");
+
+    RunPacing(frameRate);
+
+    return deterministic ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+#include "Benchmark.h"
+#include "core/Memory/LinearAllocator.h"
+#include "core/Memory/Memory.h"
+#include "core/Memory/PoolAllocator.h"
+#include "core/Memory/StackAllocator.h"
+#include <stdio.h>
+#include <string.h>
+
+const u32 MEMORY_BLOCK_SIZE = 64;
+const u32 MEMORY_POOL_PAGE_BLOCKS = 4096;
+
+// Touches each block so the allocators can't be compared on untouched memory.
+static void Fill(void** blocks, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        memset(blocks[i], (int)i, MEMORY_BLOCK_SIZE);
+    }
+}
+
+static void PrintTags() {
+    for (u32 tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        MemoryTagStats stats = Memory::GetTagStats((MemoryTag)tag);
+        if (stats.TotalAllocations == 0) {
+            continue;
+        }
+        printf("    %-10s live %10llu B in %8llu, peak %10llu B, %llu total\n", Memory::GetTagName((MemoryTag)tag),
+               (unsigned long long)stats.Bytes, (unsigned long long)stats.Allocations,
+               (unsigned long long)stats.PeakBytes, (unsigned long long)stats.TotalAllocations);
+    }
+}
+
+// A frame's worth of short-lived, same-sized allocations made and released
+// each round through the global heap, a pool, the frame arena and a scoped
+// stack, then the per-tag counters those left behind.
+int RunMemoryBenchmark(int argc, char** argv) {
+    u32 allocationCount = ParseArgument(argc, argv, 1, 100000);
+    u32 roundCount = ParseArgument(argc, argv, 2, 100);
+
+    size_t arenaSize = (size_t)allocationCount * MEMORY_BLOCK_SIZE;
+    if (!Memory::Initialize(arenaSize)) {
+        printf("failed to initialize memory\n");
+        return 1;
+    }
+
+    PoolAllocator pool;
+    pool.Initialize(MEMORY_BLOCK_SIZE, MEMORY_POOL_PAGE_BLOCKS, MEMORY_TAG_SCENE);
+    StackAllocator stack;
+    stack.Initialize(arenaSize * 2, "benchmark");
+
+    printf("memory: %u allocations of %u bytes, %u rounds\n", allocationCount, MEMORY_BLOCK_SIZE, roundCount);
+
+    std::vector<void*> blocks(allocationCount);
+    std::vector<f64> samples[4];
+    MemoryTagStats peaks[4] = {};
+
+    for (u32 round = 0; round < roundCount; round++) {
+        BenchmarkClock::time_point start = BenchmarkClock::now();
+        for (u32 i = 0; i < allocationCount; i++) {
+            blocks[i] = Memory::Allocate(MEMORY_BLOCK_SIZE, MEMORY_TAG_GAME);
+        }
+        Fill(blocks.data(), allocationCount);
+        peaks[0] = Memory::GetTagStats(MEMORY_TAG_GAME);
+        for (u32 i = 0; i < allocationCount; i++) {
+            Memory::Free(blocks[i], MEMORY_BLOCK_SIZE, MEMORY_TAG_GAME);
+        }
+        samples[0].push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        for (u32 i = 0; i < allocationCount; i++) {
+            blocks[i] = pool.Allocate();
+        }
+        Fill(blocks.data(), allocationCount);
+        peaks[1] = Memory::GetTagStats(MEMORY_TAG_SCENE);
+        for (u32 i = 0; i < allocationCount; i++) {
+            pool.Free(blocks[i]);
+        }
+        samples[1].push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        for (u32 i = 0; i < allocationCount; i++) {
+            blocks[i] = Memory::AllocateFrame(MEMORY_BLOCK_SIZE, MEMORY_TAG_SPRITES);
+        }
+        Fill(blocks.data(), allocationCount);
+        peaks[2] = Memory::GetTagStats(MEMORY_TAG_SPRITES);
+        Memory::EndFrame();
+        samples[2].push_back(ElapsedMs(start));
+
+        start = BenchmarkClock::now();
+        {
+            ScopedStack scratch(stack);
+            for (u32 i = 0; i < allocationCount; i++) {
+                blocks[i] = scratch.Allocate(MEMORY_BLOCK_SIZE, MEMORY_TAG_RENDERER);
+            }
+            Fill(blocks.data(), allocationCount);
+            peaks[3] = Memory::GetTagStats(MEMORY_TAG_RENDERER);
+        }
+        samples[3].push_back(ElapsedMs(start));
+    }
+
+    const char* names[] = {"heap", "pool", "frame arena", "scoped stack"};
+    for (u32 i = 0; i < 4; i++) {
+        PrintSampleStats(names[i], ComputeSampleStats(samples[i]));
+        printf("    %llu live allocations at the round's peak\n", (unsigned long long)peaks[i].Allocations);
+    }
+
+    stack.Shutdown();
+    pool.Shutdown();
+
+    printf("tags after release:\n");
+    PrintTags();
+
+    Memory::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "core/Renderer/Renderer.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <algorithm>
+#include <stdio.h>
+#include <thread>
+
+const u32 RECORDING_WARMUP_FRAMES = 30;
+
+// Every layer becomes its own draw, so this controls the draw count.
+static void SubmitDraws(SpriteBatch& sprites, u32 drawCount, u32 spritesPerDraw, u32 width, u32 height) {
+    for (u32 draw = 0; draw < drawCount; draw++) {
+        for (u32 i = 0; i < spritesPerDraw; i++) {
+            u32 index = draw * spritesPerDraw + i;
+
+            Sprite sprite{};
+            sprite.Position = glm::vec2((f32)(index % width), (f32)((index / width) % height));
+            sprite.Size = glm::vec2(4.0f, 4.0f);
+            sprite.Color = 0xffffffff;
+            sprite.UV = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            sprite.Layer = draw;
+            sprites.Submit(sprite);
+        }
+    }
+}
+
+// Measures command recording time for a draw-heavy frame with 1..N record
+// threads and reports the speedup over the single threaded path.
+int RunRecordingBenchmark(int argc, char** argv) {
+    u32 frameCount = ParseArgument(argc, argv, 1, 300);
+    u32 drawCount = ParseArgument(argc, argv, 2, 20000);
+    u32 maxThreads = ParseArgument(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+    u32 spritesPerDraw = 4;
+    u32 width = 1280;
+    u32 height = 720;
+
+    if (drawCount * spritesPerDraw > MAX_SPRITES_PER_FRAME) {
+        drawCount = MAX_SPRITES_PER_FRAME / spritesPerDraw;
+    }
+
+    Renderer renderer;
+    renderer.RecordThreadCount = 1;
+    if (!renderer.InitializeHeadless("Splintered Recording Benchmark", width, height)) {
+        printf("failed to initialize headless renderer\n");
+        return 1;
+    }
+
+    printf("recording: %u frames, %u draws per frame\n", frameCount, drawCount);
+
+    f64 singleThreadMs = 0.0;
+    std::vector<f64> recordSamples;
+    recordSamples.reserve(frameCount);
+
+    for (u32 threads = 1; threads <= maxThreads && threads <= MAX_RECORD_THREADS; threads++) {
+        renderer.SetRecordThreadCount(threads);
+        recordSamples.clear();
+
+        for (u32 frame = 0; frame < RECORDING_WARMUP_FRAMES + frameCount; frame++) {
+            SubmitDraws(renderer.Sprites, drawCount, spritesPerDraw, width, height);
+            renderer.Draw();
+
+            if (frame >= RECORDING_WARMUP_FRAMES) {
+                recordSamples.push_back(renderer.LastFrameStats.CpuRecordMs);
+            }
+        }
+
+        SampleStats stats = ComputeSampleStats(recordSamples);
+        if (threads == 1) {
+            singleThreadMs = stats.Average;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "record %2u threads", threads);
+        PrintSampleStats(name, stats);
+        printf("    speedup %.2fx\n", singleThreadMs / stats.Average);
+    }
+
+    vkDeviceWaitIdle(renderer.GetLogicalDevice());
+    renderer.Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include "Benchmark.h"
+#include "core/Renderer/Renderer.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vendor/glm/glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <stdio.h>
+
+const u32 WARMUP_FRAMES = 60;
+
+static void SubmitMovingSprites(SpriteBatch& sprites, u32 count, u32 frame, u32 width, u32 height) {
+    f32 time = (f32)frame / 60.0f;
+
+    for (u32 i = 0; i < count; i++) {
+        f32 phase = (f32)i * 0.618f;
+
+        Sprite sprite{};
+        sprite.Position = glm::vec2((0.5f + 0.45f * sinf(time + phase)) * (f32)width,
+                                    (0.5f + 0.45f * cosf(time * 0.7f + phase * 1.3f)) * (f32)height);
+        sprite.Size = glm::vec2(8.0f, 8.0f);
+        sprite.Rotation = time + phase;
+        sprite.Color = 0xffffffff;
+        sprite.UV = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+        sprites.Submit(sprite);
+    }
+}
+
+static void SubmitSpinningObjects(Renderer& renderer, u32 count, u32 frame, u32 width, u32 height) {
+    f32 time = (f32)frame / 60.0f;
+
+    for (u32 i = 0; i < count; i++) {
+        glm::vec3 position((f32)((i * 37) % width), (f32)((i * 91) % height), 0.0f);
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+        model = glm::rotate(model, time + (f32)i, glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, glm::vec3(16.0f, 16.0f, 1.0f));
+        renderer.SubmitObject(model);
+    }
+}
+
+// Drives the headless renderer for a fixed number of frames and reports
+// per-frame CPU record/submit cost and GPU time.
+int RunRendererBenchmark(int argc, char** argv) {
+    u32 frameCount = ParseArgument(argc, argv, 1, 1000);
+    u32 width = ParseArgument(argc, argv, 2, 1280);
+    u32 height = ParseArgument(argc, argv, 3, 720);
+    u32 spriteCount = ParseArgument(argc, argv, 4, 100000);
+    u32 objectCount = ParseArgument(argc, argv, 5, 10000);
+
+    Renderer renderer;
+    if (!renderer.InitializeHeadless("Splintered Benchmark", width, height)) {
+        printf("failed to initialize headless renderer\n");
+        return 1;
+    }
+
+    std::vector<f64> spriteSamples;
+    std::vector<f64> prepareSamples;
+    std::vector<f64> recordSamples;
+    std::vector<f64> submitSamples;
+    std::vector<f64> gpuSamples;
+    std::vector<f64> latencySamples;
+    spriteSamples.reserve(frameCount);
+    prepareSamples.reserve(frameCount);
+    recordSamples.reserve(frameCount);
+    submitSamples.reserve(frameCount);
+    gpuSamples.reserve(frameCount);
+    latencySamples.reserve(frameCount);
+
+    for (u32 frame = 0; frame < WARMUP_FRAMES + frameCount; frame++) {
+        auto spriteStart = std::chrono::high_resolution_clock::now();
+        SubmitMovingSprites(renderer.Sprites, spriteCount, frame, width, height);
+        SubmitSpinningObjects(renderer, objectCount, frame, width, height);
+        auto spriteEnd = std::chrono::high_resolution_clock::now();
+
+        renderer.Draw();
+
+        if (frame < WARMUP_FRAMES) {
+            continue;
+        }
+
+        spriteSamples.push_back(std::chrono::duration<f64, std::milli>(spriteEnd - spriteStart).count());
+        prepareSamples.push_back(renderer.LastFrameStats.CpuPrepareMs);
+
+        recordSamples.push_back(renderer.LastFrameStats.CpuRecordMs);
+        submitSamples.push_back(renderer.LastFrameStats.CpuSubmitMs);
+        if (renderer.LastFrameStats.GpuValid) {
+            gpuSamples.push_back(renderer.LastFrameStats.GpuMs);
+        }
+        if (renderer.LastFrameStats.InputLatencyValid) {
+            latencySamples.push_back(renderer.LastFrameStats.InputLatencyMs);
+        }
+    }
+
+    vkDeviceWaitIdle(renderer.GetLogicalDevice());
+
+    printf("renderer: %u frames at %ux%u, %u sprites, %u objects\n", frameCount, width, height, spriteCount, objectCount);
+    PrintSampleStats("cpu sprite submit", ComputeSampleStats(spriteSamples));
+    PrintSampleStats("cpu prepare", ComputeSampleStats(prepareSamples));
+    PrintSampleStats("cpu record", ComputeSampleStats(recordSamples));
+    PrintSampleStats("cpu submit", ComputeSampleStats(submitSamples));
+    PrintSampleStats("gpu", ComputeSampleStats(gpuSamples));
+    PrintSampleStats("input to frame done", ComputeSampleStats(latencySamples));
+
+    for (const GpuZoneStats& zone : renderer.GetGpuZoneStats()) {
+        printf("gpu zone %-15s n=%-7u avg=%9.4f p95=%9.4f p99=%9.4f (ms, last %u frames)\n",
+               zone.Name, zone.SampleCount, zone.AverageMs, zone.P95Ms, zone.P99Ms, zone.SampleCount);
+    }
+
+    GpuPipelineStatistics statistics;
+    if (renderer.GetGpuPipelineStatistics(statistics)) {
+        printf("gpu last frame: %llu vertices, %llu primitives, %llu fragment invocations\n",
+               (unsigned long long)statistics.InputAssemblyVertices, (unsigned long long)statistics.ClippingPrimitives,
+               (unsigned long long)statistics.FragmentShaderInvocations);
+    }
+
+    GpuAllocatorStats memory = renderer.GetMemoryStats();
+    printf("gpu memory: %u blocks, %u allocations, %.2f MB in use of %.2f MB reserved, fragmentation %.3f\n",
+           memory.BlockCount, memory.AllocationCount,
+           (f64)memory.BytesInUse / (1024.0 * 1024.0), (f64)memory.BytesReserved / (1024.0 * 1024.0),
+           memory.Fragmentation);
+
+    RenderGraphStats graph = renderer.GetRenderGraphStats();
+    printf("render graph: %u passes (%u culled), %u barriers, %u transient images in %.2f MB (%.2f MB unaliased)\n",
+           graph.PassCount, graph.CulledPassCount, graph.BarrierCount, graph.TransientImageCount,
+           (f64)graph.AllocatedBytes / (1024.0 * 1024.0), (f64)graph.TransientBytes / (1024.0 * 1024.0));
+
+    DescriptorAllocatorStats descriptors = renderer.GetDescriptorStats();
+    printf("descriptors: %u pools (%u held by frames), %u transient sets last frame, %u cached sets\n",
+           descriptors.PoolCount, descriptors.FramePools, descriptors.FrameSets, descriptors.CachedSets);
+
+    renderer.Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "Benchmark.h"
+#include "core/Scene/SpatialGrid.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+const f32 SPATIAL_CELL_SIZE = 128.0f;
+const f32 SPATIAL_AREA_PER_OBJECT = 64.0f * 64.0f;   // keeps density constant across sizes
+const f32 SPATIAL_OBJECT_SIZE = 16.0f;
+const f32 SPATIAL_MAX_SPEED = 4.0f;                  // world units per update
+const glm::vec2 SPATIAL_VIEW_SIZE = glm::vec2(1280.0f, 720.0f);
+const u32 SPATIAL_UPDATE_ROUNDS = 20;
+const u32 SPATIAL_QUERY_BATCH = 100;
+
+struct MovingObject {
+    glm::vec2 Position;
+    glm::vec2 Velocity;
+    u32 Handle;
+};
+
+// xorshift32, deterministic across runs and platforms.
+static f32 Random(u32& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (f32)(state >> 8) / (f32)(1u << 24);
+}
+
+static void RunSize(u32 objectCount, u32 queryCount) {
+    f32 worldSize = std::sqrt((f32)objectCount * SPATIAL_AREA_PER_OBJECT);
+    glm::vec2 half = glm::vec2(SPATIAL_OBJECT_SIZE * 0.5f);
+    u32 seed = 0x2545f491u;
+
+    std::vector<MovingObject> objects(objectCount);
+    for (MovingObject& object : objects) {
+        object.Position = glm::vec2(Random(seed), Random(seed)) * worldSize;
+        object.Velocity = (glm::vec2(Random(seed), Random(seed)) * 2.0f - 1.0f) * SPATIAL_MAX_SPEED;
+    }
+
+    SpatialGrid grid;
+    grid.Initialize(glm::vec2(0.0f), glm::vec2(worldSize), SPATIAL_CELL_SIZE);
+
+    BenchmarkClock::time_point start = BenchmarkClock::now();
+    for (u32 i = 0; i < objectCount; i++) {
+        objects[i].Handle = grid.Insert(objects[i].Position - half, objects[i].Position + half, i);
+    }
+    f64 insertMs = ElapsedMs(start);
+
+    // Every object moves each round, bouncing off the world edges.
+    std::vector<f64> updateSamples;
+    for (u32 round = 0; round < SPATIAL_UPDATE_ROUNDS; round++) {
+        start = BenchmarkClock::now();
+        for (MovingObject& object : objects) {
+            object.Position += object.Velocity;
+            if (object.Position.x < 0.0f || object.Position.x > worldSize) {
+                object.Velocity.x = -object.Velocity.x;
+            }
+            if (object.Position.y < 0.0f || object.Position.y > worldSize) {
+                object.Velocity.y = -object.Velocity.y;
+            }
+            grid.Move(object.Handle, object.Position - half, object.Position + half);
+        }
+        updateSamples.push_back(ElapsedMs(start));
+    }
+
+    // Camera-sized rectangles at random positions, timed in batches since
+    // a single query is close to the clock's resolution.
+    std::vector<u32> results;
+    results.reserve(objectCount);
+    std::vector<f64> querySamples;
+    u64 found = 0;
+
+    for (u32 batch = 0; batch < queryCount / SPATIAL_QUERY_BATCH; batch++) {
+        start = BenchmarkClock::now();
+        for (u32 i = 0; i < SPATIAL_QUERY_BATCH; i++) {
+            glm::vec2 min = glm::vec2(Random(seed), Random(seed)) * (glm::vec2(worldSize) - SPATIAL_VIEW_SIZE);
+            results.clear();
+            found += grid.Query(min, min + SPATIAL_VIEW_SIZE, results);
+        }
+        querySamples.push_back(ElapsedMs(start) / SPATIAL_QUERY_BATCH);
+    }
+
+    // The same queries as a linear scan, for reference.
+    u32 bruteQueries = std::max(1u, std::min(queryCount, 100000000u / objectCount));
+    start = BenchmarkClock::now();
+    u64 bruteFound = 0;
+    for (u32 i = 0; i < bruteQueries; i++) {
+        glm::vec2 min = glm::vec2(Random(seed), Random(seed)) * (glm::vec2(worldSize) - SPATIAL_VIEW_SIZE);
+        glm::vec2 max = min + SPATIAL_VIEW_SIZE;
+        for (const MovingObject& object : objects) {
+            glm::vec2 objectMin = object.Position - half;
+            glm::vec2 objectMax = object.Position + half;
+            bruteFound += objectMin.x <= max.x && objectMax.x >= min.x && objectMin.y <= max.y && objectMax.y >= min.y;
+        }
+    }
+    f64 bruteMs = ElapsedMs(start) / bruteQueries;
+
+    SampleStats updateStats = ComputeSampleStats(updateSamples);
+    SampleStats queryStats = ComputeSampleStats(querySamples);
+    SpatialGridStats gridStats = grid.GetStats();
+
+    printf("\n%u objects, world %.0f x %.0f, %u/%u cells occupied, max %u per cell\n",
+           objectCount, worldSize, worldSize, gridStats.OccupiedCells, gridStats.CellCount, gridStats.MaxCellObjects);
+    printf("    insert    %9.1f ns/object\n", insertMs * 1e6 / objectCount);
+    printf("    update    %9.1f ns/object (avg), %.3f ms per full pass\n", updateStats.Average * 1e6 / objectCount, updateStats.Average);
+    printf("    query     %9.2f us/query (avg), p99 %.2f us, %.0f results/query\n",
+           queryStats.Average * 1e3, queryStats.P99 * 1e3, querySamples.empty() ? 0.0 : (f64)found / (f64)(querySamples.size() * SPATIAL_QUERY_BATCH));
+    printf("    linear    %9.2f us/query (%u queries, %.0f results/query)\n", bruteMs * 1e3, bruteQueries, (f64)bruteFound / bruteQueries);
+
+    grid.Shutdown();
+}
+
+// Insert, move and view-rectangle query costs of the spatial grid at
+// growing object counts, with a linear scan as the baseline.
+int RunSpatialBenchmark(int argc, char** argv) {
+    u32 queryCount = ParseArgument(argc, argv, 1, 10000);
+    queryCount = std::max(queryCount, SPATIAL_QUERY_BATCH);
+
+    static const u32 sizes[] = {10000, 100000, 1000000};
+
+    if (argc > 2) {
+        RunSize(ParseArgument(argc, argv, 2, sizes[0]), queryCount);
+        return 0;
+    }
+
+    for (u32 size : sizes) {
+        RunSize(size, queryCount);
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+#include "core/Renderer/Renderer.h"
+#include "core/Scene/TileMap.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vendor/glm/glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+const u32 TILE_WARMUP_FRAMES = 60;
+const f32 TILE_SIZE = 16.0f;
+const u32 TILESET_SIZE = 4;   // cells per side
+const f32 TILE_PAN_SPEED = 4.0f;   // world units per frame
+
+// xorshift32, deterministic across runs and platforms.
+static u32 NextRandom(u32& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Pans the camera across a fully populated map, editing a few tiles per
+// frame, and reports the per-frame CPU cost along with how many chunks were
+// drawn and rebuilt. With no edits the map should cost nothing but the draws.
+int RunTileBenchmark(int argc, char** argv) {
+    u32 frameCount = ParseArgument(argc, argv, 1, 1000);
+    u32 mapSize = ParseArgument(argc, argv, 2, 1024);
+    u32 editsPerFrame = ParseArgument(argc, argv, 3, 0);
+    u32 width = 1280;
+    u32 height = 720;
+
+    Renderer renderer;
+    if (!renderer.InitializeHeadless("Splintered Benchmark", width, height)) {
+        printf("failed to initialize headless renderer\n");
+        return 1;
+    }
+
+    // Checkerboard tileset, one texel per cell.
+    std::vector<u32> pixels(TILESET_SIZE * TILESET_SIZE);
+    for (u32 i = 0; i < pixels.size(); i++) {
+        pixels[i] = ((i + i / TILESET_SIZE) & 1) ? 0xff808080 : 0xffffffff;
+    }
+    u32 tileset = renderer.CreateTexture(pixels.data(), TILESET_SIZE, TILESET_SIZE);
+
+    TileMap map;
+    if (!map.Initialize(mapSize, mapSize, TILE_SIZE)) {
+        renderer.Shutdown();
+        return 1;
+    }
+    map.SetTileset(tileset, TILESET_SIZE, TILESET_SIZE);
+
+    u32 seed = 0x2545f491u;
+    for (u32 y = 0; y < mapSize; y++) {
+        for (u32 x = 0; x < mapSize; x++) {
+            map.SetTile(x, y, (u16)(1 + NextRandom(seed) % (TILESET_SIZE * TILESET_SIZE)));
+        }
+    }
+    renderer.SetTileMap(&map);
+
+    std::vector<f64> prepareSamples;
+    std::vector<f64> recordSamples;
+    std::vector<f64> gpuSamples;
+    prepareSamples.reserve(frameCount);
+    recordSamples.reserve(frameCount);
+    gpuSamples.reserve(frameCount);
+
+    u64 chunksDrawn = 0;
+    u64 chunksRebuilt = 0;
+    f32 mapExtent = (f32)mapSize * TILE_SIZE;
+    glm::mat4 projection = glm::ortho(0.0f, (f32)width, 0.0f, (f32)height, -1.0f, 1.0f);
+
+    for (u32 frame = 0; frame < TILE_WARMUP_FRAMES + frameCount; frame++) {
+        f32 pan = std::fmod((f32)frame * TILE_PAN_SPEED, std::max(mapExtent - (f32)width, 1.0f));
+        renderer.SetCamera(glm::translate(glm::mat4(1.0f), glm::vec3(-pan, -pan * 0.5f, 0.0f)), projection);
+
+        for (u32 i = 0; i < editsPerFrame; i++) {
+            map.SetTile(NextRandom(seed) % mapSize, NextRandom(seed) % mapSize, (u16)(1 + NextRandom(seed) % (TILESET_SIZE * TILESET_SIZE)));
+        }
+
+        renderer.Draw();
+
+        if (frame < TILE_WARMUP_FRAMES) {
+            continue;
+        }
+
+        prepareSamples.push_back(renderer.LastFrameStats.CpuPrepareMs);
+        recordSamples.push_back(renderer.LastFrameStats.CpuRecordMs);
+        if (renderer.LastFrameStats.GpuValid) {
+            gpuSamples.push_back(renderer.LastFrameStats.GpuMs);
+        }
+        chunksDrawn += renderer.LastFrameStats.TileChunksDrawn;
+        chunksRebuilt += renderer.LastFrameStats.TileChunksRebuilt;
+    }
+
+    vkDeviceWaitIdle(renderer.GetLogicalDevice());
+
+    printf("tiles: %u frames, %ux%u map in %u chunks, %u edits per frame\n", frameCount, mapSize, mapSize, map.GetChunkCount(), editsPerFrame);
+    PrintSampleStats("cpu prepare", ComputeSampleStats(prepareSamples));
+    PrintSampleStats("cpu record", ComputeSampleStats(recordSamples));
+    PrintSampleStats("gpu", ComputeSampleStats(gpuSamples));
+    printf("chunks per frame: %.1f drawn, %.2f rebuilt\n", (f64)chunksDrawn / frameCount, (f64)chunksRebuilt / frameCount);
+
+    GpuAllocatorStats memory = renderer.GetMemoryStats();
+    printf("gpu memory: %u allocations, %.2f MB in use\n", memory.AllocationCount, (f64)memory.BytesInUse / (1024.0 * 1024.0));
+
+    renderer.SetTileMap(nullptr);
+    renderer.Shutdown();
+    map.Shutdown();
+
+    return 0;
+}
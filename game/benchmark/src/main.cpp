@@ -0,0 +1,45 @@
+// Benchmark harness for the engine.
+//
+// Usage: benchmark <suite> [suite arguments]
+// Run it from game/engine so the renderer can find src/shaders.
+
+#include "Benchmark.h"
+#include <stdio.h>
+#include <string.h>
+
+struct BenchmarkSuite {
+    const char* Name;
+    const char* Usage;
+    int (*Run)(int argc, char** argv);
+};
+
+static const BenchmarkSuite Suites[] = {
+    {"renderer", "renderer [frames] [width] [height] [sprites] [objects]", RunRendererBenchmark},
+    {"recording", "recording [frames] [draws] [max threads]", RunRecordingBenchmark},
+    {"spatial", "spatial [queries] [objects]", RunSpatialBenchmark},
+    {"tiles", "tiles [frames] [map size] [edits per frame]", RunTileBenchmark},
+    {"jobs", "jobs [rounds] [objects]", RunJobBenchmark},
+    {"ecs", "ecs [entities] [rounds]", RunEcsBenchmark},
+    {"loop", "loop [seconds] [frame rate]", RunLoopBenchmark},
+    {"memory", "memory [allocations] [rounds]", RunMemoryBenchmark},
+    {"allocations", "allocations [frames] [sprites]", RunAllocationBenchmark},
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("usage: benchmark <suite> [arguments]\n");
+        for (const BenchmarkSuite& suite : Suites) {
+            printf("    %s\n", suite.Usage);
+        }
+        return 1;
+    }
+
+    for (const BenchmarkSuite& suite : Suites) {
+        if (strcmp(argv[1], suite.Name) == 0) {
+            return suite.Run(argc - 1, argv + 1);
+        }
+    }
+
+    printf("unknown benchmark suite '%s'\n", argv[1]);
+    return 1;
+}
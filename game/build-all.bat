@@ -10,4 +10,14 @@ IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit )
 CALL compile-shaders.bat
 POPD
 
+PUSHD benchmark
+CALL build.bat
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit )
+POPD
+
+PUSHD tools\AtlasPacker
+CALL build.bat
+IF %ERRORLEVEL% NEQ 0 (echo Error:%ERRORLEVEL% && exit )
+POPD
+
 ECHO "All assemblies built successfully."
\ No newline at end of file
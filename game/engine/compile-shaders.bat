@@ -14,4 +14,11 @@ FOR /R %%f in (*.frag) do (
     %VULKAN_SDK%/Bin/glslc.exe %%f -o src/shaders/%%~nf.spv   
 )
 
+SET compShaders=
+FOR /R %%f in (*.comp) do (
+    echo %%~nf
+    SET compShaders=!compShaders! %%f
+    %VULKAN_SDK%/Bin/glslc.exe %%f -o src/shaders/%%~nf.spv
+)
+
 ECHO "Building shaders"
\ No newline at end of file
@@ -0,0 +1,21 @@
+#!/bin/bash
+# Compiles every shader under src/shaders to src/shaders/<name>.spv.
+# Run from game/engine; needs glslc from the Vulkan SDK or shaderc.
+set -e
+
+glslc="glslc"
+if [ -n "$VULKAN_SDK" ]; then
+    glslc="$VULKAN_SDK/bin/glslc"
+fi
+
+if ! command -v "$glslc" > /dev/null; then
+    echo "glslc not found; install the Vulkan SDK or shaderc" >&2
+    exit 1
+fi
+
+echo "Building shaders"
+for shader in $(find src/shaders -type f \( -name '*.vert' -o -name '*.frag' -o -name '*.comp' \)); do
+    output="src/shaders/$(basename "${shader%.*}").spv"
+    echo "$output"
+    "$glslc" "$shader" -o "$output"
+done
@@ -0,0 +1,73 @@
+#include "EntityCommandBuffer.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <cstring>
+
+Entity EntityCommandBuffer::Create() {
+    Entity placeholder = {CreatedCount++, ECS_DEFERRED_GENERATION};
+    Push(COMMAND_CREATE, placeholder, ECS_NONE, nullptr, 0);
+
+    return placeholder;
+}
+
+void EntityCommandBuffer::Destroy(Entity entity) {
+    Push(COMMAND_DESTROY, entity, ECS_NONE, nullptr, 0);
+}
+
+void EntityCommandBuffer::AddComponent(Entity entity, u32 componentId, const void* data, u32 size) {
+    Push(COMMAND_ADD, entity, componentId, data, size);
+}
+
+void EntityCommandBuffer::RemoveComponent(Entity entity, u32 componentId) {
+    Push(COMMAND_REMOVE, entity, componentId, nullptr, 0);
+}
+
+void EntityCommandBuffer::Playback(World& world) {
+    Created.resize(CreatedCount);
+
+    size_t offset = 0;
+    while (offset < Commands.size()) {
+        Command command;
+        memcpy(&command, &Commands[offset], sizeof(command));
+        const u8* data = &Commands[offset] + sizeof(Command);
+        offset += sizeof(Command) + ((command.Size + 7) & ~7u);
+
+        Entity target = command.Target;
+        if (target.Generation == ECS_DEFERRED_GENERATION && command.Type != COMMAND_CREATE) {
+            target = Created[target.Index];
+        }
+
+        switch (command.Type) {
+            case COMMAND_CREATE:
+                Created[target.Index] = world.Create();
+                break;
+            case COMMAND_DESTROY:
+                world.Destroy(target);
+                break;
+            case COMMAND_ADD:
+                world.AddComponent(target, command.ComponentId, data);
+                break;
+            case COMMAND_REMOVE:
+                world.RemoveComponent(target, command.ComponentId);
+                break;
+        }
+    }
+
+    Clear();
+}
+
+void EntityCommandBuffer::Clear() {
+    Commands.clear();
+    CreatedCount = 0;
+}
+
+void EntityCommandBuffer::Push(u32 type, Entity target, u32 componentId, const void* data, u32 size) {
+    Command command{type, componentId, target, size, 0};
+
+    size_t offset = Commands.size();
+    Commands.resize(offset + sizeof(Command) + ((size + 7) & ~7u));
+    memcpy(&Commands[offset], &command, sizeof(command));
+    if (size > 0) {
+        memcpy(&Commands[offset + sizeof(Command)], data, size);
+    }
+}
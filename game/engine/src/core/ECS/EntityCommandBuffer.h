@@ -0,0 +1,55 @@
+#pragma once
+
+#include "World.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vector>
+
+// Structural changes recorded during a query and applied afterwards, in
+// recording order, by Playback. Entities from Create are placeholders that
+// only this buffer's later commands can refer to until it is played back.
+//
+// A buffer is not thread safe; parallel queries record into one buffer per
+// worker (see JobSystem::GetCurrentWorker) and play them back in turn.
+// Playback clears the buffer but keeps its memory for the next frame.
+class EntityCommandBuffer {
+public:
+    Entity Create();
+    void Destroy(Entity entity);
+
+    template <typename T>
+    void Add(Entity entity, const T& component) { AddComponent(entity, GetComponentId<T>(), &component, sizeof(T)); }
+    template <typename T>
+    void Remove(Entity entity) { RemoveComponent(entity, GetComponentId<T>()); }
+
+    void AddComponent(Entity entity, u32 componentId, const void* data, u32 size);
+    void RemoveComponent(Entity entity, u32 componentId);
+
+    void Playback(World& world);
+    void Clear();
+    bool IsEmpty() const { return Commands.empty(); }
+
+private:
+    enum CommandType
+    {
+        COMMAND_CREATE = 0,
+        COMMAND_DESTROY = 1,
+        COMMAND_ADD = 2,
+        COMMAND_REMOVE = 3,
+    };
+
+    // Followed in the stream by Size bytes of component data, padded to 8.
+    struct Command {
+        u32 Type;
+        u32 ComponentId;
+        Entity Target;
+        u32 Size;
+        u32 Padding;
+    };
+
+    void Push(u32 type, Entity target, u32 componentId, const void* data, u32 size);
+
+    std::vector<u8> Commands;
+    std::vector<Entity> Created;   // by placeholder index, during Playback
+    u32 CreatedCount = 0;
+};
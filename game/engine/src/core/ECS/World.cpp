@@ -0,0 +1,334 @@
+#include "World.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+const u32 ECS_CHUNK_ALIGNMENT = 64;
+const u32 ECS_CHUNKS_PER_PAGE = 64;
+
+static ComponentInfo RegisteredComponents[MAX_COMPONENT_TYPES];
+static u32 RegisteredComponentCount = 0;
+static std::mutex RegistryMutex;
+
+u32 ComponentRegistry::Register(u32 size, u32 alignment, const char* name) {
+    std::lock_guard<std::mutex> lock(RegistryMutex);
+
+    if (RegisteredComponentCount == MAX_COMPONENT_TYPES) {
+        EM_FATAL("Too many component types, could not register %s", name);
+        throw std::runtime_error("too many component types!");
+    }
+
+    // Empty tag components still take a byte per entity.
+    RegisteredComponents[RegisteredComponentCount] = {size, alignment, name};
+    return RegisteredComponentCount++;
+}
+
+const ComponentInfo& ComponentRegistry::Get(u32 id) {
+    return RegisteredComponents[id];
+}
+
+u32 ComponentRegistry::GetCount() {
+    std::lock_guard<std::mutex> lock(RegistryMutex);
+    return RegisteredComponentCount;
+}
+
+bool World::Initialize(u32 entityCapacity) {
+    Records.clear();
+    Records.reserve(entityCapacity);
+    FreeRecords.clear();
+    EntityCount = 0;
+
+    if (!ChunkPool.Initialize(ECS_CHUNK_SIZE, ECS_CHUNKS_PER_PAGE, MEMORY_TAG_ECS, ECS_CHUNK_ALIGNMENT)) {
+        return false;
+    }
+
+    // Archetype 0 holds entities without components.
+    GetArchetype(0);
+
+    return true;
+}
+
+void World::Shutdown() {
+    for (Archetype& archetype : Archetypes) {
+        for (Chunk& chunk : archetype.Chunks) {
+            ChunkPool.Free(chunk.Data);
+        }
+    }
+    ChunkPool.Shutdown();
+
+    Archetypes.clear();
+    ArchetypeLookup.clear();
+    Records.clear();
+    Records.shrink_to_fit();
+    FreeRecords.clear();
+    FreeRecords.shrink_to_fit();
+    QueryChunks.clear();
+    EntityCount = 0;
+}
+
+Entity World::Create() {
+    Entity entity = AllocateEntity();
+    PlaceEntity(entity, 0);
+
+    return entity;
+}
+
+Entity World::CreateWith(u32 componentCount, const u32* componentIds, const void* const* data) {
+    ComponentMask mask = 0;
+    for (u32 i = 0; i < componentCount; i++) {
+        mask |= 1ull << componentIds[i];
+    }
+
+    Entity entity = AllocateEntity();
+    PlaceEntity(entity, GetArchetype(mask));
+
+    for (u32 i = 0; i < componentCount; i++) {
+        memcpy(GetComponent(entity, componentIds[i]), data[i], ComponentRegistry::Get(componentIds[i]).Size);
+    }
+
+    return entity;
+}
+
+void World::Destroy(Entity entity) {
+    if (!IsAlive(entity)) {
+        return;
+    }
+
+    EntityRecord& record = Records[entity.Index];
+    RemoveRow(record.Archetype, record.Chunk, record.Row);
+
+    record.Archetype = ECS_NONE;
+    record.Generation++;
+    if (record.Generation == ECS_DEFERRED_GENERATION) {
+        record.Generation = 0;
+    }
+
+    FreeRecords.push_back(entity.Index);
+    EntityCount--;
+}
+
+bool World::IsAlive(Entity entity) const {
+    return entity.Index < Records.size() && Records[entity.Index].Generation == entity.Generation && Records[entity.Index].Archetype != ECS_NONE;
+}
+
+void World::AddComponent(Entity entity, u32 componentId, const void* data) {
+    if (!IsAlive(entity)) {
+        return;
+    }
+
+    u32 archetype = Records[entity.Index].Archetype;
+    if (!(Archetypes[archetype].Mask & (1ull << componentId))) {
+        MoveEntity(entity, GetAddEdge(archetype, componentId));
+    }
+
+    memcpy(GetComponent(entity, componentId), data, ComponentRegistry::Get(componentId).Size);
+}
+
+void World::RemoveComponent(Entity entity, u32 componentId) {
+    if (!HasComponent(entity, componentId)) {
+        return;
+    }
+
+    MoveEntity(entity, GetRemoveEdge(Records[entity.Index].Archetype, componentId));
+}
+
+void* World::GetComponent(Entity entity, u32 componentId) {
+    if (!HasComponent(entity, componentId)) {
+        return nullptr;
+    }
+
+    const EntityRecord& record = Records[entity.Index];
+    const Archetype& archetype = Archetypes[record.Archetype];
+
+    return archetype.Chunks[record.Chunk].Data + archetype.Offsets[componentId] + (size_t)record.Row * ComponentRegistry::Get(componentId).Size;
+}
+
+bool World::HasComponent(Entity entity, u32 componentId) const {
+    return IsAlive(entity) && (Archetypes[Records[entity.Index].Archetype].Mask & (1ull << componentId)) != 0;
+}
+
+WorldStats World::GetStats() const {
+    WorldStats stats{};
+    stats.EntityCount = EntityCount;
+    stats.ArchetypeCount = (u32)Archetypes.size();
+    stats.FreeChunkCount = ChunkPool.GetFreeCount();
+
+    for (const Archetype& archetype : Archetypes) {
+        stats.ChunkCount += (u32)archetype.Chunks.size();
+    }
+
+    return stats;
+}
+
+// Lays the chunk out as the entity handles followed by one array per
+// component in id order, each aligned for its type, with as many entities
+// as fit in ECS_CHUNK_SIZE.
+u32 World::GetArchetype(ComponentMask mask) {
+    auto found = ArchetypeLookup.find(mask);
+    if (found != ArchetypeLookup.end()) {
+        return found->second;
+    }
+
+    Archetype archetype{};
+    archetype.Mask = mask;
+    for (u32 id = 0; id < MAX_COMPONENT_TYPES; id++) {
+        archetype.Offsets[id] = ECS_NONE;
+        archetype.AddEdges[id] = ECS_NONE;
+        archetype.RemoveEdges[id] = ECS_NONE;
+        if (mask & (1ull << id)) {
+            archetype.Components[archetype.ComponentCount++] = id;
+        }
+    }
+
+    u32 rowSize = sizeof(Entity);
+    for (u32 i = 0; i < archetype.ComponentCount; i++) {
+        rowSize += ComponentRegistry::Get(archetype.Components[i]).Size;
+    }
+
+    for (u32 capacity = ECS_CHUNK_SIZE / rowSize; capacity > 0; capacity--) {
+        u32 offset = sizeof(Entity) * capacity;
+        for (u32 i = 0; i < archetype.ComponentCount; i++) {
+            const ComponentInfo& info = ComponentRegistry::Get(archetype.Components[i]);
+            offset = (offset + info.Alignment - 1) & ~(info.Alignment - 1);
+            archetype.Offsets[archetype.Components[i]] = offset;
+            offset += info.Size * capacity;
+        }
+
+        if (offset <= ECS_CHUNK_SIZE) {
+            archetype.Capacity = capacity;
+            break;
+        }
+    }
+
+    if (archetype.Capacity == 0) {
+        EM_FATAL("Archetype's components do not fit in one chunk");
+        throw std::runtime_error("archetype too large for a chunk!");
+    }
+
+    u32 index = (u32)Archetypes.size();
+    Archetypes.push_back(std::move(archetype));
+    ArchetypeLookup[mask] = index;
+
+    return index;
+}
+
+u32 World::GetAddEdge(u32 archetype, u32 componentId) {
+    u32 target = Archetypes[archetype].AddEdges[componentId];
+    if (target == ECS_NONE) {
+        target = GetArchetype(Archetypes[archetype].Mask | (1ull << componentId));
+        Archetypes[archetype].AddEdges[componentId] = target;
+        Archetypes[target].RemoveEdges[componentId] = archetype;
+    }
+
+    return target;
+}
+
+u32 World::GetRemoveEdge(u32 archetype, u32 componentId) {
+    u32 target = Archetypes[archetype].RemoveEdges[componentId];
+    if (target == ECS_NONE) {
+        target = GetArchetype(Archetypes[archetype].Mask & ~(1ull << componentId));
+        Archetypes[archetype].RemoveEdges[componentId] = target;
+        Archetypes[target].AddEdges[componentId] = archetype;
+    }
+
+    return target;
+}
+
+Entity World::AllocateEntity() {
+    u32 index;
+    if (!FreeRecords.empty()) {
+        index = FreeRecords.back();
+        FreeRecords.pop_back();
+    } else {
+        index = (u32)Records.size();
+        Records.push_back({ECS_NONE, 0, 0, 0});
+    }
+
+    EntityCount++;
+
+    return {index, Records[index].Generation};
+}
+
+void World::PlaceEntity(Entity entity, u32 archetypeIndex) {
+    Archetype& archetype = Archetypes[archetypeIndex];
+
+    if (archetype.Chunks.empty() || archetype.Chunks.back().Count == archetype.Capacity) {
+        archetype.Chunks.push_back({(u8*)ChunkPool.Allocate(), 0});
+    }
+
+    Chunk& chunk = archetype.Chunks.back();
+    u32 row = chunk.Count++;
+    ((Entity*)chunk.Data)[row] = entity;
+
+    EntityRecord& record = Records[entity.Index];
+    record.Archetype = archetypeIndex;
+    record.Chunk = (u32)archetype.Chunks.size() - 1;
+    record.Row = row;
+}
+
+void World::RemoveRow(u32 archetypeIndex, u32 chunkIndex, u32 row) {
+    Archetype& archetype = Archetypes[archetypeIndex];
+    u32 lastChunkIndex = (u32)archetype.Chunks.size() - 1;
+    Chunk& last = archetype.Chunks[lastChunkIndex];
+    u32 lastRow = last.Count - 1;
+
+    if (chunkIndex != lastChunkIndex || row != lastRow) {
+        Chunk& chunk = archetype.Chunks[chunkIndex];
+        Entity moved = ((Entity*)last.Data)[lastRow];
+        ((Entity*)chunk.Data)[row] = moved;
+
+        for (u32 i = 0; i < archetype.ComponentCount; i++) {
+            u32 id = archetype.Components[i];
+            u32 size = ComponentRegistry::Get(id).Size;
+            memcpy(chunk.Data + archetype.Offsets[id] + (size_t)row * size, last.Data + archetype.Offsets[id] + (size_t)lastRow * size, size);
+        }
+
+        Records[moved.Index].Chunk = chunkIndex;
+        Records[moved.Index].Row = row;
+    }
+
+    last.Count--;
+    if (last.Count == 0) {
+        ChunkPool.Free(last.Data);
+        archetype.Chunks.pop_back();
+    }
+}
+
+// Copies the components both archetypes have; the target's others are left
+// for the caller to fill in.
+void World::MoveEntity(Entity entity, u32 target) {
+    EntityRecord source = Records[entity.Index];
+    PlaceEntity(entity, target);
+
+    const Archetype& from = Archetypes[source.Archetype];
+    const Archetype& to = Archetypes[target];
+    const EntityRecord& record = Records[entity.Index];
+
+    for (u32 i = 0; i < to.ComponentCount; i++) {
+        u32 id = to.Components[i];
+        if (!(from.Mask & (1ull << id))) {
+            continue;
+        }
+
+        u32 size = ComponentRegistry::Get(id).Size;
+        memcpy(to.Chunks[record.Chunk].Data + to.Offsets[id] + (size_t)record.Row * size,
+               from.Chunks[source.Chunk].Data + from.Offsets[id] + (size_t)source.Row * size, size);
+    }
+
+    RemoveRow(source.Archetype, source.Chunk, source.Row);
+}
+
+void World::CollectChunks(ComponentMask mask) {
+    QueryChunks.clear();
+
+    for (u32 a = 0; a < (u32)Archetypes.size(); a++) {
+        if ((Archetypes[a].Mask & mask) != mask) {
+            continue;
+        }
+        for (u32 c = 0; c < (u32)Archetypes[a].Chunks.size(); c++) {
+            QueryChunks.push_back({a, c});
+        }
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "core/Jobs/JobSystem.h"
+#include "core/Logger/Logger.h"
+#include "core/Memory/PoolAllocator.h"
+#include "defines.h"
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+const u32 MAX_COMPONENT_TYPES = 64;
+const u32 ECS_CHUNK_SIZE = 16 * 1024;
+const u32 ECS_NONE = ~0u;
+const u32 ECS_DEFERRED_GENERATION = ~0u;   // entities created in an EntityCommandBuffer
+
+typedef u64 ComponentMask;
+
+// Index into the world's entity table plus the generation of that slot, so
+// a handle to a destroyed entity never matches whatever reuses the slot.
+struct Entity {
+    u32 Index;
+    u32 Generation;
+
+    bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+const Entity ENTITY_NONE = {ECS_NONE, 0};
+
+struct ComponentInfo {
+    u32 Size;
+    u32 Alignment;
+    const char* Name;
+};
+
+// Process-wide component type table. Components are moved with memcpy, so
+// they must be trivially copyable.
+class ComponentRegistry {
+public:
+    static u32 Register(u32 size, u32 alignment, const char* name);
+    static const ComponentInfo& Get(u32 id);
+    static u32 GetCount();
+};
+
+template <typename T>
+u32 GetComponentId() {
+    static_assert(std::is_trivially_copyable<T>::value, "Components must be trivially copyable");
+    static const u32 id = ComponentRegistry::Register(sizeof(T), alignof(T), typeid(T).name());
+    return id;
+}
+
+template <typename... Ts>
+ComponentMask GetComponentMask() {
+    ComponentMask mask = 0;
+    u32 ids[] = {0, GetComponentId<Ts>()...};
+    for (u32 i = 1; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        mask |= 1ull << ids[i];
+    }
+    return mask;
+}
+
+struct WorldStats {
+    u32 EntityCount;
+    u32 ArchetypeCount;
+    u32 ChunkCount;       // holding entities
+    u32 FreeChunkCount;   // pooled for reuse
+};
+
+// Entities grouped by archetype, the exact set of components they have.
+// Each archetype stores its entities in ECS_CHUNK_SIZE chunks laid out as
+// structure of arrays: the chunk's entity handles, then one tightly packed
+// array per component. A query walks the matching archetypes chunk by chunk
+// and hands out those arrays, so iteration reads memory linearly.
+//
+// Entities are kept dense: removing one moves the archetype's last entity
+// into the hole, so every chunk but the last is full. Adding or removing a
+// component moves the entity to another archetype. Those structural changes
+// invalidate component pointers and must not happen during a query; record
+// them in an EntityCommandBuffer and play it back afterwards.
+class World {
+public:
+    bool Initialize(u32 entityCapacity = 0);
+    void Shutdown();
+
+    Entity Create();
+    template <typename... Ts>
+    Entity Create(const Ts&... components) {
+        const void* data[] = {nullptr, &components...};
+        u32 ids[] = {0, GetComponentId<Ts>()...};
+        return CreateWith(sizeof...(Ts), ids + 1, data + 1);
+    }
+    void Destroy(Entity entity);
+    bool IsAlive(Entity entity) const;
+
+    // Overwrites the component when the entity already has it.
+    template <typename T>
+    void Add(Entity entity, const T& component) { AddComponent(entity, GetComponentId<T>(), &component); }
+    template <typename T>
+    void Remove(Entity entity) { RemoveComponent(entity, GetComponentId<T>()); }
+    template <typename T>
+    T* Get(Entity entity) { return (T*)GetComponent(entity, GetComponentId<T>()); }
+    template <typename T>
+    bool Has(Entity entity) const { return HasComponent(entity, GetComponentId<T>()); }
+
+    // Calls function(count, entities, Ts* components...) once per chunk of
+    // every archetype with all of Ts.
+    template <typename... Ts, typename Function>
+    void ForEach(const Function& function) {
+        ComponentMask mask = GetComponentMask<Ts...>();
+        for (Archetype& archetype : Archetypes) {
+            if ((archetype.Mask & mask) != mask) {
+                continue;
+            }
+            for (Chunk& chunk : archetype.Chunks) {
+                function(chunk.Count, (const Entity*)chunk.Data, GetArray<Ts>(archetype, chunk)...);
+            }
+        }
+    }
+
+    // ForEach with chunks spread over the job system. Chunks run
+    // concurrently, so function may only touch its own chunk's entities.
+    template <typename... Ts, typename Function>
+    void ParallelForEach(JobSystem& jobs, const Function& function) {
+        CollectChunks(GetComponentMask<Ts...>());
+        jobs.ParallelFor((u32)QueryChunks.size(), 1, [this, &function](u32 first, u32 count) {
+            for (u32 i = first; i < first + count; i++) {
+                Archetype& archetype = Archetypes[QueryChunks[i].Archetype];
+                Chunk& chunk = archetype.Chunks[QueryChunks[i].Chunk];
+                function(chunk.Count, (const Entity*)chunk.Data, GetArray<Ts>(archetype, chunk)...);
+            }
+        });
+    }
+
+    // Untyped access, for command buffers and tools.
+    Entity CreateWith(u32 componentCount, const u32* componentIds, const void* const* data);
+    void AddComponent(Entity entity, u32 componentId, const void* data);
+    void RemoveComponent(Entity entity, u32 componentId);
+    void* GetComponent(Entity entity, u32 componentId);
+    bool HasComponent(Entity entity, u32 componentId) const;
+
+    u32 GetEntityCount() const { return EntityCount; }
+    WorldStats GetStats() const;
+
+private:
+    struct Chunk {
+        u8* Data;
+        u32 Count;
+    };
+
+    struct Archetype {
+        ComponentMask Mask;
+        u32 ComponentCount;
+        u32 Components[MAX_COMPONENT_TYPES];       // ids, ascending
+        u32 Offsets[MAX_COMPONENT_TYPES];          // array offset in a chunk, by id
+        u32 Capacity;                              // entities per chunk
+        std::vector<Chunk> Chunks;
+        u32 AddEdges[MAX_COMPONENT_TYPES];         // archetype with one more component, or ECS_NONE
+        u32 RemoveEdges[MAX_COMPONENT_TYPES];
+    };
+
+    struct EntityRecord {
+        u32 Archetype;   // ECS_NONE when the slot is free
+        u32 Chunk;
+        u32 Row;
+        u32 Generation;
+    };
+
+    struct ChunkRef {
+        u32 Archetype;
+        u32 Chunk;
+    };
+
+    template <typename T>
+    static T* GetArray(const Archetype& archetype, const Chunk& chunk) {
+        return (T*)(chunk.Data + archetype.Offsets[GetComponentId<T>()]);
+    }
+
+    u32 GetArchetype(ComponentMask mask);
+    u32 GetAddEdge(u32 archetype, u32 componentId);
+    u32 GetRemoveEdge(u32 archetype, u32 componentId);
+    Entity AllocateEntity();
+    // Appends a row to the archetype and points the entity's record at it.
+    void PlaceEntity(Entity entity, u32 archetype);
+    // Fills the hole at the record's row with the archetype's last entity.
+    void RemoveRow(u32 archetype, u32 chunk, u32 row);
+    void MoveEntity(Entity entity, u32 archetype);
+    void CollectChunks(ComponentMask mask);
+
+    std::vector<Archetype> Archetypes;
+    std::unordered_map<ComponentMask, u32> ArchetypeLookup;
+    std::vector<EntityRecord> Records;
+    std::vector<u32> FreeRecords;
+    PoolAllocator ChunkPool;   // ECS_CHUNK_SIZE blocks, charged to MEMORY_TAG_ECS
+    std::vector<ChunkRef> QueryChunks;
+    u32 EntityCount = 0;
+};
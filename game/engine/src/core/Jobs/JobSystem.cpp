@@ -0,0 +1,303 @@
+#include "JobSystem.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+// Spins on an empty queue before sleeping, enough to bridge the gaps
+// between the batches of a frame without a futex round trip.
+const u32 JOB_IDLE_SPINS = 256;
+// ParallelFor batches per worker, so uneven items still balance by stealing.
+const u32 JOB_BATCHES_PER_WORKER = 4;
+
+STATIC_ASSERT((JOB_QUEUE_CAPACITY & (JOB_QUEUE_CAPACITY - 1)) == 0, "Expected JOB_QUEUE_CAPACITY to be a power of two.");
+
+static thread_local const JobSystem* CurrentSystem = nullptr;
+static thread_local u32 CurrentWorker = JOB_WORKER_NONE;
+
+// Owner only. Fails when the deque is full.
+bool JobSystem::WorkQueue::Push(const Job& job) {
+    i64 bottom = Bottom.load(std::memory_order_relaxed);
+    i64 top = Top.load(std::memory_order_acquire);
+    if (bottom - top >= (i64)JOB_QUEUE_CAPACITY) {
+        return false;
+    }
+
+    Jobs[bottom & (JOB_QUEUE_CAPACITY - 1)] = job;
+    std::atomic_thread_fence(std::memory_order_release);
+    Bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+// Owner only. Races thieves for the last job with a CAS on Top.
+bool JobSystem::WorkQueue::Pop(Job& job) {
+    i64 bottom = Bottom.load(std::memory_order_relaxed) - 1;
+    Bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 top = Top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    job = Jobs[bottom & (JOB_QUEUE_CAPACITY - 1)];
+    if (top < bottom) {
+        return true;
+    }
+
+    bool won = Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    Bottom.store(bottom + 1, std::memory_order_relaxed);
+
+    return won;
+}
+
+// Any thread. The slot is read before the CAS; the owner cannot reuse it
+// until Top moves past it, and then the CAS fails and the copy is dropped.
+bool JobSystem::WorkQueue::Steal(Job& job) {
+    i64 top = Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 bottom = Bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+        return false;
+    }
+
+    job = Jobs[top & (JOB_QUEUE_CAPACITY - 1)];
+
+    return Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+bool JobSystem::Initialize(u32 workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    WorkerCount = std::min(workerCount, MAX_JOB_WORKERS);
+
+    Queues.reset(new WorkQueue[WorkerCount]);
+    SharedJobs.clear();
+    SharedJobs.reserve(JOB_QUEUE_CAPACITY);
+    SharedCount = 0;
+    SharedJobsRun = 0;
+    Quit = false;
+
+    // The calling thread is worker 0 and only runs jobs while it waits.
+    CurrentSystem = this;
+    CurrentWorker = 0;
+
+    for (u32 worker = 1; worker < WorkerCount; worker++) {
+        Threads.emplace_back(&JobSystem::WorkerLoop, this, worker);
+    }
+
+    EM_INFO("Job system initialized with %u workers", WorkerCount);
+
+    return true;
+}
+
+void JobSystem::Shutdown() {
+    Quit = true;
+    Wake();
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        WorkReady.notify_all();
+    }
+
+    for (std::thread& thread : Threads) {
+        thread.join();
+    }
+    Threads.clear();
+
+    if (CurrentSystem == this) {
+        CurrentSystem = nullptr;
+        CurrentWorker = JOB_WORKER_NONE;
+    }
+
+    Queues.reset();
+    SharedJobs.clear();
+    WorkerCount = 0;
+}
+
+u32 JobSystem::GetCurrentWorker() const {
+    return CurrentSystem == this ? CurrentWorker : JOB_WORKER_NONE;
+}
+
+void JobSystem::Run(JobFunction function, void* data, JobCounter* counter, u32 first, u32 count) {
+    Job job{function, data, first, count, counter};
+
+    if (counter != nullptr) {
+        counter->Pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    u32 worker = GetCurrentWorker();
+    if (worker != JOB_WORKER_NONE) {
+        // A full deque means there is already plenty to steal.
+        if (!Queues[worker].Push(job)) {
+            Execute(worker, job);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(SharedMutex);
+        SharedJobs.push_back(job);
+        SharedCount.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    Wake();
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    u32 worker = GetCurrentWorker();
+
+    while (!counter.IsDone()) {
+        Job job;
+        if (FindJob(worker, job)) {
+            Execute(worker, job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(u32 itemCount, u32 minBatch, JobFunction function, void* data) {
+    if (itemCount == 0) {
+        return;
+    }
+
+    u32 batchCount = std::min(itemCount / std::max(minBatch, 1u), WorkerCount * JOB_BATCHES_PER_WORKER);
+    if (batchCount <= 1) {
+        function(data, 0, itemCount);
+        return;
+    }
+
+    u32 base = itemCount / batchCount;
+    u32 remainder = itemCount % batchCount;
+
+    // Batch 0 runs here; the rest are queued last to first so this thread
+    // pops them in order while thieves take from the far end.
+    JobCounter counter;
+    for (u32 batch = batchCount - 1; batch > 0; batch--) {
+        u32 first = batch * base + std::min(batch, remainder);
+        u32 count = base + (batch < remainder ? 1 : 0);
+        Run(function, data, &counter, first, count);
+    }
+
+    function(data, 0, base + (remainder > 0 ? 1 : 0));
+    Wait(counter);
+}
+
+JobSystemStats JobSystem::GetStats() const {
+    JobSystemStats stats{};
+    stats.WorkerCount = WorkerCount;
+    stats.JobsRun = SharedJobsRun.load(std::memory_order_relaxed);
+
+    for (u32 worker = 0; worker < WorkerCount; worker++) {
+        stats.JobsRun += Queues[worker].JobsRun.load(std::memory_order_relaxed);
+        stats.Steals += Queues[worker].Steals.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+void JobSystem::WorkerLoop(u32 worker) {
+    CurrentSystem = this;
+    CurrentWorker = worker;
+
+    while (!Quit.load(std::memory_order_relaxed)) {
+        Job job;
+        bool found = false;
+        for (u32 spin = 0; spin < JOB_IDLE_SPINS && !found; spin++) {
+            found = FindJob(worker, job);
+            if (!found) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (found) {
+            Execute(worker, job);
+            continue;
+        }
+
+        // Anything pushed after the epoch is read bumps it, so either the
+        // check below sees the job or the wait sees the new epoch.
+        u64 epoch = WakeEpoch.load(std::memory_order_seq_cst);
+        Sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+        if (!HasWork()) {
+            std::unique_lock<std::mutex> lock(SleepMutex);
+            WorkReady.wait(lock, [this, epoch] { return Quit.load() || WakeEpoch.load() != epoch; });
+        }
+
+        Sleeping.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+// Own deque first, newest job first for cache warmth, then jobs from
+// outside threads, then the oldest job of another worker.
+bool JobSystem::FindJob(u32 worker, Job& job) {
+    if (worker != JOB_WORKER_NONE && Queues[worker].Pop(job)) {
+        return true;
+    }
+
+    if (SharedCount.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(SharedMutex);
+        if (!SharedJobs.empty()) {
+            job = SharedJobs.back();
+            SharedJobs.pop_back();
+            SharedCount.fetch_sub(1, std::memory_order_seq_cst);
+            return true;
+        }
+    }
+
+    u32 start = worker != JOB_WORKER_NONE ? worker + 1 : 0;
+    for (u32 i = 0; i < WorkerCount; i++) {
+        u32 victim = (start + i) % WorkerCount;
+        if (victim == worker) {
+            continue;
+        }
+
+        if (Queues[victim].Steal(job)) {
+            if (worker != JOB_WORKER_NONE) {
+                Queues[worker].Steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Execute(u32 worker, const Job& job) {
+    job.Function(job.Data, job.First, job.Count);
+
+    if (job.Counter != nullptr) {
+        job.Counter->Pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    if (worker != JOB_WORKER_NONE) {
+        Queues[worker].JobsRun.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        SharedJobsRun.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool JobSystem::HasWork() const {
+    if (SharedCount.load(std::memory_order_seq_cst) > 0) {
+        return true;
+    }
+
+    for (u32 worker = 0; worker < WorkerCount; worker++) {
+        if (Queues[worker].Bottom.load(std::memory_order_seq_cst) > Queues[worker].Top.load(std::memory_order_seq_cst)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Wake() {
+    WakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+
+    if (Sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        WorkReady.notify_one();
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const u32 MAX_JOB_WORKERS = 64;
+const u32 JOB_QUEUE_CAPACITY = 4096;   // per worker, a power of two
+const u32 JOB_WORKER_NONE = ~0u;
+
+// Items [first, first + count) of whatever data describes.
+typedef void (*JobFunction)(void* data, u32 first, u32 count);
+
+// Jobs still to finish among those run with this counter. A job waits on
+// other jobs by passing their counter to JobSystem::Wait.
+struct JobCounter {
+    std::atomic<u32> Pending{0};
+
+    bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct JobSystemStats {
+    u32 WorkerCount;
+    u64 JobsRun;
+    u64 Steals;
+};
+
+// Fixed pool of workers, one per hardware thread with the thread that calls
+// Initialize as worker 0. Every worker owns a Chase-Lev deque: it pushes and
+// pops at the bottom, newest first, while idle workers steal the oldest jobs
+// from the top. Threads that are not workers hand their jobs over through a
+// shared locked queue.
+//
+// Waiting never blocks a thread that has something to do: Wait runs queued
+// jobs until the counter drops to zero. Only workers with nothing to run or
+// steal go to sleep.
+//
+// Jobs are a function pointer and a data pointer, so running one does not
+// allocate; the data must stay alive until the job's counter is done.
+class JobSystem {
+public:
+    // 0 = one worker per hardware thread.
+    bool Initialize(u32 workerCount = 0);
+    // From the thread that called Initialize, once no jobs are pending.
+    void Shutdown();
+
+    // Safe from any thread. counter may be null.
+    void Run(JobFunction function, void* data, JobCounter* counter, u32 first = 0, u32 count = 1);
+    void Wait(JobCounter& counter);
+
+    // Calls function(first, count) over [0, itemCount) in batches of at least
+    // minBatch items, the calling thread included, and returns when all are done.
+    void ParallelFor(u32 itemCount, u32 minBatch, JobFunction function, void* data);
+
+    template <typename Function>
+    void ParallelFor(u32 itemCount, u32 minBatch, const Function& function) {
+        struct Trampoline {
+            static void Call(void* data, u32 first, u32 count) { (*(const Function*)data)(first, count); }
+        };
+        ParallelFor(itemCount, minBatch, &Trampoline::Call, (void*)&function);
+    }
+
+    u32 GetWorkerCount() const { return WorkerCount; }
+    // JOB_WORKER_NONE on threads that are not this system's workers.
+    u32 GetCurrentWorker() const;
+    JobSystemStats GetStats() const;
+
+private:
+    struct Job {
+        JobFunction Function;
+        void* Data;
+        u32 First;
+        u32 Count;
+        JobCounter* Counter;
+    };
+
+    struct alignas(64) WorkQueue {
+        std::atomic<i64> Top{0};
+        alignas(64) std::atomic<i64> Bottom{0};
+        alignas(64) std::atomic<u64> JobsRun{0};
+        std::atomic<u64> Steals{0};
+        Job Jobs[JOB_QUEUE_CAPACITY];
+
+        bool Push(const Job& job);
+        bool Pop(Job& job);
+        bool Steal(Job& job);
+    };
+
+    void WorkerLoop(u32 worker);
+    bool FindJob(u32 worker, Job& job);
+    void Execute(u32 worker, const Job& job);
+    bool HasWork() const;
+    void Wake();
+
+    u32 WorkerCount = 0;
+    std::unique_ptr<WorkQueue[]> Queues;
+    std::vector<std::thread> Threads;
+
+    // Jobs from threads that are not workers.
+    std::mutex SharedMutex;
+    std::vector<Job> SharedJobs;
+    std::atomic<u32> SharedCount{0};
+    std::atomic<u64> SharedJobsRun{0};
+
+    std::mutex SleepMutex;
+    std::condition_variable WorkReady;
+    std::atomic<u64> WakeEpoch{0};
+    std::atomic<u32> Sleeping{0};
+    std::atomic<bool> Quit{false};
+};
@@ -1,4 +1,5 @@
 #include "Logger.h"
+#include <algorithm>
 #include <cstring>
 #include <stdarg.h> 
 #include <stdio.h>
@@ -11,6 +12,8 @@
 
 #endif
 
+// Formats straight into one stack buffer: no heap, no second copy, and
+// nothing to clear first since vsnprintf terminates what it writes.
 void Logger::Log(LogLevel level, const char* message, ...)
 {
     const char* level_strings[6] = {"[FATAL]: ", "[ERROR]: ", "[WARN]: ", "[INFO]: ", "[DEBUG]: ", "[TRACE]: "};
@@ -20,24 +23,29 @@ void Logger::Log(LogLevel level, const char* message, ...)
     const i32 msgLength = 32000;
     char output[msgLength];
 
-    memset(output,0,sizeof(output));
+    i32 prefixLength = (i32)strlen(level_strings[level]);
+    memcpy(output, level_strings[level], prefixLength);
 
     va_list arg_ptr;
     va_start(arg_ptr, message);
-    vsnprintf(output, 32000, message, arg_ptr);
+    i32 length = vsnprintf(output + prefixLength, msgLength - prefixLength - 1, message, arg_ptr);
     va_end(arg_ptr);
 
-    char output2[32000];
-    sprintf(output2, "%s%s\n", level_strings[level], output);
+    // Leave room for the newline when the message was cut short.
+    length = length < 0 ? 0 : std::min(length, msgLength - prefixLength - 2);
+    output[prefixLength + length] = '\n';
+    output[prefixLength + length + 1] = '\0';
 
     if (!isError){
-        Write(output2, level);
+        Write(output, level);
     }
     else{
-        WriteError(output2, level);
+        WriteError(output, level);
     }
 }
 
+#if EM_PLATFORM_WINDOWS
+
 void Logger::Write(const char* message, u8 color)
 {
     HANDLE hcon = GetStdHandle(STD_ERROR_HANDLE);
@@ -68,3 +76,16 @@ void Logger::WriteError(const char* message, u8 color)
     WriteConsoleA(hcon, message, (DWORD)length, number_written, 0);
 }
 
+#else
+
+void Logger::Write(const char* message, u8 color)
+{
+    fputs(message, stdout);
+}
+
+void Logger::WriteError(const char* message, u8 color)
+{
+    fputs(message, stderr);
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include "GameLoop.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+bool GameLoop::Initialize(f64 ticksPerSecond, u32 maxTicksPerFrame) {
+    if (ticksPerSecond <= 0.0 || maxTicksPerFrame == 0) {
+        EM_ERROR("Invalid game loop tick rate %f or tick limit %u", ticksPerSecond, maxTicksPerFrame);
+        return false;
+    }
+
+    TickSeconds = 1.0 / ticksPerSecond;
+    MaxTicksPerFrame = maxTicksPerFrame;
+    Accumulator = 0.0;
+    Started = false;
+    Activity = LOOP_ACTIVE;
+    Stats = {};
+
+    return true;
+}
+
+u32 GameLoop::BeginFrame() {
+    Clock::time_point now = Clock::now();
+
+    f64 frameSeconds = 0.0;
+    if (Started) {
+        frameSeconds = std::chrono::duration<f64>(now - LastFrame).count();
+    }
+    LastFrame = now;
+    Started = true;
+
+    return Advance(frameSeconds);
+}
+
+u32 GameLoop::Advance(f64 frameSeconds) {
+    Accumulator += std::max(frameSeconds, 0.0);
+
+    u32 ticks = (u32)(Accumulator / TickSeconds);
+    if (ticks > MaxTicksPerFrame) {
+        // Keep the fraction so alpha stays continuous across the clamp.
+        Stats.DroppedTicks += ticks - MaxTicksPerFrame;
+        Accumulator -= (f64)(ticks - MaxTicksPerFrame) * TickSeconds;
+        ticks = MaxTicksPerFrame;
+    }
+    Accumulator -= (f64)ticks * TickSeconds;
+    // Rounding can leave a hair under zero or at a whole tick.
+    Accumulator = std::min(std::max(Accumulator, 0.0), TickSeconds * 0.999999);
+
+    Stats.Ticks += ticks;
+    Stats.Frames++;
+    Stats.LastFrameTicks = ticks;
+    Stats.LastFrameMs = frameSeconds * 1000.0;
+
+    return ticks;
+}
+
+void GameLoop::Resync() {
+    Started = false;
+}
+
+bool GameLoop::SetActivity(LoopActivity activity) {
+    if (activity == Activity) {
+        return false;
+    }
+
+    if (Activity == LOOP_SUSPENDED) {
+        Resync();
+    }
+    Activity = activity;
+
+    return true;
+}
+
+void GameLoop::SetFrameRateLimits(f64 active, f64 background) {
+    ActiveFrameRate = std::max(active, 0.0);
+    BackgroundFrameRate = std::max(background, 0.0);
+}
+
+f64 GameLoop::GetFrameRateLimit() const {
+    return Activity == LOOP_ACTIVE ? ActiveFrameRate : BackgroundFrameRate;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <chrono>
+
+const f64 DEFAULT_TICK_RATE = 60.0;
+// Frames longer than this many ticks drop the excess instead of simulating
+// it; otherwise a slow frame schedules more ticks, which make the next frame
+// slower still.
+const u32 DEFAULT_MAX_TICKS_PER_FRAME = 5;
+const f64 DEFAULT_BACKGROUND_FRAME_RATE = 15.0;
+
+enum LoopActivity
+{
+    // Focused: render at the active frame rate limit.
+    LOOP_ACTIVE = 0,
+    // Visible but unfocused: render at the background rate.
+    LOOP_BACKGROUND = 1,
+    // Minimized: neither simulate nor render; Resync on the way out.
+    LOOP_SUSPENDED = 2,
+};
+
+struct GameLoopStats {
+    u64 Ticks;
+    u64 Frames;
+    u64 DroppedTicks;    // whole ticks lost to the per-frame clamp
+    u32 LastFrameTicks;
+    f64 LastFrameMs;
+};
+
+// Fixed-timestep clock for the main loop. Each frame adds the real time
+// since the last one to an accumulator and runs as many whole ticks as it
+// holds, so the simulation always steps by GetTickSeconds() and replays the
+// same way at any frame rate. What is left over is GetAlpha(), how far real
+// time is into the next tick; render state interpolated between the last two
+// ticks by alpha moves smoothly even when frames and ticks don't line up.
+//
+//     u32 ticks = loop.BeginFrame();
+//     for (u32 i = 0; i < ticks; i++) { previous = current; Step(current, loop.GetTickSeconds()); }
+//     Draw(Lerp(previous, current, loop.GetAlpha()));
+class GameLoop {
+public:
+    bool Initialize(f64 ticksPerSecond = DEFAULT_TICK_RATE, u32 maxTicksPerFrame = DEFAULT_MAX_TICKS_PER_FRAME);
+
+    // Measures the time since the previous call and returns the ticks due.
+    u32 BeginFrame();
+    // Same with a given frame time, for replays and tests.
+    u32 Advance(f64 frameSeconds);
+    // Forgets the time since the previous frame, e.g. after a suspend, so
+    // the simulation doesn't try to catch up on it.
+    void Resync();
+
+    f64 GetTickSeconds() const { return TickSeconds; }
+    u64 GetTick() const { return Stats.Ticks; }
+    f64 GetSimulationTime() const { return (f64)Stats.Ticks * TickSeconds; }
+    // Fraction of a tick since the last one, in [0, 1).
+    f32 GetAlpha() const { return (f32)(Accumulator / TickSeconds); }
+
+    // Records the window state and returns true when it changed. Callers
+    // apply GetFrameRateLimit() to the renderer on change and skip the
+    // frame while suspended.
+    bool SetActivity(LoopActivity activity);
+    LoopActivity GetActivity() const { return Activity; }
+    // 0 = uncapped, e.g. when presentation already waits for vsync.
+    void SetFrameRateLimits(f64 active, f64 background = DEFAULT_BACKGROUND_FRAME_RATE);
+    f64 GetFrameRateLimit() const;
+
+    GameLoopStats GetStats() const { return Stats; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    f64 TickSeconds = 1.0 / DEFAULT_TICK_RATE;
+    u32 MaxTicksPerFrame = DEFAULT_MAX_TICKS_PER_FRAME;
+    f64 Accumulator = 0.0;
+    Clock::time_point LastFrame;
+    bool Started = false;
+
+    LoopActivity Activity = LOOP_ACTIVE;
+    f64 ActiveFrameRate = 0.0;
+    f64 BackgroundFrameRate = DEFAULT_BACKGROUND_FRAME_RATE;
+
+    GameLoopStats Stats{};
+};
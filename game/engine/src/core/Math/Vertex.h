@@ -1,16 +1,20 @@
 #pragma once
 
+#include "defines.h"
 #include <vendor/glm/glm/glm.hpp>
+#include <vendor/glm/glm/gtc/packing.hpp>
 #include <vulkan/vulkan.h>
 #include <array>
 #include <vector>
 
+// Full precision vertex, used to author geometry on the CPU. The GPU reads
+// one of the packed layouts below.
 struct Vertex {
     glm::vec2 pos;
     glm::vec3 color;
 
      static VkVertexInputBindingDescription GetBindingDescription() {
-        
+
         VkVertexInputBindingDescription bindingDescription;
 
         bindingDescription.binding = 0;
@@ -35,4 +39,98 @@ struct Vertex {
 
         return attributeDescriptions;
     }
-};
\ No newline at end of file
+};
+
+// Shared attribute layout of the packed vertices: position at location 0,
+// RGBA8 color at 1 and unorm16 UV at 2. Shaders see the same vec2/vec4
+// inputs as with floats.
+template <typename PackedType>
+std::array<VkVertexInputAttributeDescription, 3> GetPackedAttributeDescriptions(VkFormat positionFormat) {
+    std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = positionFormat;
+    attributeDescriptions[0].offset = offsetof(PackedType, Position);
+
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[1].offset = offsetof(PackedType, Color);
+
+    attributeDescriptions[2].binding = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = VK_FORMAT_R16G16_UNORM;
+    attributeDescriptions[2].offset = offsetof(PackedType, UV);
+
+    return attributeDescriptions;
+}
+
+// Unit-space geometry such as the shared quad: snorm16 position in [-1, 1].
+// 12 bytes against Vertex's 20.
+struct PackedVertex {
+    u32 Position;
+    u32 Color;
+    u32 UV;
+
+    static VkVertexInputBindingDescription GetBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription;
+
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(PackedVertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions() {
+        return GetPackedAttributeDescriptions<PackedVertex>(VK_FORMAT_R16G16_SNORM);
+    }
+};
+
+// Geometry in local coordinates, e.g. relative to a tile chunk: half float
+// position, exact on integers up to 2048. Also 12 bytes.
+struct HalfVertex {
+    u32 Position;
+    u32 Color;
+    u32 UV;
+
+    static VkVertexInputBindingDescription GetBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription;
+
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(HalfVertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 3> GetAttributeDescriptions() {
+        return GetPackedAttributeDescriptions<HalfVertex>(VK_FORMAT_R16G16_SFLOAT);
+    }
+};
+
+STATIC_ASSERT(sizeof(PackedVertex) == 12, "Expected PackedVertex to be 12 bytes.");
+STATIC_ASSERT(sizeof(HalfVertex) == 12, "Expected HalfVertex to be 12 bytes.");
+
+// Out of range inputs are clamped: positions to [-1, 1] (PackedVertex),
+// colors and UVs to [0, 1].
+inline PackedVertex PackVertex(const glm::vec2& position, const glm::vec4& color, const glm::vec2& uv) {
+    return {glm::packSnorm2x16(position), glm::packUnorm4x8(color), glm::packUnorm2x16(uv)};
+}
+
+inline PackedVertex PackVertex(const Vertex& vertex, const glm::vec2& uv = glm::vec2(0.0f)) {
+    return PackVertex(vertex.pos, glm::vec4(vertex.color, 1.0f), uv);
+}
+
+inline HalfVertex PackHalfVertex(const glm::vec2& position, const glm::vec4& color, const glm::vec2& uv) {
+    return {glm::packHalf2x16(position), glm::packUnorm4x8(color), glm::packUnorm2x16(uv)};
+}
+
+inline Vertex UnpackVertex(const PackedVertex& vertex) {
+    return {glm::unpackSnorm2x16(vertex.Position), glm::vec3(glm::unpackUnorm4x8(vertex.Color))};
+}
+
+inline Vertex UnpackVertex(const HalfVertex& vertex) {
+    return {glm::unpackHalf2x16(vertex.Position), glm::vec3(glm::unpackUnorm4x8(vertex.Color))};
+}
@@ -0,0 +1,222 @@
+#include "AllocationHook.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if EM_PLATFORM_WINDOWS
+#include <malloc.h>
+#include <windows.h>
+#elif defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+
+u64 AllocationHook::FrameAllocations = 0;
+u64 AllocationHook::FrameStart = 0;
+u32 AllocationHook::WarmupFramesLeft = 0;
+
+// Plain statics only: operator new can run before any constructor does.
+static std::atomic<u64> AllocationCount{0};
+static std::atomic<u64> FreeCount{0};
+static std::atomic<u64> AllocatedBytes{0};
+
+static std::atomic<u32> GuardMode{ALLOCATION_GUARD_OFF};
+static std::atomic<bool> GuardArmed{false};
+static std::atomic<u64> GuardViolations{0};
+
+static std::mutex SiteMutex;
+static u64 ReportedSites[MAX_ALLOCATION_GUARD_SITES];
+static u32 ReportedSiteCount = 0;
+
+static thread_local u32 Allowance = 0;
+static thread_local bool Reporting = false;
+
+static u32 CaptureCallStack(void** frames, u32 maxFrames) {
+#if EM_PLATFORM_WINDOWS
+    return CaptureStackBackTrace(0, maxFrames, frames, nullptr);
+#elif defined(__GLIBC__)
+    return (u32)backtrace(frames, (int)maxFrames);
+#else
+    frames[0] = __builtin_return_address(0);
+    return 1;
+#endif
+}
+
+// Sites are told apart by their whole stack, so the same container growing
+// in two places counts as two sites.
+static u64 HashCallStack(void* const* frames, u32 count) {
+    u64 hash = 14695981039346656037ull;
+    for (u32 i = 0; i < count; i++) {
+        hash ^= (u64)(size_t)frames[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static bool IsNewSite(u64 site) {
+    std::lock_guard<std::mutex> lock(SiteMutex);
+
+    for (u32 i = 0; i < ReportedSiteCount; i++) {
+        if (ReportedSites[i] == site) {
+            return false;
+        }
+    }
+    if (ReportedSiteCount < MAX_ALLOCATION_GUARD_SITES) {
+        ReportedSites[ReportedSiteCount++] = site;
+    }
+
+    return true;
+}
+
+static void ReportAllocation(size_t size) {
+    GuardViolations.fetch_add(1, std::memory_order_relaxed);
+
+    void* frames[MAX_ALLOCATION_GUARD_FRAMES];
+    u32 frameCount = CaptureCallStack(frames, MAX_ALLOCATION_GUARD_FRAMES);
+    bool abortAfter = GuardMode.load(std::memory_order_relaxed) == ALLOCATION_GUARD_ASSERT;
+
+    if (!abortAfter && !IsNewSite(HashCallStack(frames, frameCount))) {
+        return;
+    }
+
+    EM_WARN("Steady-state frame allocated %zu bytes, from:", size);
+#if defined(__GLIBC__)
+    // Straight to the descriptor the warning went to; backtrace_symbols
+    // would allocate.
+    fflush(stdout);
+    backtrace_symbols_fd(frames, (int)frameCount, fileno(stdout));
+#else
+    for (u32 i = 0; i < frameCount; i++) {
+        EM_WARN("    #%u %p", i, frames[i]);
+    }
+#endif
+
+    if (abortAfter) {
+        EM_FATAL("Allocation in a guarded frame");
+        abort();
+    }
+}
+
+static void CountAllocation(size_t size) {
+    AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (GuardArmed.load(std::memory_order_relaxed) && Allowance == 0 && !Reporting) {
+        Reporting = true;
+        ReportAllocation(size);
+        Reporting = false;
+    }
+}
+
+AllocationCounters AllocationHook::GetCounters() {
+    AllocationCounters counters;
+    counters.Allocations = AllocationCount.load(std::memory_order_relaxed);
+    counters.Frees = FreeCount.load(std::memory_order_relaxed);
+    counters.Bytes = AllocatedBytes.load(std::memory_order_relaxed);
+
+    return counters;
+}
+
+void AllocationHook::SetGuard(AllocationGuardMode mode, u32 warmupFrames) {
+    if (!IsEnabled() && mode != ALLOCATION_GUARD_OFF) {
+        EM_WARN("Allocation guard requested, but the allocation hook is compiled out");
+        return;
+    }
+
+    GuardArmed.store(false, std::memory_order_relaxed);
+    GuardMode.store(mode, std::memory_order_relaxed);
+    WarmupFramesLeft = warmupFrames;
+
+    if (mode != ALLOCATION_GUARD_OFF && warmupFrames == 0) {
+        GuardArmed.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool AllocationHook::IsGuardArmed() {
+    return GuardArmed.load(std::memory_order_relaxed);
+}
+
+u64 AllocationHook::GetGuardViolations() {
+    return GuardViolations.load(std::memory_order_relaxed);
+}
+
+void AllocationHook::EndFrame() {
+    u64 count = AllocationCount.load(std::memory_order_relaxed);
+    FrameAllocations = count - FrameStart;
+    FrameStart = count;
+
+    if (GuardMode.load(std::memory_order_relaxed) == ALLOCATION_GUARD_OFF || GuardArmed.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (WarmupFramesLeft > 0) {
+        WarmupFramesLeft--;
+    }
+    if (WarmupFramesLeft == 0) {
+        GuardArmed.store(true, std::memory_order_relaxed);
+    }
+}
+
+ScopedAllocationAllowance::ScopedAllocationAllowance() {
+    Allowance++;
+}
+
+ScopedAllocationAllowance::~ScopedAllocationAllowance() {
+    Allowance--;
+}
+
+#if EM_ALLOCATION_HOOK
+
+// The array, nothrow and sized forms forward to these by default.
+void* operator new(size_t size) {
+    CountAllocation(size);
+
+    void* block = malloc(size > 0 ? size : 1);
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return block;
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    CountAllocation(size);
+
+    size_t align = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+    void* block = nullptr;
+#if EM_PLATFORM_WINDOWS
+    block = _aligned_malloc(size > 0 ? size : 1, align);
+#else
+    if (posix_memalign(&block, align, size > 0 ? size : 1) != 0) {
+        block = nullptr;
+    }
+#endif
+    if (block == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    if (block != nullptr) {
+        FreeCount.fetch_add(1, std::memory_order_relaxed);
+        free(block);
+    }
+}
+
+void operator delete(void* block, std::align_val_t alignment) noexcept {
+    if (block != nullptr) {
+        FreeCount.fetch_add(1, std::memory_order_relaxed);
+#if EM_PLATFORM_WINDOWS
+        _aligned_free(block);
+#else
+        free(block);
+#endif
+    }
+}
+
+#endif
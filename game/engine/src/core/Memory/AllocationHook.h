@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+const u32 DEFAULT_ALLOCATION_GUARD_WARMUP_FRAMES = 120;
+const u32 MAX_ALLOCATION_GUARD_SITES = 64;
+const u32 MAX_ALLOCATION_GUARD_FRAMES = 16;   // call stack depth in reports
+
+enum AllocationGuardMode
+{
+    ALLOCATION_GUARD_OFF = 0,
+    // Logs the call stack of each distinct site that allocates in a guarded
+    // frame, once per site.
+    ALLOCATION_GUARD_REPORT = 1,
+    // Logs the first such allocation and aborts.
+    ALLOCATION_GUARD_ASSERT = 2,
+};
+
+struct AllocationCounters {
+    u64 Allocations;
+    u64 Frees;
+    u64 Bytes;   // requested by Allocations
+};
+
+// Counts every global operator new and delete in the process, on any thread,
+// by replacing them (when built with EM_ALLOCATION_HOOK). Memory::EndFrame
+// closes a frame, which gives per-frame counts.
+//
+// The guard checks that frames stop allocating once warmed up: after
+// SetGuard's warmup frames, any allocation is reported with its call stack,
+// unless the thread is inside a ScopedAllocationAllowance. Use one of those
+// around work that is allowed to allocate mid-game, such as swapchain
+// recreation or loading.
+//
+// Only C++ allocations are seen. malloc calls from C libraries and drivers
+// don't go through operator new.
+class AllocationHook {
+public:
+    static bool IsEnabled() { return EM_ALLOCATION_HOOK != 0; }
+
+    static AllocationCounters GetCounters();
+    // Allocations during the last frame closed by EndFrame.
+    static u64 GetFrameAllocations() { return FrameAllocations; }
+
+    static void SetGuard(AllocationGuardMode mode, u32 warmupFrames = DEFAULT_ALLOCATION_GUARD_WARMUP_FRAMES);
+    static bool IsGuardArmed();
+    // Guarded-frame allocations outside an allowance, reported or not.
+    static u64 GetGuardViolations();
+
+    static void EndFrame();
+
+private:
+    static u64 FrameAllocations;
+    static u64 FrameStart;
+    static u32 WarmupFramesLeft;
+};
+
+// Lets this thread allocate through the guard while in scope. Nests.
+class ScopedAllocationAllowance {
+public:
+    ScopedAllocationAllowance();
+    ~ScopedAllocationAllowance();
+
+    ScopedAllocationAllowance(const ScopedAllocationAllowance&) = delete;
+    ScopedAllocationAllowance& operator=(const ScopedAllocationAllowance&) = delete;
+};
@@ -0,0 +1,65 @@
+#include "LinearAllocator.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+const size_t LINEAR_ALLOCATOR_ALIGNMENT = 64;
+
+bool LinearAllocator::Initialize(size_t capacity, const char* name) {
+    Shutdown();
+
+    Base = (u8*)Memory::Allocate(capacity, MEMORY_TAG_ALLOCATOR, LINEAR_ALLOCATOR_ALIGNMENT);
+    Capacity = capacity;
+    Name = name;
+
+    return true;
+}
+
+void LinearAllocator::Shutdown() {
+    if (Base == nullptr) {
+        return;
+    }
+
+    Reset();
+    Memory::Free(Base, Capacity, MEMORY_TAG_ALLOCATOR, LINEAR_ALLOCATOR_ALIGNMENT);
+    Base = nullptr;
+    Capacity = 0;
+    HighWater = 0;
+}
+
+void* LinearAllocator::Allocate(size_t size, MemoryTag tag, size_t alignment) {
+    size_t head = Head.load(std::memory_order_relaxed);
+    size_t start;
+    size_t end;
+    do {
+        start = (head + alignment - 1) & ~(alignment - 1);
+        end = start + size;
+        if (end > Capacity) {
+            if (!OverflowReported.exchange(true, std::memory_order_relaxed)) {
+                EM_ERROR("%s arena full: %zu of %zu bytes used, %zu requested", Name, head, Capacity, size);
+            }
+            return nullptr;
+        }
+    } while (!Head.compare_exchange_weak(head, end, std::memory_order_relaxed));
+
+    TagBytes[tag].fetch_add(size, std::memory_order_relaxed);
+    TagAllocations[tag].fetch_add(1, std::memory_order_relaxed);
+    Memory::Track(tag, size);
+
+    return Base + start;
+}
+
+void LinearAllocator::Reset() {
+    for (u32 tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        u32 count = TagAllocations[tag].exchange(0, std::memory_order_relaxed);
+        u64 bytes = TagBytes[tag].exchange(0, std::memory_order_relaxed);
+        if (count > 0) {
+            Memory::Untrack((MemoryTag)tag, bytes, count);
+        }
+    }
+
+    size_t used = Head.exchange(0, std::memory_order_relaxed);
+    if (used > HighWater) {
+        HighWater = used;
+    }
+    OverflowReported.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Memory.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <atomic>
+
+// Arena over one fixed block: allocating is an atomic pointer bump, so any
+// thread may allocate, and Reset releases everything at once. There is no
+// per-allocation free. Allocate returns nullptr when the block is full and
+// reports the overflow once per Reset.
+class LinearAllocator {
+public:
+    bool Initialize(size_t capacity, const char* name);
+    void Shutdown();
+
+    void* Allocate(size_t size, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT);
+    template <typename T>
+    T* AllocateArray(u32 count, MemoryTag tag) { return (T*)Allocate(sizeof(T) * count, tag, alignof(T)); }
+
+    // Must not race with Allocate.
+    void Reset();
+
+    size_t GetUsed() const { return Head.load(std::memory_order_relaxed); }
+    size_t GetCapacity() const { return Capacity; }
+    size_t GetHighWater() const { return HighWater; }
+
+private:
+    u8* Base = nullptr;
+    size_t Capacity = 0;
+    const char* Name = "";
+    std::atomic<size_t> Head{0};
+    size_t HighWater = 0;
+    std::atomic<bool> OverflowReported{false};
+
+    // Charged since the last Reset, to release from the tag counters.
+    std::atomic<u64> TagBytes[MEMORY_TAG_COUNT] = {};
+    std::atomic<u32> TagAllocations[MEMORY_TAG_COUNT] = {};
+};
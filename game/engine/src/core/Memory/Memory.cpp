@@ -0,0 +1,137 @@
+#include "Memory.h"
+#include "AllocationHook.h"
+#include "LinearAllocator.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <atomic>
+#include <new>
+
+struct TagCounters {
+    std::atomic<u64> Bytes{0};
+    std::atomic<u64> Allocations{0};
+    std::atomic<u64> PeakBytes{0};
+    std::atomic<u64> TotalAllocations{0};
+};
+
+static const char* TAG_NAMES[MEMORY_TAG_COUNT] = {
+    "unknown",
+    "allocator",
+    "renderer",
+    "sprites",
+    "scene",
+    "ecs",
+    "jobs",
+    "game",
+};
+
+static TagCounters TagStats[MEMORY_TAG_COUNT];
+static TagCounters HeapStats;
+static LinearAllocator FrameMemory;
+
+static void Add(TagCounters& counters, u64 bytes, u32 count) {
+    u64 live = counters.Bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    counters.Allocations.fetch_add(count, std::memory_order_relaxed);
+    counters.TotalAllocations.fetch_add(count, std::memory_order_relaxed);
+
+    u64 peak = counters.PeakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+static void Subtract(TagCounters& counters, u64 bytes, u32 count) {
+    counters.Bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    counters.Allocations.fetch_sub(count, std::memory_order_relaxed);
+}
+
+static MemoryTagStats Read(const TagCounters& counters) {
+    MemoryTagStats stats;
+    stats.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+    stats.Allocations = counters.Allocations.load(std::memory_order_relaxed);
+    stats.PeakBytes = counters.PeakBytes.load(std::memory_order_relaxed);
+    stats.TotalAllocations = counters.TotalAllocations.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+bool Memory::Initialize(size_t frameMemorySize) {
+    return FrameMemory.Initialize(frameMemorySize, "frame");
+}
+
+void Memory::Shutdown() {
+    FrameMemory.Shutdown();
+
+    for (u32 tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        if (TagStats[tag].Bytes.load(std::memory_order_relaxed) > 0) {
+            EM_WARN("Memory tag %s still holds %llu bytes in %llu allocations at shutdown", TAG_NAMES[tag],
+                    (unsigned long long)TagStats[tag].Bytes.load(), (unsigned long long)TagStats[tag].Allocations.load());
+        }
+    }
+}
+
+void* Memory::Allocate(size_t size, MemoryTag tag, size_t alignment) {
+    void* block = ::operator new(size, std::align_val_t(alignment));
+
+    Add(HeapStats, size, 1);
+    Add(TagStats[tag], size, 1);
+
+    return block;
+}
+
+void Memory::Free(void* block, size_t size, MemoryTag tag, size_t alignment) {
+    if (block == nullptr) {
+        return;
+    }
+
+    ::operator delete(block, std::align_val_t(alignment));
+
+    Subtract(HeapStats, size, 1);
+    Subtract(TagStats[tag], size, 1);
+}
+
+void* Memory::AllocateFrame(size_t size, MemoryTag tag, size_t alignment) {
+    return FrameMemory.Allocate(size, tag, alignment);
+}
+
+LinearAllocator& Memory::GetFrameAllocator() {
+    return FrameMemory;
+}
+
+void Memory::EndFrame() {
+    FrameMemory.Reset();
+    AllocationHook::EndFrame();
+}
+
+void Memory::Track(MemoryTag tag, u64 bytes, u32 count) {
+    Add(TagStats[tag], bytes, count);
+}
+
+void Memory::Untrack(MemoryTag tag, u64 bytes, u32 count) {
+    Subtract(TagStats[tag], bytes, count);
+}
+
+MemoryTagStats Memory::GetTagStats(MemoryTag tag) {
+    return Read(TagStats[tag]);
+}
+
+MemoryTagStats Memory::GetHeapStats() {
+    return Read(HeapStats);
+}
+
+const char* Memory::GetTagName(MemoryTag tag) {
+    return tag < MEMORY_TAG_COUNT ? TAG_NAMES[tag] : "invalid";
+}
+
+void Memory::LogUsage() {
+    MemoryTagStats heap = GetHeapStats();
+    EM_INFO("Memory: %.2f MB live in %llu heap allocations, peak %.2f MB", heap.Bytes / (1024.0 * 1024.0),
+            (unsigned long long)heap.Allocations, heap.PeakBytes / (1024.0 * 1024.0));
+
+    for (u32 tag = 0; tag < MEMORY_TAG_COUNT; tag++) {
+        MemoryTagStats stats = GetTagStats((MemoryTag)tag);
+        if (stats.TotalAllocations == 0) {
+            continue;
+        }
+        EM_INFO("  %-10s %10.1f KB in %6llu, peak %10.1f KB, %llu total", TAG_NAMES[tag], stats.Bytes / 1024.0,
+                (unsigned long long)stats.Allocations, stats.PeakBytes / 1024.0, (unsigned long long)stats.TotalAllocations);
+    }
+}
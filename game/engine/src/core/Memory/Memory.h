@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <stddef.h>
+
+const size_t DEFAULT_FRAME_MEMORY_SIZE = 4 * 1024 * 1024;
+const size_t DEFAULT_MEMORY_ALIGNMENT = 16;
+
+// Subsystem an allocation is charged to. Keep GetTagName in sync.
+enum MemoryTag
+{
+    MEMORY_TAG_UNKNOWN = 0,
+    // Backing blocks of arenas, pools and stacks; what they hand out is
+    // charged to the caller's tag as well.
+    MEMORY_TAG_ALLOCATOR = 1,
+    MEMORY_TAG_RENDERER = 2,
+    MEMORY_TAG_SPRITES = 3,
+    MEMORY_TAG_SCENE = 4,
+    MEMORY_TAG_ECS = 5,
+    MEMORY_TAG_JOBS = 6,
+    MEMORY_TAG_GAME = 7,
+    MEMORY_TAG_COUNT = 8,
+};
+
+struct MemoryTagStats {
+    u64 Bytes;              // live
+    u64 Allocations;        // live
+    u64 PeakBytes;
+    u64 TotalAllocations;   // since startup, to spot churn
+};
+
+class LinearAllocator;
+
+// Engine memory entry point: tagged heap allocations, the per-tag counters
+// every allocator reports to, and the frame arena.
+//
+// Counters are live and lock free, so GetTagStats can be polled every frame.
+// Memory handed out by an arena, pool or stack counts under its own tag and
+// again under MEMORY_TAG_ALLOCATOR as part of the backing block, so the tags
+// add up to more than GetHeapStats, which is real heap traffic only.
+class Memory {
+public:
+    static bool Initialize(size_t frameMemorySize = DEFAULT_FRAME_MEMORY_SIZE);
+    static void Shutdown();
+
+    static void* Allocate(size_t size, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT);
+    // size, tag and alignment must match the Allocate call.
+    static void Free(void* block, size_t size, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT);
+
+    // Scratch memory that lives until EndFrame; nullptr when the frame's
+    // arena is full. Safe to call from job workers.
+    static void* AllocateFrame(size_t size, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT);
+    template <typename T>
+    static T* AllocateFrameArray(u32 count, MemoryTag tag) { return (T*)AllocateFrame(sizeof(T) * count, tag, alignof(T)); }
+    static LinearAllocator& GetFrameAllocator();
+    // Releases everything from AllocateFrame at once and closes the frame
+    // for AllocationHook; call after Draw.
+    static void EndFrame();
+
+    // For allocators: charge or release memory they hand out.
+    static void Track(MemoryTag tag, u64 bytes, u32 count = 1);
+    static void Untrack(MemoryTag tag, u64 bytes, u32 count = 1);
+
+    static MemoryTagStats GetTagStats(MemoryTag tag);
+    static MemoryTagStats GetHeapStats();
+    static const char* GetTagName(MemoryTag tag);
+    static void LogUsage();
+};
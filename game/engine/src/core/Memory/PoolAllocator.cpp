@@ -0,0 +1,84 @@
+#include "PoolAllocator.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+bool PoolAllocator::Initialize(size_t blockSize, u32 blocksPerPage, MemoryTag tag, size_t alignment) {
+    Shutdown();
+
+    if (blocksPerPage == 0 || (alignment & (alignment - 1)) != 0) {
+        EM_ERROR("Invalid pool: %u blocks per page, alignment %zu", blocksPerPage, alignment);
+        return false;
+    }
+
+    // Free blocks hold the list link, and every block must stay aligned.
+    if (alignment < alignof(FreeBlock)) {
+        alignment = alignof(FreeBlock);
+    }
+    if (blockSize < sizeof(FreeBlock)) {
+        blockSize = sizeof(FreeBlock);
+    }
+    BlockSize = (blockSize + alignment - 1) & ~(alignment - 1);
+    Alignment = alignment;
+    BlocksPerPage = blocksPerPage;
+    Tag = tag;
+
+    return true;
+}
+
+void PoolAllocator::Shutdown() {
+    if (UsedCount > 0) {
+        EM_WARN("Pool for %s shut down with %u blocks in use", Memory::GetTagName(Tag), UsedCount);
+        Memory::Untrack(Tag, (u64)UsedCount * BlockSize, UsedCount);
+    }
+
+    for (u8* page : Pages) {
+        Memory::Free(page, BlockSize * BlocksPerPage, MEMORY_TAG_ALLOCATOR, Alignment);
+    }
+    Pages.clear();
+    FreeList = nullptr;
+    UsedCount = 0;
+}
+
+void* PoolAllocator::Allocate() {
+    if (FreeList == nullptr && !AddPage()) {
+        return nullptr;
+    }
+
+    FreeBlock* block = FreeList;
+    FreeList = block->Next;
+    UsedCount++;
+    Memory::Track(Tag, BlockSize);
+
+    return block;
+}
+
+void PoolAllocator::Free(void* block) {
+    if (block == nullptr) {
+        return;
+    }
+
+    FreeBlock* freed = (FreeBlock*)block;
+    freed->Next = FreeList;
+    FreeList = freed;
+    UsedCount--;
+    Memory::Untrack(Tag, BlockSize);
+}
+
+bool PoolAllocator::AddPage() {
+    if (BlockSize == 0) {
+        EM_ERROR("Pool allocator used before Initialize");
+        return false;
+    }
+
+    u8* page = (u8*)Memory::Allocate(BlockSize * BlocksPerPage, MEMORY_TAG_ALLOCATOR, Alignment);
+    Pages.push_back(page);
+
+    // Thread the list back to front so blocks come out in address order.
+    for (u32 i = BlocksPerPage; i > 0; i--) {
+        FreeBlock* block = (FreeBlock*)(page + (i - 1) * BlockSize);
+        block->Next = FreeList;
+        FreeList = block;
+    }
+
+    return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Memory.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vector>
+
+// Fixed-size blocks from pages of blocksPerPage, recycled through an
+// intrusive free list: Allocate and Free are a pointer swap once the pool
+// has grown to its working size. A new page is the only heap allocation.
+// Not thread safe.
+class PoolAllocator {
+public:
+    bool Initialize(size_t blockSize, u32 blocksPerPage, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT);
+    void Shutdown();
+
+    void* Allocate();
+    void Free(void* block);
+
+    size_t GetBlockSize() const { return BlockSize; }
+    u32 GetUsedCount() const { return UsedCount; }
+    u32 GetFreeCount() const { return (u32)Pages.size() * BlocksPerPage - UsedCount; }
+    u32 GetPageCount() const { return (u32)Pages.size(); }
+
+private:
+    struct FreeBlock {
+        FreeBlock* Next;
+    };
+
+    bool AddPage();
+
+    size_t BlockSize = 0;
+    size_t Alignment = DEFAULT_MEMORY_ALIGNMENT;
+    u32 BlocksPerPage = 0;
+    MemoryTag Tag = MEMORY_TAG_UNKNOWN;
+    std::vector<u8*> Pages;
+    FreeBlock* FreeList = nullptr;
+    u32 UsedCount = 0;
+};
@@ -0,0 +1,67 @@
+#include "StackAllocator.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+const size_t STACK_ALLOCATOR_ALIGNMENT = 64;
+
+bool StackAllocator::Initialize(size_t capacity, const char* name) {
+    Shutdown();
+
+    Base = (u8*)Memory::Allocate(capacity, MEMORY_TAG_ALLOCATOR, STACK_ALLOCATOR_ALIGNMENT);
+    Capacity = capacity;
+    Name = name;
+
+    return true;
+}
+
+void StackAllocator::Shutdown() {
+    if (Base == nullptr) {
+        return;
+    }
+
+    FreeToMarker(0);
+    Memory::Free(Base, Capacity, MEMORY_TAG_ALLOCATOR, STACK_ALLOCATOR_ALIGNMENT);
+    Base = nullptr;
+    Capacity = 0;
+    HighWater = 0;
+}
+
+void* StackAllocator::Allocate(size_t size, MemoryTag tag, size_t alignment) {
+    if (alignment < alignof(Header)) {
+        alignment = alignof(Header);
+    }
+
+    size_t start = (Top + sizeof(Header) + alignment - 1) & ~(alignment - 1);
+    if (start + size > Capacity) {
+        EM_ERROR("%s stack full: %zu of %zu bytes used, %zu requested", Name, Top, Capacity, size);
+        return nullptr;
+    }
+
+    size_t headerOffset = start - sizeof(Header);
+    Header* header = (Header*)(Base + headerOffset);
+    header->Previous = LastHeader;
+    header->Size = (u32)size;
+    header->Tag = tag;
+
+    LastHeader = headerOffset;
+    Top = start + size;
+    if (Top > HighWater) {
+        HighWater = Top;
+    }
+    Memory::Track(tag, size);
+
+    return Base + start;
+}
+
+// Every header past the marker belongs to an allocation made after it.
+void StackAllocator::FreeToMarker(StackMarker marker) {
+    while (LastHeader != STACK_NO_HEADER && LastHeader >= marker) {
+        const Header* header = (const Header*)(Base + LastHeader);
+        Memory::Untrack((MemoryTag)header->Tag, header->Size);
+        LastHeader = header->Previous;
+    }
+
+    if (marker < Top) {
+        Top = marker;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Memory.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+typedef size_t StackMarker;
+
+const size_t STACK_NO_HEADER = ~(size_t)0;
+
+// Arena that can be rewound to any earlier marker, for scratch memory with
+// nested lifetimes. Each allocation carries a small header so rewinding can
+// release its bytes from the right tag. Not thread safe; give each thread its
+// own stack.
+class StackAllocator {
+public:
+    bool Initialize(size_t capacity, const char* name);
+    void Shutdown();
+
+    // nullptr when the stack is full.
+    void* Allocate(size_t size, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT);
+    template <typename T>
+    T* AllocateArray(u32 count, MemoryTag tag) { return (T*)Allocate(sizeof(T) * count, tag, alignof(T)); }
+
+    StackMarker GetMarker() const { return Top; }
+    // Frees everything allocated after the marker was taken.
+    void FreeToMarker(StackMarker marker);
+
+    size_t GetUsed() const { return Top; }
+    size_t GetCapacity() const { return Capacity; }
+    size_t GetHighWater() const { return HighWater; }
+
+private:
+    struct Header {
+        size_t Previous;   // offset of the previous header, or STACK_NO_HEADER
+        u32 Size;
+        u32 Tag;
+    };
+
+    u8* Base = nullptr;
+    size_t Capacity = 0;
+    const char* Name = "";
+    size_t Top = 0;
+    size_t LastHeader = STACK_NO_HEADER;
+    size_t HighWater = 0;
+};
+
+// Frees the scope's allocations from the stack when it ends.
+//
+//     ScopedStack scratch(stack);
+//     u32* indices = scratch.AllocateArray<u32>(count, MEMORY_TAG_SCENE);
+class ScopedStack {
+public:
+    explicit ScopedStack(StackAllocator& stack) : Stack(stack), Marker(stack.GetMarker()) {}
+    ~ScopedStack() { Stack.FreeToMarker(Marker); }
+
+    ScopedStack(const ScopedStack&) = delete;
+    ScopedStack& operator=(const ScopedStack&) = delete;
+
+    void* Allocate(size_t size, MemoryTag tag, size_t alignment = DEFAULT_MEMORY_ALIGNMENT) { return Stack.Allocate(size, tag, alignment); }
+    template <typename T>
+    T* AllocateArray(u32 count, MemoryTag tag) { return Stack.AllocateArray<T>(count, tag); }
+
+private:
+    StackAllocator& Stack;
+    StackMarker Marker;
+};
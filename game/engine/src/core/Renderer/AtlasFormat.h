@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+// On-disk layout of a packed sprite atlas, shared by tools/AtlasPacker and
+// SpriteAtlas. All values are little endian.
+//
+//     AtlasFileHeader
+//     PageCount pages of PageSize * PageSize RGBA8 texels
+//     TableSize AtlasFileEntry slots, an open addressing hash table keyed
+//     by HashSpriteName and probed linearly; empty slots have NameHash 0.
+
+const u32 ATLAS_MAGIC = 0x4c544153;  // "SATL"
+const u32 ATLAS_VERSION = 1;
+
+struct AtlasFileHeader {
+    u32 Magic;
+    u32 Version;
+    u32 PageCount;
+    u32 PageSize;
+    u32 EntryCount;
+    u32 TableSize;  // power of two
+};
+
+struct AtlasFileEntry {
+    u64 NameHash;
+    u16 Page;
+    u16 X;             // trimmed rect on the page, in texels
+    u16 Y;
+    u16 Width;
+    u16 Height;
+    u16 TrimX;         // trimmed rect inside the source image
+    u16 TrimY;
+    u16 SourceWidth;
+    u16 SourceHeight;
+    u16 Reserved[3];
+};
+
+STATIC_ASSERT(sizeof(AtlasFileHeader) == 24, "Expected AtlasFileHeader to be 24 bytes.");
+STATIC_ASSERT(sizeof(AtlasFileEntry) == 32, "Expected AtlasFileEntry to be 32 bytes.");
+
+// FNV-1a; names are paths relative to the packed folder without the
+// extension, using forward slashes (e.g. "ui/icon"). 0 marks an empty slot.
+inline u64 HashSpriteName(const char* name) {
+    u64 hash = 14695981039346656037ull;
+    while (*name) {
+        hash ^= (u8)*name++;
+        hash *= 1099511628211ull;
+    }
+    return hash == 0 ? 1 : hash;
+}
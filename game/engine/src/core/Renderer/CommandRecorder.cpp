@@ -0,0 +1,191 @@
+#include "CommandRecorder.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+bool CommandRecorder::Initialize(VkDevice device, u32 queueFamily, u32 framesInFlight, u32 threadCount, JobSystem* jobs) {
+    Device = device;
+    Jobs = jobs;
+    ThreadCount = std::max(1u, std::min(threadCount, MAX_RECORD_THREADS));
+    Generation = 0;
+    Pending = 0;
+    Quit = false;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    for (u32 t = 0; t < ThreadCount; t++) {
+        RecordThread& thread = Threads[t];
+        thread.CommandPools.resize(framesInFlight);
+        thread.CommandBuffers.resize(framesInFlight);
+
+        for (u32 frame = 0; frame < framesInFlight; frame++) {
+            if (vkCreateCommandPool(Device, &poolInfo, nullptr, &thread.CommandPools[frame]) != VK_SUCCESS) {
+                EM_FATAL("Could not create record thread command pool");
+                return false;
+            }
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = thread.CommandPools[frame];
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(Device, &allocInfo, &thread.CommandBuffers[frame]) != VK_SUCCESS) {
+                EM_FATAL("Could not allocate secondary command buffer");
+                return false;
+            }
+        }
+    }
+
+    // Thread 0 is the caller of Record.
+    if (Jobs == nullptr) {
+        for (u32 t = 1; t < ThreadCount; t++) {
+            Workers.emplace_back(&CommandRecorder::WorkerLoop, this, t);
+        }
+    }
+
+    EM_INFO("Command recorder initialized with %u %s", ThreadCount, Jobs != nullptr ? "job partitions" : "threads");
+
+    return true;
+}
+
+void CommandRecorder::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Quit = true;
+    }
+    WorkReady.notify_all();
+
+    for (std::thread& worker : Workers) {
+        worker.join();
+    }
+    Workers.clear();
+
+    for (u32 t = 0; t < ThreadCount; t++) {
+        for (VkCommandPool pool : Threads[t].CommandPools) {
+            vkDestroyCommandPool(Device, pool, nullptr);
+        }
+        Threads[t].CommandPools.clear();
+        Threads[t].CommandBuffers.clear();
+    }
+
+    ThreadCount = 0;
+}
+
+u32 CommandRecorder::Record(u32 frame, const VkCommandBufferInheritanceInfo& inheritance, u32 itemCount, u32 minItemsPerThread, const RecordFunction& function, VkCommandBuffer* outBuffers) {
+    if (itemCount == 0) {
+        return 0;
+    }
+
+    // Don't wake threads for partitions too small to pay for the handoff.
+    u32 partitionCount = std::max(1u, std::min(ThreadCount, itemCount / std::max(1u, minItemsPerThread)));
+
+    for (u32 t = 0; t < partitionCount; t++) {
+        vkResetCommandPool(Device, Threads[t].CommandPools[frame], 0);
+        outBuffers[t] = Threads[t].CommandBuffers[frame];
+    }
+
+    JobFrame = frame;
+    JobItemCount = itemCount;
+    JobPartitionCount = partitionCount;
+    JobInheritance = &inheritance;
+    JobFunction = &function;
+
+    if (Jobs != nullptr) {
+        JobCounter counter;
+        for (u32 t = 1; t < partitionCount; t++) {
+            Jobs->Run(&CommandRecorder::RecordPartitionJob, this, &counter, t);
+        }
+
+        RecordPartition(0);
+        Jobs->Wait(counter);
+
+        return partitionCount;
+    }
+
+    if (partitionCount > 1) {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Pending = partitionCount - 1;
+            Generation++;
+        }
+        WorkReady.notify_all();
+    }
+
+    RecordPartition(0);
+
+    if (partitionCount > 1) {
+        std::unique_lock<std::mutex> lock(Mutex);
+        WorkDone.wait(lock, [this] { return Pending == 0; });
+    }
+
+    return partitionCount;
+}
+
+void CommandRecorder::RecordPartition(u32 threadIndex) {
+    // Contiguous ranges keep the draw order when the buffers are executed in sequence.
+    u32 base = JobItemCount / JobPartitionCount;
+    u32 remainder = JobItemCount % JobPartitionCount;
+    u32 first = threadIndex * base + std::min(threadIndex, remainder);
+    u32 count = base + (threadIndex < remainder ? 1 : 0);
+
+    VkCommandBuffer commandBuffer = Threads[threadIndex].CommandBuffers[JobFrame];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = JobInheritance;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        EM_ERROR("Could not begin secondary command buffer");
+        return;
+    }
+
+    (*JobFunction)(commandBuffer, first, count);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        EM_ERROR("Could not record secondary command buffer");
+    }
+}
+
+void CommandRecorder::RecordPartitionJob(void* data, u32 first, u32 count) {
+    ((CommandRecorder*)data)->RecordPartition(first);
+}
+
+void CommandRecorder::WorkerLoop(u32 threadIndex) {
+    u64 seenGeneration = 0;
+
+    while (true) {
+        u32 partitionCount;
+        {
+            std::unique_lock<std::mutex> lock(Mutex);
+            WorkReady.wait(lock, [this, seenGeneration] { return Quit || Generation != seenGeneration; });
+
+            if (Quit) {
+                return;
+            }
+
+            seenGeneration = Generation;
+            partitionCount = JobPartitionCount;
+        }
+
+        if (threadIndex >= partitionCount) {
+            continue;
+        }
+
+        RecordPartition(threadIndex);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            last = --Pending == 0;
+        }
+
+        if (last) {
+            WorkDone.notify_one();
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/Jobs/JobSystem.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const u32 MAX_RECORD_THREADS = 16;
+
+// Records a draw list into secondary command buffers on several threads.
+// Each thread owns one command pool per frame in flight, so pools are only
+// ever touched by one thread and are reset as a whole once the frame's
+// fence has signalled. The calling thread records the first partition.
+//
+// Given a job system, partitions run as jobs on its workers instead of on
+// the recorder's own threads; each partition still has its own pools.
+class CommandRecorder {
+public:
+    typedef std::function<void(VkCommandBuffer commandBuffer, u32 first, u32 count)> RecordFunction;
+
+    bool Initialize(VkDevice device, u32 queueFamily, u32 framesInFlight, u32 threadCount, JobSystem* jobs = nullptr);
+    void Shutdown();
+
+    // Splits [0, itemCount) into contiguous partitions, one per thread, and
+    // records each into a secondary command buffer. Buffers are written to
+    // outBuffers in draw order; returns how many were recorded.
+    u32 Record(u32 frame, const VkCommandBufferInheritanceInfo& inheritance, u32 itemCount, u32 minItemsPerThread, const RecordFunction& function, VkCommandBuffer* outBuffers);
+
+    u32 GetThreadCount() const { return ThreadCount; }
+
+private:
+    struct RecordThread {
+        std::vector<VkCommandPool> CommandPools;
+        std::vector<VkCommandBuffer> CommandBuffers;
+    };
+
+    void WorkerLoop(u32 threadIndex);
+    void RecordPartition(u32 threadIndex);
+    static void RecordPartitionJob(void* data, u32 first, u32 count);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    u32 ThreadCount = 0;
+    RecordThread Threads[MAX_RECORD_THREADS];
+    std::vector<std::thread> Workers;
+    JobSystem* Jobs = nullptr;
+
+    std::mutex Mutex;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    u64 Generation = 0;
+    u32 Pending = 0;
+    bool Quit = false;
+
+    // Current job, only written while no partition is being recorded.
+    u32 JobFrame = 0;
+    u32 JobItemCount = 0;
+    u32 JobPartitionCount = 0;
+    const VkCommandBufferInheritanceInfo* JobInheritance = nullptr;
+    const RecordFunction* JobFunction = nullptr;
+};
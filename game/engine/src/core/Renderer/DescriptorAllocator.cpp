@@ -0,0 +1,263 @@
+#include "DescriptorAllocator.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <cstring>
+
+// Descriptors per set each pool is sized for, by type.
+struct DescriptorPoolRatio {
+    VkDescriptorType Type;
+    f32 PerSet;
+};
+
+static const DescriptorPoolRatio POOL_RATIOS[] = {
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f},
+    {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+    {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+    {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+};
+
+bool DescriptorAllocator::Initialize(VkDevice device, u32 framesInFlight) {
+    Device = device;
+    Frames.assign(framesInFlight, FramePools{});
+    CurrentFrame = 0;
+
+    return true;
+}
+
+void DescriptorAllocator::Shutdown() {
+    for (FramePools& frame : Frames) {
+        for (VkDescriptorPool pool : frame.Pools) {
+            vkDestroyDescriptorPool(Device, pool, nullptr);
+        }
+    }
+    for (VkDescriptorPool pool : FreePools) {
+        vkDestroyDescriptorPool(Device, pool, nullptr);
+    }
+    for (VkDescriptorPool pool : CachePools) {
+        vkDestroyDescriptorPool(Device, pool, nullptr);
+    }
+
+    Frames.clear();
+    FreePools.clear();
+    CachePools.clear();
+    Cache.clear();
+    PoolCount = 0;
+}
+
+void DescriptorAllocator::BeginFrame(u32 frame) {
+    CurrentFrame = frame;
+    CacheHits = 0;
+
+    FramePools& pools = Frames[frame];
+    for (VkDescriptorPool pool : pools.Pools) {
+        vkResetDescriptorPool(Device, pool, 0);
+        FreePools.push_back(pool);
+    }
+    pools.Pools.clear();
+    pools.SetCount = 0;
+}
+
+VkDescriptorPool DescriptorAllocator::GrabPool() {
+    if (!FreePools.empty()) {
+        VkDescriptorPool pool = FreePools.back();
+        FreePools.pop_back();
+        return pool;
+    }
+
+    VkDescriptorPoolSize sizes[sizeof(POOL_RATIOS) / sizeof(POOL_RATIOS[0])];
+    u32 sizeCount = 0;
+    for (const DescriptorPoolRatio& ratio : POOL_RATIOS) {
+        sizes[sizeCount++] = {ratio.Type, (u32)(ratio.PerSet * DESCRIPTOR_SETS_PER_POOL)};
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolInfo.maxSets = DESCRIPTOR_SETS_PER_POOL;
+    poolInfo.poolSizeCount = sizeCount;
+    poolInfo.pPoolSizes = sizes;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if (vkCreateDescriptorPool(Device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        EM_ERROR("Could not create descriptor pool");
+        return VK_NULL_HANDLE;
+    }
+
+    PoolCount++;
+    return pool;
+}
+
+// Tries the chain's current pool and chains a fresh one when it is full.
+VkDescriptorSet DescriptorAllocator::AllocateFrom(std::vector<VkDescriptorPool>& pools, VkDescriptorSetLayout layout) {
+    VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    VkDescriptorSet set = VK_NULL_HANDLE;
+
+    if (!pools.empty()) {
+        allocInfo.descriptorPool = pools.back();
+        VkResult result = vkAllocateDescriptorSets(Device, &allocInfo, &set);
+        if (result == VK_SUCCESS) {
+            return set;
+        }
+        if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) {
+            EM_ERROR("Could not allocate descriptor set");
+            return VK_NULL_HANDLE;
+        }
+    }
+
+    VkDescriptorPool pool = GrabPool();
+    if (pool == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    pools.push_back(pool);
+
+    allocInfo.descriptorPool = pool;
+    if (vkAllocateDescriptorSets(Device, &allocInfo, &set) != VK_SUCCESS) {
+        EM_ERROR("Could not allocate descriptor set from a fresh pool");
+        return VK_NULL_HANDLE;
+    }
+
+    return set;
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout) {
+    FramePools& frame = Frames[CurrentFrame];
+
+    VkDescriptorSet set = AllocateFrom(frame.Pools, layout);
+    if (set != VK_NULL_HANDLE) {
+        frame.SetCount++;
+    }
+
+    return set;
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count) {
+    VkDescriptorSet set = Allocate(layout);
+    if (set != VK_NULL_HANDLE) {
+        Write(set, bindings, count);
+    }
+
+    return set;
+}
+
+// FNV-1a over the layout handle and each binding's fields.
+u64 DescriptorAllocator::Hash(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count) {
+    u64 hash = 14695981039346656037ull;
+
+    auto mix = [&hash](const void* data, size_t size) {
+        const u8* bytes = (const u8*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    mix(&layout, sizeof(layout));
+    for (u32 i = 0; i < count; i++) {
+        const DescriptorBinding& binding = bindings[i];
+        mix(&binding.Binding, sizeof(binding.Binding));
+        mix(&binding.Type, sizeof(binding.Type));
+        mix(&binding.Buffer, sizeof(binding.Buffer));
+        mix(&binding.Offset, sizeof(binding.Offset));
+        mix(&binding.Range, sizeof(binding.Range));
+        mix(&binding.ImageView, sizeof(binding.ImageView));
+        mix(&binding.Sampler, sizeof(binding.Sampler));
+        mix(&binding.ImageLayout, sizeof(binding.ImageLayout));
+    }
+
+    return hash;
+}
+
+bool DescriptorAllocator::Equal(const CachedSet& cached, VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count) {
+    if (cached.Layout != layout || cached.Count != count) {
+        return false;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        const DescriptorBinding& a = cached.Bindings[i];
+        const DescriptorBinding& b = bindings[i];
+        if (a.Binding != b.Binding || a.Type != b.Type || a.Buffer != b.Buffer || a.Offset != b.Offset || a.Range != b.Range ||
+            a.ImageView != b.ImageView || a.Sampler != b.Sampler || a.ImageLayout != b.ImageLayout) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+VkDescriptorSet DescriptorAllocator::GetCached(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count) {
+    if (count > MAX_DESCRIPTOR_BINDINGS) {
+        EM_ERROR("Cached descriptor set has too many bindings (%u)", count);
+        return VK_NULL_HANDLE;
+    }
+
+    u64 hash = Hash(layout, bindings, count);
+    for (auto found = Cache.find(hash); found != Cache.end(); found = Cache.find(++hash)) {
+        if (Equal(found->second, layout, bindings, count)) {
+            CacheHits++;
+            return found->second.Set;
+        }
+    }
+
+    VkDescriptorSet set = AllocateFrom(CachePools, layout);
+    if (set == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+    Write(set, bindings, count);
+
+    CachedSet& cached = Cache[hash];
+    cached.Layout = layout;
+    cached.Count = count;
+    memcpy(cached.Bindings, bindings, count * sizeof(DescriptorBinding));
+    cached.Set = set;
+
+    return set;
+}
+
+void DescriptorAllocator::Write(VkDescriptorSet set, const DescriptorBinding* bindings, u32 count) {
+    VkDescriptorBufferInfo bufferInfos[MAX_DESCRIPTOR_BINDINGS];
+    VkDescriptorImageInfo imageInfos[MAX_DESCRIPTOR_BINDINGS];
+    VkWriteDescriptorSet writes[MAX_DESCRIPTOR_BINDINGS]{};
+
+    if (count > MAX_DESCRIPTOR_BINDINGS) {
+        EM_ERROR("Descriptor write has too many bindings (%u)", count);
+        return;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        const DescriptorBinding& binding = bindings[i];
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = set;
+        writes[i].dstBinding = binding.Binding;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = binding.Type;
+
+        if (binding.Buffer != VK_NULL_HANDLE) {
+            bufferInfos[i] = {binding.Buffer, binding.Offset, binding.Range};
+            writes[i].pBufferInfo = &bufferInfos[i];
+        } else {
+            imageInfos[i] = {binding.Sampler, binding.ImageView, binding.ImageLayout};
+            writes[i].pImageInfo = &imageInfos[i];
+        }
+    }
+
+    vkUpdateDescriptorSets(Device, count, writes, 0, nullptr);
+}
+
+DescriptorAllocatorStats DescriptorAllocator::GetStats() const {
+    DescriptorAllocatorStats stats{};
+    stats.PoolCount = PoolCount;
+    stats.CachedSets = (u32)Cache.size();
+    stats.CacheHits = CacheHits;
+
+    for (const FramePools& frame : Frames) {
+        stats.FramePools += (u32)frame.Pools.size();
+    }
+    if (!Frames.empty()) {
+        stats.FrameSets = Frames[CurrentFrame].SetCount;
+    }
+
+    return stats;
+}
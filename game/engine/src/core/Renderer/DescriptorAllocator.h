@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+#include <unordered_map>
+#include <vector>
+
+const u32 DESCRIPTOR_SETS_PER_POOL = 128;
+const u32 MAX_DESCRIPTOR_BINDINGS = 8;
+
+// One buffer or image descriptor of a set, by binding number.
+struct DescriptorBinding {
+    u32 Binding;
+    VkDescriptorType Type;
+    VkBuffer Buffer;
+    VkDeviceSize Offset;
+    VkDeviceSize Range;
+    VkImageView ImageView;
+    VkSampler Sampler;
+    VkImageLayout ImageLayout;
+};
+
+struct DescriptorAllocatorStats {
+    u32 PoolCount;          // created, in use or free
+    u32 FramePools;         // held by frames in flight
+    u32 FrameSets;          // allocated for the current frame
+    u32 CachedSets;
+    u32 CacheHits;          // this frame
+};
+
+// Descriptor sets without per-set allocation or free calls.
+//
+// Transient sets come from pools owned by a frame slot. When a slot's pool
+// fills up another is chained on, and once the slot's fence has signalled
+// BeginFrame resets all of its pools with one vkResetDescriptorPool each
+// and hands them back for reuse.
+//
+// Sets whose contents never change are cached by a hash of their layout
+// and bindings; asking again for the same contents returns the same set.
+// Cached sets live in their own pools until Shutdown.
+class DescriptorAllocator {
+public:
+    bool Initialize(VkDevice device, u32 framesInFlight);
+    void Shutdown();
+
+    // Call after waiting for the frame slot's fence.
+    void BeginFrame(u32 frame);
+
+    // Valid until this frame slot is begun again.
+    VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+    VkDescriptorSet Allocate(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count);
+
+    // The bound resources must outlive the allocator or never be destroyed
+    // while a set referencing them may still be requested.
+    VkDescriptorSet GetCached(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count);
+
+    void Write(VkDescriptorSet set, const DescriptorBinding* bindings, u32 count);
+
+    DescriptorAllocatorStats GetStats() const;
+
+private:
+    struct CachedSet {
+        VkDescriptorSetLayout Layout;
+        u32 Count;
+        DescriptorBinding Bindings[MAX_DESCRIPTOR_BINDINGS];
+        VkDescriptorSet Set;
+    };
+
+    struct FramePools {
+        std::vector<VkDescriptorPool> Pools;   // the last one is allocated from
+        u32 SetCount;
+    };
+
+    VkDescriptorPool GrabPool();
+    VkDescriptorSet AllocateFrom(std::vector<VkDescriptorPool>& pools, VkDescriptorSetLayout layout);
+
+    static u64 Hash(VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count);
+    static bool Equal(const CachedSet& cached, VkDescriptorSetLayout layout, const DescriptorBinding* bindings, u32 count);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    std::vector<FramePools> Frames;
+    u32 CurrentFrame = 0;
+    std::vector<VkDescriptorPool> FreePools;
+    std::vector<VkDescriptorPool> CachePools;
+    std::unordered_map<u64, CachedSet> Cache;
+    u32 PoolCount = 0;
+    u32 CacheHits = 0;
+};
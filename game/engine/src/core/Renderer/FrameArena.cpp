@@ -0,0 +1,56 @@
+#include "FrameArena.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+bool FrameArena::Initialize(VkBuffer buffer, void* mapped, VkDeviceSize frameSize, u32 framesInFlight, const VkPhysicalDeviceLimits& limits) {
+    if (buffer == VK_NULL_HANDLE || mapped == nullptr) {
+        EM_ERROR("Frame arena needs a mapped buffer");
+        return false;
+    }
+
+    Buffer = buffer;
+    Mapped = (u8*)mapped;
+    FrameSize = frameSize;
+    FrameCount = framesInFlight;
+    UniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+    StorageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+
+    BeginFrame(0);
+    HighWater = 0;
+
+    return true;
+}
+
+void FrameArena::Shutdown() {
+    Buffer = VK_NULL_HANDLE;
+    Mapped = nullptr;
+    FrameSize = 0;
+    FrameCount = 0;
+}
+
+void FrameArena::BeginFrame(u32 frame) {
+    FrameStart = frame * FrameSize;
+    FrameEnd = FrameStart + FrameSize;
+    Head = FrameStart;
+    OverflowReported = false;
+}
+
+FrameAllocation FrameArena::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    // Alignments are powers of two per the Vulkan limits.
+    VkDeviceSize offset = (Head + alignment - 1) & ~(alignment - 1);
+
+    if (offset + size > FrameEnd) {
+        if (!OverflowReported) {
+            EM_WARN("Frame arena overflow: %llu bytes requested, %llu of %llu used", (unsigned long long)size,
+                    (unsigned long long)(Head - FrameStart), (unsigned long long)FrameSize);
+            OverflowReported = true;
+        }
+        return {Buffer, 0, nullptr};
+    }
+
+    Head = offset + size;
+    HighWater = std::max(HighWater, Head - FrameStart);
+
+    return {Buffer, offset, Mapped + offset};
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+#include <vector>
+
+const VkDeviceSize FRAME_ARENA_SIZE = 8 * 1024 * 1024;   // per frame in flight
+
+// A sub-range of the arena's buffer, valid for the frame it was allocated in.
+struct FrameAllocation {
+    VkBuffer Buffer;
+    VkDeviceSize Offset;
+    void* Mapped;   // nullptr when the frame's region is full
+};
+
+// Linear allocator for per-frame CPU-to-GPU data (dynamic vertices,
+// indices, uniforms, instance data) over one persistently mapped,
+// host-coherent buffer split into a region per frame in flight. Allocating
+// is a pointer bump with no Vulkan calls; BeginFrame rewinds the region
+// once the frame's fence has signalled. The arena does not own the buffer.
+class FrameArena {
+public:
+    bool Initialize(VkBuffer buffer, void* mapped, VkDeviceSize frameSize, u32 framesInFlight, const VkPhysicalDeviceLimits& limits);
+    void Shutdown();
+
+    void BeginFrame(u32 frame);
+
+    FrameAllocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+    FrameAllocation AllocateUniform(VkDeviceSize size) { return Allocate(size, UniformAlignment); }
+    FrameAllocation AllocateStorage(VkDeviceSize size) { return Allocate(size, StorageAlignment); }
+
+    VkDeviceSize GetFrameUsed() const { return Head - FrameStart; }
+    VkDeviceSize GetHighWater() const { return HighWater; }
+
+private:
+    VkBuffer Buffer = VK_NULL_HANDLE;
+    u8* Mapped = nullptr;
+    VkDeviceSize FrameSize = 0;
+    u32 FrameCount = 0;
+    VkDeviceSize UniformAlignment = 256;
+    VkDeviceSize StorageAlignment = 256;
+
+    VkDeviceSize FrameStart = 0;
+    VkDeviceSize FrameEnd = 0;
+    VkDeviceSize Head = 0;
+    VkDeviceSize HighWater = 0;
+    bool OverflowReported = false;
+};
@@ -0,0 +1,62 @@
+#include "FramePacer.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Weight of each new sample; older ones fade over a few hundred samples so
+// the estimate follows changes in system load.
+const f64 SLEEP_SAMPLE_WEIGHT = 0.01;
+
+void FramePacer::SetTargetFrameRate(f64 framesPerSecond) {
+    TargetFrameRate = std::max(framesPerSecond, 0.0);
+    FrameSeconds = TargetFrameRate > 0.0 ? 1.0 / TargetFrameRate : 0.0;
+    Started = false;
+}
+
+// Exponentially weighted mean and variance, so both stay bounded however
+// long the pacer runs.
+void FramePacer::AddSleepSample(f64 seconds) {
+    f64 delta = seconds - SleepMean;
+    SleepMean += SLEEP_SAMPLE_WEIGHT * delta;
+    SleepVariance = (1.0 - SLEEP_SAMPLE_WEIGHT) * (SleepVariance + SLEEP_SAMPLE_WEIGHT * delta * delta);
+
+    SleepEstimate = SleepMean + std::sqrt(SleepVariance);
+}
+
+f64 FramePacer::Wait() {
+    if (FrameSeconds <= 0.0) {
+        return 0.0;
+    }
+
+    Clock::time_point start = Clock::now();
+
+    if (!Started) {
+        NextFrame = start;
+        Started = true;
+    }
+
+    Clock::time_point now = start;
+    while (std::chrono::duration<f64>(NextFrame - now).count() > SleepEstimate) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        Clock::time_point woke = Clock::now();
+        AddSleepSample(std::chrono::duration<f64>(woke - now).count());
+        now = woke;
+    }
+
+    // Less left than a sleep might take: give the core away until due.
+    while (now < NextFrame) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+
+    // Keep the cadence, but don't try to catch up on frames that ran long.
+    NextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(FrameSeconds));
+    if (NextFrame < now) {
+        NextFrame = now;
+    }
+
+    return std::chrono::duration<f64, std::milli>(now - start).count();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <chrono>
+
+// CPU-side frame limiter. Sleeps in short slices until the remaining time is
+// less than what a sleep has been observed to overshoot by, then yields for
+// the rest, so it neither busy-waits a whole core nor wakes up late when the
+// OS scheduler is coarse.
+class FramePacer {
+public:
+    // 0 disables the limiter.
+    void SetTargetFrameRate(f64 framesPerSecond);
+    f64 GetTargetFrameRate() const { return TargetFrameRate; }
+
+    // Blocks until the next frame is due and returns how long it waited in ms.
+    f64 Wait();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void AddSleepSample(f64 seconds);
+
+    f64 TargetFrameRate = 0.0;
+    f64 FrameSeconds = 0.0;
+    Clock::time_point NextFrame;
+    bool Started = false;
+
+    // Recent mean and variance of how long a 1 ms sleep really takes.
+    f64 SleepEstimate = 0.005;
+    f64 SleepMean = 0.005;
+    f64 SleepVariance = 0.0;
+};
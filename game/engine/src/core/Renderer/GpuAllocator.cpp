@@ -0,0 +1,280 @@
+#include "GpuAllocator.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+const VkDeviceSize FREE_LIST_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool GpuAllocator::Initialize(VkPhysicalDevice physicalDevice, VkDevice device) {
+    Device = device;
+
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &MemoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    BufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+
+    EM_INFO("GPU allocator initialized (%u memory types)", MemoryProperties.memoryTypeCount);
+
+    return true;
+}
+
+void GpuAllocator::Shutdown() {
+    LogStats();
+
+    for (MemoryBlock& block : Blocks) {
+        DestroyBlock(block);
+    }
+
+    Blocks.clear();
+}
+
+VkDeviceSize GpuAllocator::GetBlockSize(u32 memoryType) const {
+    // Small heaps (e.g. the 256MB host-visible device-local heap) get smaller blocks.
+    u32 heapIndex = MemoryProperties.memoryTypes[memoryType].heapIndex;
+    VkDeviceSize heapSize = MemoryProperties.memoryHeaps[heapIndex].size;
+
+    return std::min(FREE_LIST_BLOCK_SIZE, heapSize / 8);
+}
+
+u32 GpuAllocator::CreateBlock(u32 memoryType, VkDeviceSize size, bool dedicated) {
+    VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(Device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        EM_ERROR("GPU allocator could not allocate a %llu byte block", (u64)size);
+        return UINT32_MAX;
+    }
+
+    void* mapped = nullptr;
+    if (MemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        vkMapMemory(Device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    }
+
+    // Reuse the slot of a released dedicated block so indices stay stable.
+    u32 index = (u32)Blocks.size();
+    for (u32 i = 0; i < Blocks.size(); i++) {
+        if (Blocks[i].Memory == VK_NULL_HANDLE) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index == Blocks.size()) {
+        Blocks.emplace_back();
+    }
+
+    MemoryBlock& block = Blocks[index];
+    block.Memory = memory;
+    block.Size = size;
+    block.Mapped = mapped;
+    block.MemoryType = memoryType;
+    block.Dedicated = dedicated;
+    block.AllocationCount = 0;
+    block.BytesInUse = 0;
+    block.FreeByOffset.clear();
+    block.FreeBySize.clear();
+    block.FreeByOffset[0] = size;
+    block.FreeBySize.insert({size, 0});
+
+    return index;
+}
+
+void GpuAllocator::DestroyBlock(MemoryBlock& block) {
+    if (block.Memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (block.Mapped) {
+        vkUnmapMemory(Device, block.Memory);
+    }
+
+    vkFreeMemory(Device, block.Memory, nullptr);
+    block.Memory = VK_NULL_HANDLE;
+    block.Mapped = nullptr;
+    block.FreeByOffset.clear();
+    block.FreeBySize.clear();
+}
+
+bool GpuAllocator::Allocate(const VkMemoryRequirements& requirements, u32 memoryType, GpuAllocation& allocation) {
+    // Blocks mix buffers and optimal images, so keep every allocation on its
+    // own granularity page.
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+    alignment = std::max(alignment, BufferImageGranularity);
+
+    VkDeviceSize size = AlignUp(requirements.size, alignment);
+    VkDeviceSize blockSize = GetBlockSize(memoryType);
+
+    u32 blockIndex = UINT32_MAX;
+    VkDeviceSize offset = 0;
+
+    if (size > blockSize / 2) {
+        blockIndex = CreateBlock(memoryType, size, true);
+        if (blockIndex == UINT32_MAX || !AllocateFreeList(Blocks[blockIndex], size, alignment, offset)) {
+            return false;
+        }
+    } else {
+        for (u32 i = 0; i < Blocks.size(); i++) {
+            MemoryBlock& block = Blocks[i];
+            if (block.Memory == VK_NULL_HANDLE || block.Dedicated || block.MemoryType != memoryType) {
+                continue;
+            }
+
+            if (AllocateFreeList(block, size, alignment, offset)) {
+                blockIndex = i;
+                break;
+            }
+        }
+
+        if (blockIndex == UINT32_MAX) {
+            blockIndex = CreateBlock(memoryType, blockSize, false);
+            if (blockIndex == UINT32_MAX || !AllocateFreeList(Blocks[blockIndex], size, alignment, offset)) {
+                return false;
+            }
+        }
+    }
+
+    MemoryBlock& block = Blocks[blockIndex];
+    block.AllocationCount++;
+    block.BytesInUse += size;
+
+    allocation.Memory = block.Memory;
+    allocation.Offset = offset;
+    allocation.Size = size;
+    allocation.Mapped = block.Mapped ? (u8*)block.Mapped + offset : nullptr;
+    allocation.Block = blockIndex;
+
+    return true;
+}
+
+void GpuAllocator::Free(GpuAllocation& allocation) {
+    if (allocation.Memory == VK_NULL_HANDLE || allocation.Block >= Blocks.size()) {
+        return;
+    }
+
+    MemoryBlock& block = Blocks[allocation.Block];
+    FreeFreeList(block, allocation.Offset, allocation.Size);
+
+    block.AllocationCount--;
+    block.BytesInUse -= allocation.Size;
+
+    if (block.Dedicated && block.AllocationCount == 0) {
+        DestroyBlock(block);
+    }
+
+    allocation = {};
+}
+
+bool GpuAllocator::AllocateFreeList(MemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+    // Best fit: smallest free range that still holds the request once aligned.
+    for (auto it = block.FreeBySize.lower_bound(size); it != block.FreeBySize.end(); ++it) {
+        VkDeviceSize rangeOffset = it->second;
+        VkDeviceSize rangeSize = it->first;
+        VkDeviceSize alignedOffset = AlignUp(rangeOffset, alignment);
+        VkDeviceSize padding = alignedOffset - rangeOffset;
+
+        if (padding + size > rangeSize) {
+            continue;
+        }
+
+        block.FreeBySize.erase(it);
+        block.FreeByOffset.erase(rangeOffset);
+
+        if (padding > 0) {
+            block.FreeByOffset[rangeOffset] = padding;
+            block.FreeBySize.insert({padding, rangeOffset});
+        }
+
+        VkDeviceSize remaining = rangeSize - padding - size;
+        if (remaining > 0) {
+            block.FreeByOffset[alignedOffset + size] = remaining;
+            block.FreeBySize.insert({remaining, alignedOffset + size});
+        }
+
+        offset = alignedOffset;
+        return true;
+    }
+
+    return false;
+}
+
+void GpuAllocator::FreeFreeList(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size) {
+    auto eraseBySize = [&block](VkDeviceSize rangeOffset, VkDeviceSize rangeSize) {
+        auto range = block.FreeBySize.equal_range(rangeSize);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == rangeOffset) {
+                block.FreeBySize.erase(it);
+                return;
+            }
+        }
+    };
+
+    // Coalesce with the following range.
+    auto next = block.FreeByOffset.find(offset + size);
+    if (next != block.FreeByOffset.end()) {
+        size += next->second;
+        eraseBySize(next->first, next->second);
+        block.FreeByOffset.erase(next);
+    }
+
+    // Coalesce with the preceding range.
+    auto previous = block.FreeByOffset.lower_bound(offset);
+    if (previous != block.FreeByOffset.begin()) {
+        --previous;
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            eraseBySize(previous->first, previous->second);
+            block.FreeByOffset.erase(previous);
+        }
+    }
+
+    block.FreeByOffset[offset] = size;
+    block.FreeBySize.insert({size, offset});
+}
+
+GpuAllocatorStats GpuAllocator::GetStats() const {
+    GpuAllocatorStats stats{};
+    VkDeviceSize largestRangesPerBlock = 0;
+
+    for (const MemoryBlock& block : Blocks) {
+        if (block.Memory == VK_NULL_HANDLE) {
+            continue;
+        }
+
+        stats.BlockCount++;
+        stats.AllocationCount += block.AllocationCount;
+        stats.BytesReserved += block.Size;
+        stats.BytesInUse += block.BytesInUse;
+
+        VkDeviceSize largestRange = 0;
+        for (const auto& range : block.FreeByOffset) {
+            stats.BytesFree += range.second;
+            largestRange = std::max(largestRange, range.second);
+        }
+
+        largestRangesPerBlock += largestRange;
+        stats.LargestFreeRange = std::max(stats.LargestFreeRange, largestRange);
+    }
+
+    if (stats.BytesFree > 0) {
+        stats.Fragmentation = 1.0f - (f32)((f64)largestRangesPerBlock / (f64)stats.BytesFree);
+    }
+
+    return stats;
+}
+
+void GpuAllocator::LogStats() const {
+    GpuAllocatorStats stats = GetStats();
+
+    EM_INFO("GPU memory: %u blocks, %u allocations, %.2f MB in use of %.2f MB reserved, fragmentation %.2f",
+            stats.BlockCount, stats.AllocationCount,
+            (f64)stats.BytesInUse / (1024.0 * 1024.0), (f64)stats.BytesReserved / (1024.0 * 1024.0),
+            stats.Fragmentation);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+#include <map>
+#include <vector>
+
+struct GpuAllocation
+{
+    VkDeviceMemory Memory;
+    VkDeviceSize Offset;
+    VkDeviceSize Size;
+    void* Mapped;
+    u32 Block;
+};
+
+struct GpuAllocatorStats
+{
+    u32 BlockCount;
+    u32 AllocationCount;
+    VkDeviceSize BytesReserved;
+    VkDeviceSize BytesInUse;
+    VkDeviceSize BytesFree;
+    VkDeviceSize LargestFreeRange;
+    // 0 when each block's free space is one range, approaching 1 as it splinters.
+    f32 Fragmentation;
+};
+
+class GpuAllocator
+{
+public:
+    bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device);
+    void Shutdown();
+
+    bool Allocate(const VkMemoryRequirements& requirements, u32 memoryType, GpuAllocation& allocation);
+    void Free(GpuAllocation& allocation);
+
+    GpuAllocatorStats GetStats() const;
+    void LogStats() const;
+
+private:
+    struct MemoryBlock
+    {
+        VkDeviceMemory Memory;
+        VkDeviceSize Size;
+        void* Mapped;
+        u32 MemoryType;
+        bool Dedicated;
+        u32 AllocationCount;
+        VkDeviceSize BytesInUse;
+
+        // Free list: offset -> size, plus size -> offset for best-fit lookups.
+        std::map<VkDeviceSize, VkDeviceSize> FreeByOffset;
+        std::multimap<VkDeviceSize, VkDeviceSize> FreeBySize;
+    };
+
+    u32 CreateBlock(u32 memoryType, VkDeviceSize size, bool dedicated);
+    void DestroyBlock(MemoryBlock& block);
+    bool AllocateFreeList(MemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    void FreeFreeList(MemoryBlock& block, VkDeviceSize offset, VkDeviceSize size);
+    VkDeviceSize GetBlockSize(u32 memoryType) const;
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties MemoryProperties;
+    VkDeviceSize BufferImageGranularity = 1;
+    std::vector<MemoryBlock> Blocks;
+};
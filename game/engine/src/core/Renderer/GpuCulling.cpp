@@ -0,0 +1,180 @@
+#include "GpuCulling.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+
+const u32 CULL_GROUP_SIZE = 64;
+
+bool GpuCulling::Initialize(VkDevice device, VkPipelineCache cache, VkShaderModule shader, u32 framesInFlight) {
+    Device = device;
+
+    // Objects, draw commands, draw count.
+    VkDescriptorSetLayoutBinding bindings[3]{};
+    for (u32 i = 0; i < 3; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    layoutInfo.bindingCount = 3;
+    layoutInfo.pBindings = bindings;
+
+    if (vkCreateDescriptorSetLayout(Device, &layoutInfo, nullptr, &SetLayout) != VK_SUCCESS) {
+        EM_ERROR("Could not create cull descriptor set layout");
+        return false;
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = 3 * framesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = framesInFlight;
+
+    if (vkCreateDescriptorPool(Device, &poolInfo, nullptr, &Pool) != VK_SUCCESS) {
+        EM_ERROR("Could not create cull descriptor pool");
+        return false;
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, SetLayout);
+    VkDescriptorSetAllocateInfo allocInfo{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    allocInfo.descriptorPool = Pool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts = layouts.data();
+
+    Sets.resize(framesInFlight);
+    CountBuffers.assign(framesInFlight, VK_NULL_HANDLE);
+    if (vkAllocateDescriptorSets(Device, &allocInfo, Sets.data()) != VK_SUCCESS) {
+        EM_ERROR("Could not allocate cull descriptor sets");
+        return false;
+    }
+
+    VkPushConstantRange pushConstants{};
+    pushConstants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstants.offset = 0;
+    pushConstants.size = sizeof(CullConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &SetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstants;
+
+    if (vkCreatePipelineLayout(Device, &pipelineLayoutInfo, nullptr, &Layout) != VK_SUCCESS) {
+        EM_ERROR("Could not create cull pipeline layout");
+        return false;
+    }
+
+    VkComputePipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shader;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = Layout;
+
+    if (vkCreateComputePipelines(Device, cache, 1, &pipelineInfo, nullptr, &Pipeline) != VK_SUCCESS) {
+        EM_ERROR("Could not create cull pipeline");
+        return false;
+    }
+
+    return true;
+}
+
+void GpuCulling::Shutdown() {
+    if (Device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    vkDestroyPipeline(Device, Pipeline, nullptr);
+    vkDestroyPipelineLayout(Device, Layout, nullptr);
+    vkDestroyDescriptorPool(Device, Pool, nullptr);
+    vkDestroyDescriptorSetLayout(Device, SetLayout, nullptr);
+
+    Sets.clear();
+    CountBuffers.clear();
+    Device = VK_NULL_HANDLE;
+}
+
+void GpuCulling::SetBuffers(u32 frame, VkBuffer objects, VkBuffer drawCommands, VkBuffer drawCount) {
+    VkDescriptorBufferInfo bufferInfos[3]{};
+    bufferInfos[0] = {objects, 0, VK_WHOLE_SIZE};
+    bufferInfos[1] = {drawCommands, 0, VK_WHOLE_SIZE};
+    bufferInfos[2] = {drawCount, 0, VK_WHOLE_SIZE};
+
+    VkWriteDescriptorSet writes[3]{};
+    for (u32 i = 0; i < 3; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = Sets[frame];
+        writes[i].dstBinding = i;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].descriptorCount = 1;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(Device, 3, writes, 0, nullptr);
+    CountBuffers[frame] = drawCount;
+}
+
+void GpuCulling::Record(VkCommandBuffer commandBuffer, u32 frame, const CullConstants& constants) {
+    vkCmdFillBuffer(commandBuffer, CountBuffers[frame], 0, sizeof(u32), 0);
+
+    VkMemoryBarrier barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Layout, 0, 1, &Sets[frame], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, Layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &constants);
+    vkCmdDispatch(commandBuffer, (constants.ObjectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+}
+
+// Gribb/Hartmann: each plane is the last row of the matrix plus or minus
+// another row. Near is row 2 alone because Vulkan clips z to [0, w].
+void GpuCulling::ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+    glm::vec4 rows[4];
+    for (u32 i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    }
+
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[2];
+    planes[5] = rows[3] - rows[2];
+
+    for (u32 i = 0; i < 6; i++) {
+        f32 length = glm::length(glm::vec3(planes[i]));
+        if (length > 0.0f) {
+            planes[i] /= length;
+        }
+    }
+}
+
+bool GpuCulling::IsVisible(const glm::vec4 planes[6], const glm::vec4& bounds) {
+    for (u32 i = 0; i < 6; i++) {
+        if (glm::dot(glm::vec3(planes[i]), glm::vec3(bounds)) + planes[i].w < -bounds.w) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+u32 GpuCulling::CullOnCpu(const CullConstants& constants, const ObjectData* objects, VkDrawIndexedIndirectCommand* commands) {
+    u32 visible = 0;
+
+    for (u32 i = 0; i < constants.ObjectCount; i++) {
+        if (!IsVisible(constants.Planes, objects[i].bounds)) {
+            continue;
+        }
+
+        commands[visible++] = {constants.IndexCount, 1, 0, 0, i};
+    }
+
+    return visible;
+}
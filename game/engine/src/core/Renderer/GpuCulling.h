@@ -0,0 +1,48 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include "UniformBuffer.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <vector>
+
+// Matches the push constant block of Cull.comp.
+struct CullConstants {
+    glm::vec4 Planes[6];
+    u32 ObjectCount;
+    u32 IndexCount;
+};
+
+// Frustum culling of the per-object buffer. On the GPU path a compute pass
+// tests every object's bounding sphere, appends one indexed draw per
+// survivor (firstInstance = object index) and counts them, for
+// vkCmdDrawIndexedIndirectCount. Devices without draw-indirect-count run
+// the same test on the CPU and write the commands into a mapped buffer.
+class GpuCulling {
+public:
+    bool Initialize(VkDevice device, VkPipelineCache cache, VkShaderModule shader, u32 framesInFlight);
+    void Shutdown();
+
+    void SetBuffers(u32 frame, VkBuffer objects, VkBuffer drawCommands, VkBuffer drawCount);
+
+    // Resets the frame's count and dispatches the cull; outside a render pass.
+    void Record(VkCommandBuffer commandBuffer, u32 frame, const CullConstants& constants);
+
+    // Planes point inwards and are normalized, so a plane's distance to a
+    // sphere center compares directly against its radius.
+    static void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+    static bool IsVisible(const glm::vec4 planes[6], const glm::vec4& bounds);
+
+    // The CPU fallback: writes a command per visible object, in object order.
+    static u32 CullOnCpu(const CullConstants& constants, const ObjectData* objects, VkDrawIndexedIndirectCommand* commands);
+
+private:
+    VkDevice Device = VK_NULL_HANDLE;
+    VkDescriptorSetLayout SetLayout = VK_NULL_HANDLE;
+    VkDescriptorPool Pool = VK_NULL_HANDLE;
+    VkPipelineLayout Layout = VK_NULL_HANDLE;
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    std::vector<VkDescriptorSet> Sets;
+    std::vector<VkBuffer> CountBuffers;
+};
@@ -0,0 +1,380 @@
+#include "GpuProfiler.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+#include <cstring>
+
+const char* FRAME_ZONE_NAME = "Frame";
+
+const VkQueryPipelineStatisticFlags PIPELINE_STATISTIC_FLAGS = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                                                               VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                                               VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                               VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                                                               VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                               VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                                               VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+const u32 PIPELINE_STATISTIC_COUNT = sizeof(GpuPipelineStatistics) / sizeof(u64);
+
+static const char* PIPELINE_STATISTIC_NAMES[PIPELINE_STATISTIC_COUNT] = {
+    "input_assembly_vertices",
+    "input_assembly_primitives",
+    "vertex_shader_invocations",
+    "clipping_invocations",
+    "clipping_primitives",
+    "fragment_shader_invocations",
+    "compute_shader_invocations",
+};
+
+bool GpuProfiler::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, u32 queueFamily, u32 framesInFlight) {
+    Device = device;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+
+    u32 queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    u32 validBits = queueFamilies[queueFamily].timestampValidBits;
+    TimestampsSupported = validBits > 0 && properties.limits.timestampPeriod > 0.0f;
+    TimestampPeriod = properties.limits.timestampPeriod;
+    TimestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+    // Secondary command buffers run inside the statistics query, which needs inherited queries.
+    StatisticsSupported = features.pipelineStatisticsQuery && features.inheritedQueries;
+    StatisticFlags = PIPELINE_STATISTIC_FLAGS;
+
+    if (!TimestampsSupported) {
+        EM_WARN("GPU timestamps are not supported on the graphics queue");
+    }
+    if (!StatisticsSupported) {
+        EM_WARN("GPU pipeline statistics are not supported");
+    }
+
+    Frames.resize(framesInFlight);
+
+    for (FrameQueries& frame : Frames) {
+        frame = {};
+
+        if (TimestampsSupported) {
+            VkQueryPoolCreateInfo queryPoolInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolInfo.queryCount = MAX_GPU_ZONES_PER_FRAME * 2;
+
+            if (vkCreateQueryPool(Device, &queryPoolInfo, nullptr, &frame.Timestamps) != VK_SUCCESS) {
+                EM_ERROR("Could not create timestamp query pool");
+                Shutdown();
+                return false;
+            }
+        }
+
+        if (StatisticsSupported) {
+            VkQueryPoolCreateInfo queryPoolInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+            queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            queryPoolInfo.queryCount = 1;
+            queryPoolInfo.pipelineStatistics = StatisticFlags;
+
+            if (vkCreateQueryPool(Device, &queryPoolInfo, nullptr, &frame.Statistics) != VK_SUCCESS) {
+                EM_ERROR("Could not create pipeline statistics query pool");
+                Shutdown();
+                return false;
+            }
+        }
+    }
+
+    FindZone(FRAME_ZONE_NAME);
+
+    return true;
+}
+
+void GpuProfiler::Shutdown() {
+    for (FrameQueries& frame : Frames) {
+        if (frame.Timestamps != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(Device, frame.Timestamps, nullptr);
+        }
+        if (frame.Statistics != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(Device, frame.Statistics, nullptr);
+        }
+    }
+
+    Frames.clear();
+    Zones.clear();
+    Stats.clear();
+    Recording = nullptr;
+    HasStatistics = false;
+    HasFrameTime = false;
+    TimestampsSupported = false;
+    StatisticsSupported = false;
+}
+
+// Zones are few, so a linear search by pointer (then by contents, for names
+// built at different addresses) is cheaper than hashing.
+u32 GpuProfiler::FindZone(const char* name) {
+    for (u32 i = 0; i < Zones.size(); i++) {
+        if (Zones[i].Name == name) {
+            return i;
+        }
+    }
+
+    for (u32 i = 0; i < Zones.size(); i++) {
+        if (strcmp(Zones[i].Name, name) == 0) {
+            return i;
+        }
+    }
+
+    ZoneHistory zone{};
+    zone.Name = name;
+    zone.Samples.resize(GPU_PROFILER_HISTORY);
+    Zones.push_back(zone);
+
+    return (u32)Zones.size() - 1;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, u32 frame) {
+    if (frame >= Frames.size()) {
+        Recording = nullptr;
+        return;
+    }
+
+    Recording = &Frames[frame];
+    Recording->ZoneCount = 0;
+    Recording->Recorded = true;
+
+    if (Recording->Timestamps != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, Recording->Timestamps, 0, MAX_GPU_ZONES_PER_FRAME * 2);
+    }
+
+    if (Recording->Statistics != VK_NULL_HANDLE) {
+        vkCmdResetQueryPool(commandBuffer, Recording->Statistics, 0, 1);
+        vkCmdBeginQuery(commandBuffer, Recording->Statistics, 0, 0);
+    }
+
+    BeginZone(commandBuffer, FRAME_ZONE_NAME);
+}
+
+void GpuProfiler::EndFrame(VkCommandBuffer commandBuffer) {
+    if (Recording == nullptr) {
+        return;
+    }
+
+    EndZone(commandBuffer, 0);
+
+    if (Recording->Statistics != VK_NULL_HANDLE) {
+        vkCmdEndQuery(commandBuffer, Recording->Statistics, 0);
+    }
+
+    Recording = nullptr;
+}
+
+u32 GpuProfiler::BeginZone(VkCommandBuffer commandBuffer, const char* name) {
+    if (Recording == nullptr || Recording->Timestamps == VK_NULL_HANDLE || Recording->ZoneCount == MAX_GPU_ZONES_PER_FRAME) {
+        return ~0u;
+    }
+
+    u32 zone = Recording->ZoneCount++;
+    Recording->Zones[zone] = FindZone(name);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, Recording->Timestamps, zone * 2);
+
+    return zone;
+}
+
+void GpuProfiler::EndZone(VkCommandBuffer commandBuffer, u32 zone) {
+    if (Recording == nullptr || zone >= Recording->ZoneCount) {
+        return;
+    }
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, Recording->Timestamps, zone * 2 + 1);
+}
+
+// The frame's fence has signalled, so everything it wrote is available and
+// nothing here waits. Availability is still checked per query so a zone
+// that was opened but never closed only loses its own sample.
+bool GpuProfiler::Resolve(u32 frame) {
+    if (frame >= Frames.size() || !Frames[frame].Recorded) {
+        return false;
+    }
+
+    FrameQueries& queries = Frames[frame];
+    queries.Recorded = false;
+    bool frameResolved = false;
+
+    if (queries.Timestamps != VK_NULL_HANDLE && queries.ZoneCount > 0) {
+        VkResult result = vkGetQueryPoolResults(Device, queries.Timestamps, 0, queries.ZoneCount * 2, sizeof(Results), Results,
+                                                sizeof(u64) * 2, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        if (result == VK_SUCCESS || result == VK_NOT_READY) {
+            for (u32 i = 0; i < queries.ZoneCount; i++) {
+                const u64* begin = &Results[i * 4];
+                const u64* end = &Results[i * 4 + 2];
+                if (begin[1] == 0 || end[1] == 0) {
+                    continue;
+                }
+
+                ZoneHistory& zone = Zones[queries.Zones[i]];
+                zone.Last = (f64)((end[0] - begin[0]) & TimestampMask) * TimestampPeriod / 1000000.0;
+                zone.Samples[zone.Next] = zone.Last;
+                zone.Next = (zone.Next + 1) % GPU_PROFILER_HISTORY;
+                zone.Count = std::min(zone.Count + 1, GPU_PROFILER_HISTORY);
+
+                if (queries.Zones[i] == 0) {
+                    HasFrameTime = true;
+                    frameResolved = true;
+                }
+            }
+        }
+    }
+
+    if (queries.Statistics != VK_NULL_HANDLE) {
+        u64 values[PIPELINE_STATISTIC_COUNT + 1];
+        VkResult result = vkGetQueryPoolResults(Device, queries.Statistics, 0, 1, sizeof(values), values, sizeof(values),
+                                                VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+        if ((result == VK_SUCCESS || result == VK_NOT_READY) && values[PIPELINE_STATISTIC_COUNT] != 0) {
+            memcpy(&LastStatistics, values, sizeof(LastStatistics));
+            HasStatistics = true;
+        }
+    }
+
+    return frameResolved;
+}
+
+bool GpuProfiler::GetFrameTime(f64& ms) const {
+    if (!HasFrameTime) {
+        return false;
+    }
+
+    ms = Zones[0].Last;
+    return true;
+}
+
+bool GpuProfiler::GetPipelineStatistics(GpuPipelineStatistics& statistics) const {
+    if (!HasStatistics) {
+        return false;
+    }
+
+    statistics = LastStatistics;
+    return true;
+}
+
+static f64 Percentile(const std::vector<f64>& sorted, f64 percentile) {
+    size_t index = (size_t)(percentile * (f64)(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+const std::vector<GpuZoneStats>& GpuProfiler::GetZoneStats() {
+    Stats.clear();
+
+    for (const ZoneHistory& zone : Zones) {
+        if (zone.Count == 0) {
+            continue;
+        }
+
+        Scratch.assign(zone.Samples.begin(), zone.Samples.begin() + zone.Count);
+        std::sort(Scratch.begin(), Scratch.end());
+
+        f64 sum = 0.0;
+        for (f64 sample : Scratch) {
+            sum += sample;
+        }
+
+        GpuZoneStats stats{};
+        stats.Name = zone.Name;
+        stats.SampleCount = zone.Count;
+        stats.LastMs = zone.Last;
+        stats.AverageMs = sum / (f64)zone.Count;
+        stats.MinMs = Scratch.front();
+        stats.MaxMs = Scratch.back();
+        stats.P95Ms = Percentile(Scratch, 0.95);
+        stats.P99Ms = Percentile(Scratch, 0.99);
+        Stats.push_back(stats);
+    }
+
+    return Stats;
+}
+
+bool GpuProfiler::Dump(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        EM_ERROR("Could not open %s for writing", path);
+        return false;
+    }
+
+    size_t length = strlen(path);
+    bool json = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+    bool written = json ? WriteJson(file) : WriteCsv(file);
+
+    if (fclose(file) != 0 || !written) {
+        EM_ERROR("Could not write GPU profile to %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+bool GpuProfiler::WriteCsv(FILE* file) {
+    const std::vector<GpuZoneStats>& stats = GetZoneStats();
+
+    fprintf(file, "zone,samples,last_ms,avg_ms,min_ms,max_ms,p95_ms,p99_ms\n");
+    for (const GpuZoneStats& zone : stats) {
+        fprintf(file, "%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                zone.Name, zone.SampleCount, zone.LastMs, zone.AverageMs, zone.MinMs, zone.MaxMs, zone.P95Ms, zone.P99Ms);
+    }
+
+    if (HasStatistics) {
+        const u64* values = (const u64*)&LastStatistics;
+        fprintf(file, "\nstatistic,value\n");
+        for (u32 i = 0; i < PIPELINE_STATISTIC_COUNT; i++) {
+            fprintf(file, "%s,%llu\n", PIPELINE_STATISTIC_NAMES[i], (unsigned long long)values[i]);
+        }
+    }
+
+    return ferror(file) == 0;
+}
+
+// Zone names come from callers, so quotes, backslashes and control
+// characters are escaped.
+static void WriteJsonString(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if ((u8)*c < 0x20) {
+            fprintf(file, "\\u%04x", (u32)(u8)*c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool GpuProfiler::WriteJson(FILE* file) {
+    const std::vector<GpuZoneStats>& stats = GetZoneStats();
+
+    fprintf(file, "{\n  \"zones\": [");
+    for (size_t i = 0; i < stats.size(); i++) {
+        const GpuZoneStats& zone = stats[i];
+        fprintf(file, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+        WriteJsonString(file, zone.Name);
+        fprintf(file, ", \"samples\": %u, \"last_ms\": %.4f, \"avg_ms\": %.4f, \"min_ms\": %.4f, \"max_ms\": %.4f, \"p95_ms\": %.4f, \"p99_ms\": %.4f}",
+                zone.SampleCount, zone.LastMs, zone.AverageMs, zone.MinMs, zone.MaxMs, zone.P95Ms, zone.P99Ms);
+    }
+    fprintf(file, "\n  ]");
+
+    if (HasStatistics) {
+        const u64* values = (const u64*)&LastStatistics;
+        fprintf(file, ",\n  \"pipeline_statistics\": {");
+        for (u32 i = 0; i < PIPELINE_STATISTIC_COUNT; i++) {
+            fprintf(file, "%s\n    \"%s\": %llu", i == 0 ? "" : ",", PIPELINE_STATISTIC_NAMES[i], (unsigned long long)values[i]);
+        }
+        fprintf(file, "\n  }");
+    }
+
+    fprintf(file, "\n}\n");
+
+    return ferror(file) == 0;
+}
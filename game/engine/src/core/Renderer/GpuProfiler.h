@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+#include <cstdio>
+#include <vector>
+
+const u32 MAX_GPU_ZONES_PER_FRAME = 64;
+const u32 GPU_PROFILER_HISTORY = 512;   // samples kept per zone
+
+// Counters of the last resolved frame, in the order of the query's flags.
+struct GpuPipelineStatistics {
+    u64 InputAssemblyVertices;
+    u64 InputAssemblyPrimitives;
+    u64 VertexShaderInvocations;
+    u64 ClippingInvocations;
+    u64 ClippingPrimitives;
+    u64 FragmentShaderInvocations;
+    u64 ComputeShaderInvocations;
+};
+
+// Times over the rolling window of the last GPU_PROFILER_HISTORY samples.
+struct GpuZoneStats {
+    const char* Name;
+    u32 SampleCount;
+    f64 LastMs;
+    f64 AverageMs;
+    f64 MinMs;
+    f64 MaxMs;
+    f64 P95Ms;
+    f64 P99Ms;
+};
+
+// Named GPU timestamp zones and whole-frame pipeline statistics. Each frame
+// in flight has its own query pools, written while its command buffer is
+// recorded and read back by Resolve once that frame's fence has signalled,
+// so reading results never stalls the GPU or the CPU. Zone 0 is the whole
+// frame, opened by BeginFrame and closed by EndFrame.
+class GpuProfiler {
+public:
+    bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device, u32 queueFamily, u32 framesInFlight);
+    void Shutdown();
+
+    // Reads back the given frame slot; call after waiting for its fence.
+    // Returns whether it produced a new whole-frame time.
+    bool Resolve(u32 frame);
+
+    // Must be recorded outside of any render pass.
+    void BeginFrame(VkCommandBuffer commandBuffer, u32 frame);
+    void EndFrame(VkCommandBuffer commandBuffer);
+
+    // Names must outlive the profiler (string literals, pass names). Zones
+    // may nest; zones past MAX_GPU_ZONES_PER_FRAME are dropped.
+    u32 BeginZone(VkCommandBuffer commandBuffer, const char* name);
+    void EndZone(VkCommandBuffer commandBuffer, u32 zone);
+
+    // Secondary command buffers executed while the statistics query is
+    // active have to declare it in their inheritance info.
+    VkQueryPipelineStatisticFlags GetInheritedStatistics() const { return StatisticsSupported ? StatisticFlags : 0; }
+
+    // Last whole-frame GPU time; false until a frame has been resolved.
+    bool GetFrameTime(f64& ms) const;
+    bool GetPipelineStatistics(GpuPipelineStatistics& statistics) const;
+    const std::vector<GpuZoneStats>& GetZoneStats();
+
+    // Writes the rolling window as CSV, or JSON when the path ends in .json.
+    bool Dump(const char* path);
+
+    bool TimestampsSupported = false;
+    bool StatisticsSupported = false;
+
+private:
+    struct ZoneHistory {
+        const char* Name;
+        std::vector<f64> Samples;   // ring buffer
+        u32 Next;
+        u32 Count;
+        f64 Last;
+    };
+
+    struct FrameQueries {
+        VkQueryPool Timestamps;
+        VkQueryPool Statistics;
+        u32 Zones[MAX_GPU_ZONES_PER_FRAME];   // history index per zone slot
+        u32 ZoneCount;
+        bool Recorded;
+    };
+
+    u32 FindZone(const char* name);
+    bool WriteCsv(FILE* file);
+    bool WriteJson(FILE* file);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    f64 TimestampPeriod = 0.0;   // nanoseconds per tick
+    u64 TimestampMask = ~0ull;
+    VkQueryPipelineStatisticFlags StatisticFlags = 0;
+
+    std::vector<FrameQueries> Frames;
+    FrameQueries* Recording = nullptr;
+
+    std::vector<ZoneHistory> Zones;
+    std::vector<GpuZoneStats> Stats;
+    std::vector<f64> Scratch;
+
+    GpuPipelineStatistics LastStatistics{};
+    bool HasStatistics = false;
+    bool HasFrameTime = false;
+
+    // Results are (value, availability) pairs.
+    u64 Results[MAX_GPU_ZONES_PER_FRAME * 2 * 2];
+};
@@ -0,0 +1,170 @@
+#include "PipelineCache.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const u32 PIPELINE_CACHE_MAGIC = 0x43505345;  // "ESPC"
+const u32 PIPELINE_CACHE_FILE_VERSION = 1;
+
+struct PipelineCacheFileHeader {
+    u32 Magic;
+    u32 FileVersion;
+    u32 VendorID;
+    u32 DeviceID;
+    u32 DriverVersion;
+    u8 CacheUUID[VK_UUID_SIZE];
+    u64 DataSize;
+};
+
+bool PipelineCache::IsCompatible(const u8* data, size_t size) const {
+    if (size < sizeof(PipelineCacheFileHeader)) {
+        return false;
+    }
+
+    PipelineCacheFileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.Magic != PIPELINE_CACHE_MAGIC || header.FileVersion != PIPELINE_CACHE_FILE_VERSION) {
+        return false;
+    }
+
+    if (header.VendorID != Properties.vendorID || header.DeviceID != Properties.deviceID || header.DriverVersion != Properties.driverVersion) {
+        return false;
+    }
+
+    if (memcmp(header.CacheUUID, Properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return false;
+    }
+
+    if (header.DataSize != size - sizeof(PipelineCacheFileHeader)) {
+        return false;
+    }
+
+    // The driver's own header must agree with ours too.
+    if (header.DataSize < sizeof(VkPipelineCacheHeaderVersionOne)) {
+        return false;
+    }
+
+    VkPipelineCacheHeaderVersionOne driverHeader;
+    memcpy(&driverHeader, data + sizeof(PipelineCacheFileHeader), sizeof(driverHeader));
+
+    return driverHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           driverHeader.vendorID == Properties.vendorID &&
+           driverHeader.deviceID == Properties.deviceID &&
+           memcmp(driverHeader.pipelineCacheUUID, Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+bool PipelineCache::Load(VkDevice device, const VkPhysicalDeviceProperties& properties, const char* path) {
+    Device = device;
+    Properties = properties;
+    Path = path;
+    Warm = false;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<u8> fileData;
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+    if (file.is_open()) {
+        size_t fileSize = (size_t)file.tellg();
+        fileData.resize(fileSize);
+        file.seekg(0);
+        file.read((char*)fileData.data(), fileSize);
+        file.close();
+    }
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    if (!fileData.empty()) {
+        if (IsCompatible(fileData.data(), fileData.size())) {
+            createInfo.initialDataSize = fileData.size() - sizeof(PipelineCacheFileHeader);
+            createInfo.pInitialData = fileData.data() + sizeof(PipelineCacheFileHeader);
+            Warm = true;
+        } else {
+            EM_WARN("Pipeline cache %s was written by another device or driver, discarding it", path);
+        }
+    }
+
+    VkResult result = vkCreatePipelineCache(Device, &createInfo, nullptr, &Handle);
+
+    // A driver can still reject data it considers corrupt; start cold rather than fail.
+    if (result != VK_SUCCESS && Warm) {
+        EM_WARN("Driver rejected pipeline cache %s, starting empty", path);
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        Warm = false;
+        result = vkCreatePipelineCache(Device, &createInfo, nullptr, &Handle);
+    }
+
+    if (result != VK_SUCCESS) {
+        EM_ERROR("Could not create pipeline cache");
+        Handle = VK_NULL_HANDLE;
+        return false;
+    }
+
+    f64 loadMs = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    EM_INFO("Pipeline cache %s (%zu bytes) loaded in %.2f ms", Warm ? "warm" : "cold", Warm ? (size_t)createInfo.initialDataSize : (size_t)0, loadMs);
+
+    return true;
+}
+
+bool PipelineCache::Save() {
+    if (Handle == VK_NULL_HANDLE) {
+        return false;
+    }
+
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(Device, Handle, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return false;
+    }
+
+    std::vector<u8> fileData(sizeof(PipelineCacheFileHeader) + dataSize);
+    if (vkGetPipelineCacheData(Device, Handle, &dataSize, fileData.data() + sizeof(PipelineCacheFileHeader)) != VK_SUCCESS) {
+        EM_ERROR("Could not read back pipeline cache data");
+        return false;
+    }
+
+    PipelineCacheFileHeader header{};
+    header.Magic = PIPELINE_CACHE_MAGIC;
+    header.FileVersion = PIPELINE_CACHE_FILE_VERSION;
+    header.VendorID = Properties.vendorID;
+    header.DeviceID = Properties.deviceID;
+    header.DriverVersion = Properties.driverVersion;
+    memcpy(header.CacheUUID, Properties.pipelineCacheUUID, VK_UUID_SIZE);
+    header.DataSize = dataSize;
+    memcpy(fileData.data(), &header, sizeof(header));
+
+    // Write next to the real file and swap it in, so a crash never leaves a torn cache.
+    std::string tempPath = std::string(Path) + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        EM_ERROR("Could not open %s for writing", tempPath.c_str());
+        return false;
+    }
+
+    file.write((const char*)fileData.data(), sizeof(PipelineCacheFileHeader) + dataSize);
+    file.close();
+
+    std::remove(Path);
+    if (std::rename(tempPath.c_str(), Path) != 0) {
+        EM_ERROR("Could not replace pipeline cache %s", Path);
+        return false;
+    }
+
+    EM_INFO("Saved pipeline cache %s (%zu bytes)", Path, dataSize);
+
+    return true;
+}
+
+void PipelineCache::Destroy() {
+    if (Handle != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(Device, Handle, nullptr);
+        Handle = VK_NULL_HANDLE;
+    }
+}
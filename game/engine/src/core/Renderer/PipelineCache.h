@@ -0,0 +1,25 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+
+// VkPipelineCache persisted to disk between runs. The blob is prefixed with
+// our own header so a cache from another GPU or driver is thrown away
+// instead of being handed to the driver.
+class PipelineCache {
+public:
+    bool Load(VkDevice device, const VkPhysicalDeviceProperties& properties, const char* path);
+    bool Save();
+    void Destroy();
+
+    VkPipelineCache Handle = VK_NULL_HANDLE;
+    bool Warm = false;
+
+private:
+    bool IsCompatible(const u8* data, size_t size) const;
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties Properties{};
+    const char* Path = nullptr;
+};
@@ -0,0 +1,385 @@
+#include "PipelineLibrary.h"
+#include "core/Logger/Logger.h"
+#include "core/Math/Vertex.h"
+#include "core/Memory/AllocationHook.h"
+#include "defines.h"
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+const u32 MAX_FALLBACK_DEPTH = 4;
+
+static std::vector<char> ReadShader(const char* path) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+    if (!file.is_open()) {
+        EM_ERROR("Could not open shader %s", path);
+        return {};
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<char> buffer(fileSize);
+    file.seekg(0);
+    file.read(buffer.data(), fileSize);
+
+    return buffer;
+}
+
+bool PipelineLibrary::Initialize(VkDevice device, VkPipelineCache cache, VkPipelineLayout layout, VkRenderPass renderPass, u32 threadCount) {
+    Device = device;
+    Cache = cache;
+    Layout = layout;
+    RenderPass = renderPass;
+    Quit = false;
+
+    threadCount = std::min(std::max(threadCount, 1u), MAX_PIPELINE_THREADS);
+    for (u32 i = 0; i < threadCount; i++) {
+        Workers.emplace_back(&PipelineLibrary::WorkerLoop, this);
+    }
+
+    EM_INFO("Pipeline library using %u compile threads", threadCount);
+
+    return true;
+}
+
+void PipelineLibrary::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(QueueMutex);
+        Quit = true;
+
+        // Whatever has not started yet is dropped.
+        for (u32 index : Queue) {
+            Entries[index].State.store(ENTRY_FAILED, std::memory_order_release);
+        }
+        PendingCount.fetch_sub((u32)Queue.size(), std::memory_order_relaxed);
+        Queue.clear();
+    }
+    WorkReady.notify_all();
+    WorkDone.notify_all();
+
+    for (std::thread& worker : Workers) {
+        worker.join();
+    }
+    Workers.clear();
+
+    u32 entryCount = EntryCount.load(std::memory_order_relaxed);
+    for (u32 i = 0; i < entryCount; i++) {
+        VkPipeline pipeline = Entries[i].Pipeline.exchange(VK_NULL_HANDLE);
+        if (pipeline != VK_NULL_HANDLE) {
+            vkDestroyPipeline(Device, pipeline, nullptr);
+        }
+    }
+    EntryCount.store(0, std::memory_order_relaxed);
+    Lookup.clear();
+
+    for (auto& module : Modules) {
+        vkDestroyShaderModule(Device, module.second, nullptr);
+    }
+    Modules.clear();
+}
+
+// FNV-1a over the desc's fields, with shaders hashed by path.
+u64 PipelineLibrary::Hash(const PipelineDesc& desc) {
+    u64 hash = 14695981039346656037ull;
+
+    auto mix = [&hash](const void* data, size_t size) {
+        const u8* bytes = (const u8*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    mix(desc.VertexShader, strlen(desc.VertexShader) + 1);
+    mix(desc.FragmentShader, strlen(desc.FragmentShader) + 1);
+    mix(&desc.VertexLayout, sizeof(desc.VertexLayout));
+    mix(&desc.Blend, sizeof(desc.Blend));
+    mix(&desc.CullMode, sizeof(desc.CullMode));
+    mix(&desc.SpecializationCount, sizeof(desc.SpecializationCount));
+    mix(desc.Specialization, desc.SpecializationCount * sizeof(u32));
+
+    return hash;
+}
+
+bool PipelineLibrary::Equal(const PipelineDesc& a, const PipelineDesc& b) {
+    return strcmp(a.VertexShader, b.VertexShader) == 0 &&
+           strcmp(a.FragmentShader, b.FragmentShader) == 0 &&
+           a.VertexLayout == b.VertexLayout &&
+           a.Blend == b.Blend &&
+           a.CullMode == b.CullMode &&
+           a.SpecializationCount == b.SpecializationCount &&
+           memcmp(a.Specialization, b.Specialization, a.SpecializationCount * sizeof(u32)) == 0;
+}
+
+u32 PipelineLibrary::Request(const PipelineDesc& desc, u32 fallback) {
+    if (desc.SpecializationCount > MAX_PIPELINE_SPECIALIZATIONS) {
+        EM_ERROR("Pipeline %s has too many specialization constants", desc.VertexShader);
+        return PIPELINE_NONE;
+    }
+
+    // A new variant mid-game is a content change; the lookup and queue may grow.
+    ScopedAllocationAllowance allowance;
+
+    u64 hash = Hash(desc);
+    for (auto found = Lookup.find(hash); found != Lookup.end(); found = Lookup.find(++hash)) {
+        if (Equal(Entries[found->second].Desc, desc)) {
+            return found->second;
+        }
+    }
+
+    u32 index = EntryCount.load(std::memory_order_relaxed);
+    if (index == MAX_PIPELINES) {
+        EM_ERROR("Pipeline library is full");
+        return fallback;
+    }
+
+    Entry& entry = Entries[index];
+    entry.Desc = desc;
+    entry.Fallback = fallback;
+    entry.Pipeline.store(VK_NULL_HANDLE, std::memory_order_relaxed);
+    entry.State.store(ENTRY_PENDING, std::memory_order_relaxed);
+    EntryCount.store(index + 1, std::memory_order_release);
+
+    Lookup[hash] = index;
+
+    {
+        std::lock_guard<std::mutex> lock(QueueMutex);
+        Queue.push_back(index);
+        PendingCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    WorkReady.notify_one();
+
+    return index;
+}
+
+VkPipeline PipelineLibrary::Get(u32 handle) const {
+    u32 entryCount = EntryCount.load(std::memory_order_acquire);
+    for (u32 depth = 0; depth < MAX_FALLBACK_DEPTH && handle < entryCount; depth++) {
+        const Entry& entry = Entries[handle];
+        if (entry.State.load(std::memory_order_acquire) == ENTRY_READY) {
+            return entry.Pipeline.load(std::memory_order_relaxed);
+        }
+        handle = entry.Fallback;
+    }
+
+    return VK_NULL_HANDLE;
+}
+
+bool PipelineLibrary::IsReady(u32 handle) const {
+    return handle < EntryCount.load(std::memory_order_acquire) && Entries[handle].State.load(std::memory_order_acquire) == ENTRY_READY;
+}
+
+bool PipelineLibrary::Wait(u32 handle) {
+    if (handle >= EntryCount.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(QueueMutex);
+    WorkDone.wait(lock, [this, handle] { return Entries[handle].State.load(std::memory_order_acquire) != ENTRY_PENDING; });
+
+    return Entries[handle].State.load(std::memory_order_acquire) == ENTRY_READY;
+}
+
+void PipelineLibrary::WaitIdle() {
+    std::unique_lock<std::mutex> lock(QueueMutex);
+    WorkDone.wait(lock, [this] { return PendingCount.load(std::memory_order_relaxed) == 0; });
+}
+
+void PipelineLibrary::WorkerLoop() {
+    while (true) {
+        u32 index;
+        {
+            std::unique_lock<std::mutex> lock(QueueMutex);
+            WorkReady.wait(lock, [this] { return Quit || !Queue.empty(); });
+
+            if (Quit) {
+                return;
+            }
+
+            index = Queue.front();
+            Queue.erase(Queue.begin());
+        }
+
+        Entry& entry = Entries[index];
+        VkPipeline pipeline;
+        {
+            // Reading shaders and the driver's own bookkeeping allocate, and
+            // variants are compiled here while frames are guarded.
+            ScopedAllocationAllowance allowance;
+            pipeline = Compile(entry.Desc);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(QueueMutex);
+            entry.Pipeline.store(pipeline, std::memory_order_relaxed);
+            entry.State.store(pipeline != VK_NULL_HANDLE ? ENTRY_READY : ENTRY_FAILED, std::memory_order_release);
+            PendingCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+        WorkDone.notify_all();
+    }
+}
+
+// Modules are shared by every variant of a shader and live as long as the library.
+VkShaderModule PipelineLibrary::GetShaderModule(const char* path) {
+    std::lock_guard<std::mutex> lock(ModuleMutex);
+
+    auto found = Modules.find(path);
+    if (found != Modules.end()) {
+        return found->second;
+    }
+
+    std::vector<char> code = ReadShader(path);
+    if (code.empty()) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkShaderModuleCreateInfo createInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+    VkShaderModule module = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(Device, &createInfo, nullptr, &module) != VK_SUCCESS) {
+        EM_ERROR("Could not create shader module %s", path);
+        return VK_NULL_HANDLE;
+    }
+
+    Modules[path] = module;
+    return module;
+}
+
+VkPipeline PipelineLibrary::Compile(const PipelineDesc& desc) {
+    VkShaderModule vertShaderModule = GetShaderModule(desc.VertexShader);
+    VkShaderModule fragShaderModule = GetShaderModule(desc.FragmentShader);
+    if (vertShaderModule == VK_NULL_HANDLE || fragShaderModule == VK_NULL_HANDLE) {
+        return VK_NULL_HANDLE;
+    }
+
+    VkSpecializationMapEntry mapEntries[MAX_PIPELINE_SPECIALIZATIONS];
+    for (u32 i = 0; i < desc.SpecializationCount; i++) {
+        mapEntries[i] = {i, i * (u32)sizeof(u32), sizeof(u32)};
+    }
+
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = desc.SpecializationCount;
+    specializationInfo.pMapEntries = mapEntries;
+    specializationInfo.dataSize = desc.SpecializationCount * sizeof(u32);
+    specializationInfo.pData = desc.Specialization;
+
+    VkPipelineShaderStageCreateInfo shaderStages[2]{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = vertShaderModule;
+    shaderStages[0].pName = "main";
+    shaderStages[0].pSpecializationInfo = desc.SpecializationCount > 0 ? &specializationInfo : nullptr;
+
+    shaderStages[1] = shaderStages[0];
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = fragShaderModule;
+
+    // Binding 0 is the shared unit quad; sprites add their per-instance data
+    // as binding 1 and only take the quad's positions. Object shaders do not
+    // read the quad's UVs.
+    auto quadAttributes = PackedVertex::GetAttributeDescriptions();
+    auto instanceAttributes = SpriteInstance::GetAttributeDescriptions();
+
+    VkVertexInputBindingDescription bindings[] = {PackedVertex::GetBindingDescription(), SpriteInstance::GetBindingDescription()};
+    std::array<VkVertexInputAttributeDescription, 1 + std::tuple_size<decltype(instanceAttributes)>::value> spriteAttributes{};
+    spriteAttributes[0] = quadAttributes[0];
+    for (size_t i = 0; i < instanceAttributes.size(); i++) {
+        spriteAttributes[i + 1] = instanceAttributes[i];
+    }
+
+    VkVertexInputBindingDescription tileBinding = HalfVertex::GetBindingDescription();
+    auto tileAttributes = HalfVertex::GetAttributeDescriptions();
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    vertexInputInfo.pVertexBindingDescriptions = bindings;
+    if (desc.VertexLayout == PIPELINE_VERTEX_SPRITE) {
+        vertexInputInfo.vertexBindingDescriptionCount = 2;
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(spriteAttributes.size());
+        vertexInputInfo.pVertexAttributeDescriptions = spriteAttributes.data();
+    } else if (desc.VertexLayout == PIPELINE_VERTEX_TILE) {
+        vertexInputInfo.pVertexBindingDescriptions = &tileBinding;
+        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(tileAttributes.size());
+        vertexInputInfo.pVertexAttributeDescriptions = tileAttributes.data();
+    } else {
+        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.vertexAttributeDescriptionCount = 2;
+        vertexInputInfo.pVertexAttributeDescriptions = quadAttributes.data();
+    }
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo dynamicState{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    // Viewport and scissor are dynamic, so pipelines do not depend on the extent.
+    VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.CullMode;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    multisampling.minSampleShading = 1.0f;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = desc.Blend != PIPELINE_BLEND_OPAQUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = desc.Blend == PIPELINE_BLEND_ADDITIVE ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    pipelineInfo.stageCount = 2;
+    pipelineInfo.pStages = shaderStages;
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = Layout;
+    pipelineInfo.renderPass = RenderPass;
+    pipelineInfo.subpass = 0;
+
+    auto createStart = std::chrono::high_resolution_clock::now();
+
+    // The pipeline cache is internally synchronized, so workers share it.
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(Device, Cache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
+        EM_ERROR("Could not create pipeline %s / %s", desc.VertexShader, desc.FragmentShader);
+        return VK_NULL_HANDLE;
+    }
+
+    f64 createMs = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - createStart).count();
+    EM_INFO("Created pipeline %s / %s (blend %u, %u constants) in %.2f ms", desc.VertexShader, desc.FragmentShader, (u32)desc.Blend, desc.SpecializationCount, createMs);
+
+    return pipeline;
+}
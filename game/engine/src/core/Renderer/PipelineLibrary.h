@@ -0,0 +1,120 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+const u32 MAX_PIPELINES = 256;
+const u32 MAX_PIPELINE_SPECIALIZATIONS = 8;
+const u32 MAX_PIPELINE_THREADS = 4;
+const u32 PIPELINE_NONE = ~0u;
+
+enum PipelineVertexLayout
+{
+    // Binding 0: the unit quad (PackedVertex position and color).
+    PIPELINE_VERTEX_QUAD = 0,
+    // Binding 0: the quad's positions, binding 1: SpriteInstance.
+    PIPELINE_VERTEX_SPRITE = 1,
+    // Binding 0: HalfVertex position, color and UV, e.g. tile chunks.
+    PIPELINE_VERTEX_TILE = 2,
+};
+
+enum PipelineBlend
+{
+    PIPELINE_BLEND_OPAQUE = 0,
+    PIPELINE_BLEND_ALPHA = 1,
+    PIPELINE_BLEND_ADDITIVE = 2,
+};
+
+// Everything that tells two pipelines apart. Shader paths must outlive the
+// library (string literals). Specialization constant i is constant_id i of
+// both stages, as 32-bit values; ids a shader does not declare are ignored.
+struct PipelineDesc {
+    const char* VertexShader;
+    const char* FragmentShader;
+    PipelineVertexLayout VertexLayout;
+    PipelineBlend Blend;
+    VkCullModeFlags CullMode;
+    u32 SpecializationCount;
+    u32 Specialization[MAX_PIPELINE_SPECIALIZATIONS];
+};
+
+// Graphics pipelines keyed by a hash of their PipelineDesc. Requesting a
+// pipeline the library does not have queues it for a worker thread and
+// returns a handle at once; until the worker is done, Get returns the
+// fallback pipeline given with the request, so recording a frame never waits
+// on vkCreateGraphicsPipelines. Only loading code should call Wait.
+//
+// Every pipeline shares one layout and one render pass, and all of them go
+// through the persistent PipelineCache.
+class PipelineLibrary {
+public:
+    bool Initialize(VkDevice device, VkPipelineCache cache, VkPipelineLayout layout, VkRenderPass renderPass, u32 threadCount);
+    void Shutdown();
+
+    // Main thread only. Returns the existing handle for an identical desc.
+    u32 Request(const PipelineDesc& desc, u32 fallback = PIPELINE_NONE);
+
+    // Safe from any thread. VK_NULL_HANDLE when neither the pipeline nor
+    // its fallbacks are ready.
+    VkPipeline Get(u32 handle) const;
+    bool IsReady(u32 handle) const;
+
+    // Blocks until the pipeline is compiled or has failed.
+    bool Wait(u32 handle);
+    void WaitIdle();
+
+    u32 GetPipelineCount() const { return EntryCount.load(std::memory_order_acquire); }
+    u32 GetPendingCount() const { return PendingCount.load(std::memory_order_relaxed); }
+
+private:
+    enum EntryState
+    {
+        ENTRY_PENDING = 0,
+        ENTRY_READY = 1,
+        ENTRY_FAILED = 2,
+    };
+
+    struct Entry {
+        PipelineDesc Desc;
+        u32 Fallback;
+        std::atomic<VkPipeline> Pipeline;
+        std::atomic<u32> State;
+    };
+
+    static u64 Hash(const PipelineDesc& desc);
+    static bool Equal(const PipelineDesc& a, const PipelineDesc& b);
+
+    void WorkerLoop();
+    VkPipeline Compile(const PipelineDesc& desc);
+    VkShaderModule GetShaderModule(const char* path);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPipelineCache Cache = VK_NULL_HANDLE;
+    VkPipelineLayout Layout = VK_NULL_HANDLE;
+    VkRenderPass RenderPass = VK_NULL_HANDLE;
+
+    Entry Entries[MAX_PIPELINES];
+    // Published with a release store once the entry is filled in, so readers
+    // on other threads never see a half-written one.
+    std::atomic<u32> EntryCount{0};
+    std::unordered_map<u64, u32> Lookup;
+
+    std::vector<std::thread> Workers;
+    std::mutex QueueMutex;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    std::vector<u32> Queue;
+    std::atomic<u32> PendingCount{0};
+    bool Quit = false;
+
+    std::mutex ModuleMutex;
+    std::unordered_map<std::string, VkShaderModule> Modules;
+};
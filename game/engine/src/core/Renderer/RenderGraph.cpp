@@ -0,0 +1,782 @@
+#include "RenderGraph.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+const VkAccessFlags WRITE_ACCESS_MASK = VK_ACCESS_SHADER_WRITE_BIT |
+                                        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                        VK_ACCESS_TRANSFER_WRITE_BIT |
+                                        VK_ACCESS_HOST_WRITE_BIT |
+                                        VK_ACCESS_MEMORY_WRITE_BIT;
+
+struct ImageUsageInfo {
+    VkImageLayout Layout;
+    VkPipelineStageFlags Stages;
+    VkAccessFlags Access;
+    VkImageUsageFlags Usage;
+};
+
+static const ImageUsageInfo IMAGE_USAGE_INFO[] = {
+    {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT},
+    {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_STORAGE_BIT},
+    {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT},
+    {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT},
+    {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT},
+};
+
+bool RenderGraph::Initialize(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator* allocator, u32 framesInFlight) {
+    Device = device;
+    Allocator = allocator;
+    FramesInFlight = framesInFlight;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &MemoryProperties);
+
+    return true;
+}
+
+void RenderGraph::Shutdown() {
+    if (Device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    ReleaseFramebuffers();
+    RetireTransients();
+    DestroyRetired(true);
+
+    for (RenderPassEntry& entry : RenderPasses) {
+        vkDestroyRenderPass(Device, entry.RenderPass, nullptr);
+    }
+    RenderPasses.clear();
+
+    Resources.clear();
+    Passes.clear();
+    PassCount = 0;
+    Device = VK_NULL_HANDLE;
+}
+
+void RenderGraph::Reset() {
+    Resources.clear();
+    PassCount = 0;
+}
+
+RenderGraphResource RenderGraph::ImportImage(const char* name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+                                             VkImageLayout initialLayout, VkPipelineStageFlags initialStages, VkImageLayout finalLayout) {
+    Resource resource{};
+    resource.Name = name;
+    resource.IsImage = true;
+    resource.Imported = true;
+    resource.Image = image;
+    resource.View = view;
+    resource.Format = format;
+    resource.Extent = extent;
+    resource.FinalLayout = finalLayout;
+    resource.State = {initialLayout, initialStages, 0};
+
+    Resources.push_back(resource);
+    return (RenderGraphResource)Resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const char* name, VkBuffer buffer) {
+    Resource resource{};
+    resource.Name = name;
+    resource.Imported = true;
+    resource.Buffer = buffer;
+    resource.State = {VK_IMAGE_LAYOUT_UNDEFINED, 0, 0};
+
+    Resources.push_back(resource);
+    return (RenderGraphResource)Resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::CreateImage(const char* name, const RenderGraphImageDesc& desc) {
+    Resource resource{};
+    resource.Name = name;
+    resource.IsImage = true;
+    resource.Format = desc.Format;
+    resource.Extent = {desc.Width, desc.Height};
+    resource.FinalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    Resources.push_back(resource);
+    return (RenderGraphResource)Resources.size() - 1;
+}
+
+u32 RenderGraph::AddPass(const char* name, const ExecuteFunction& execute) {
+    // Pass slots are reused across frames so their access lists keep their capacity.
+    if (PassCount == Passes.size()) {
+        Passes.emplace_back();
+    }
+
+    Pass& pass = Passes[PassCount];
+    pass.Name = name;
+    pass.Execute = execute;
+    pass.Accesses.clear();
+    pass.ColorCount = 0;
+    pass.SideEffect = false;
+    pass.Secondary = false;
+    pass.Live = false;
+    pass.RenderPass = VK_NULL_HANDLE;
+    pass.Framebuffer = VK_NULL_HANDLE;
+
+    return PassCount++;
+}
+
+void RenderGraph::AddAccess(u32 passIndex, RenderGraphResource resource, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access, bool read, bool write) {
+    Pass& pass = Passes[passIndex];
+
+    for (Access& existing : pass.Accesses) {
+        if (existing.Resource != resource) {
+            continue;
+        }
+
+        if (existing.Layout != layout) {
+            EM_ERROR("Render graph pass %s uses %s in two layouts", pass.Name, Resources[resource].Name);
+        }
+
+        existing.Stages |= stages;
+        existing.AccessMask |= access;
+        existing.Read |= read;
+        existing.Write |= write;
+        return;
+    }
+
+    pass.Accesses.push_back({resource, layout, stages, access, read, write});
+}
+
+void RenderGraph::WriteColor(u32 pass, RenderGraphResource image, VkAttachmentLoadOp loadOp, VkClearValue clearValue) {
+    Pass& target = Passes[pass];
+
+    if (target.ColorCount == MAX_RENDER_GRAPH_COLOR_ATTACHMENTS) {
+        EM_ERROR("Render graph pass %s has too many color attachments", target.Name);
+        return;
+    }
+
+    target.Colors[target.ColorCount] = image;
+    target.LoadOps[target.ColorCount] = loadOp;
+    target.ClearValues[target.ColorCount] = clearValue;
+    target.ColorCount++;
+
+    bool load = loadOp == VK_ATTACHMENT_LOAD_OP_LOAD;
+    VkAccessFlags access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (load ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+
+    Resources[image].Usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    AddAccess(pass, image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, access, load, true);
+}
+
+void RenderGraph::ReadImage(u32 pass, RenderGraphResource image, RenderGraphImageUsage usage) {
+    const ImageUsageInfo& info = IMAGE_USAGE_INFO[usage];
+    Resources[image].Usage |= info.Usage;
+    AddAccess(pass, image, info.Layout, info.Stages, info.Access & ~WRITE_ACCESS_MASK, true, false);
+}
+
+void RenderGraph::WriteImage(u32 pass, RenderGraphResource image, RenderGraphImageUsage usage) {
+    const ImageUsageInfo& info = IMAGE_USAGE_INFO[usage];
+    Resources[image].Usage |= info.Usage;
+    AddAccess(pass, image, info.Layout, info.Stages, info.Access, false, true);
+}
+
+void RenderGraph::ReadBuffer(u32 pass, RenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+    AddAccess(pass, buffer, VK_IMAGE_LAYOUT_UNDEFINED, stages, access, true, false);
+}
+
+void RenderGraph::WriteBuffer(u32 pass, RenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access) {
+    AddAccess(pass, buffer, VK_IMAGE_LAYOUT_UNDEFINED, stages, access, false, true);
+}
+
+void RenderGraph::SetSideEffect(u32 pass) {
+    Passes[pass].SideEffect = true;
+}
+
+void RenderGraph::SetSecondaryCommandBuffers(u32 pass, bool secondary) {
+    Passes[pass].Secondary = secondary;
+}
+
+VkImageView RenderGraph::GetImageView(RenderGraphResource image) const {
+    return Resources[image].View;
+}
+
+// Walks the passes backwards keeping a pass only if it has side effects or
+// writes something a later live pass reads (or something imported, which
+// outlives the graph). A color write that does not load the old contents
+// ends the need for them, so earlier writers of the same image drop out.
+void RenderGraph::CullPasses() {
+    for (Resource& resource : Resources) {
+        resource.Needed = resource.Imported;
+        resource.FirstPass = ~0u;
+        resource.LastPass = 0;
+    }
+
+    for (u32 i = PassCount; i-- > 0;) {
+        Pass& pass = Passes[i];
+        pass.Live = pass.SideEffect;
+
+        for (const Access& access : pass.Accesses) {
+            if (access.Write && Resources[access.Resource].Needed) {
+                pass.Live = true;
+            }
+        }
+
+        if (!pass.Live) {
+            Stats.CulledPassCount++;
+            continue;
+        }
+
+        for (const Access& access : pass.Accesses) {
+            Resource& resource = Resources[access.Resource];
+
+            if (access.Write && !access.Read && access.Layout == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+                resource.Needed = false;
+            }
+            if (access.Read) {
+                resource.Needed = true;
+            }
+
+            resource.FirstPass = i;
+            resource.LastPass = std::max(resource.LastPass, i);
+        }
+    }
+}
+
+bool RenderGraph::Compile(u64 frame) {
+    Frame = frame;
+    Stats = {};
+    Stats.PassCount = PassCount;
+
+    CullPasses();
+
+    if (!AllocateTransients()) {
+        return false;
+    }
+
+    for (u32 i = 0; i < PassCount; i++) {
+        Pass& pass = Passes[i];
+        if (!pass.Live || pass.ColorCount == 0) {
+            continue;
+        }
+
+        VkExtent2D extent = Resources[pass.Colors[0]].Extent;
+        for (u32 c = 1; c < pass.ColorCount; c++) {
+            const VkExtent2D& other = Resources[pass.Colors[c]].Extent;
+            if (other.width != extent.width || other.height != extent.height) {
+                EM_ERROR("Render graph pass %s has color attachments of different sizes", pass.Name);
+                return false;
+            }
+        }
+
+        pass.RenderPass = GetRenderPass(pass);
+        pass.Framebuffer = GetFramebuffer(pass, pass.RenderPass);
+        if (pass.RenderPass == VK_NULL_HANDLE || pass.Framebuffer == VK_NULL_HANDLE) {
+            return false;
+        }
+    }
+
+    DestroyRetired(false);
+
+    return true;
+}
+
+u32 RenderGraph::FindMemoryType(u32 typeBits) const {
+    for (u32 i = 0; i < MemoryProperties.memoryTypeCount; i++) {
+        if ((typeBits & (1 << i)) && (MemoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            return i;
+        }
+    }
+
+    for (u32 i = 0; i < MemoryProperties.memoryTypeCount; i++) {
+        if (typeBits & (1 << i)) {
+            return i;
+        }
+    }
+
+    return ~0u;
+}
+
+// Creates the transient images of this graph shape and packs them into
+// memory buckets: an image reuses a bucket whose previous users all ended
+// before its first pass, so images that are never alive together share
+// memory. Images are bound at the start of their bucket.
+bool RenderGraph::AllocateTransients() {
+    // Members so that a graph of unchanged shape compiles without allocating.
+    std::vector<RenderGraphResource>& transients = TransientScratch;
+    std::vector<TransientKey>& keys = KeyScratch;
+    transients.clear();
+    keys.clear();
+
+    for (u32 i = 0; i < Resources.size(); i++) {
+        const Resource& resource = Resources[i];
+        if (resource.Imported || resource.FirstPass == ~0u) {
+            continue;
+        }
+
+        transients.push_back(i);
+        keys.push_back({resource.Format, resource.Extent.width, resource.Extent.height, resource.Usage, resource.FirstPass, resource.LastPass});
+    }
+
+    bool sameShape = keys.size() == TransientKeys.size();
+    for (size_t i = 0; sameShape && i < keys.size(); i++) {
+        const TransientKey& a = keys[i];
+        const TransientKey& b = TransientKeys[i];
+        sameShape = a.Format == b.Format && a.Width == b.Width && a.Height == b.Height && a.Usage == b.Usage &&
+                    a.FirstPass == b.FirstPass && a.LastPass == b.LastPass;
+    }
+
+    if (!sameShape) {
+        RetireTransients();
+        TransientKeys = keys;
+        TransientImages.resize(keys.size());
+        TransientBytes = 0;
+        AllocatedBytes = 0;
+
+        std::vector<VkMemoryRequirements> requirements(keys.size());
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            const TransientKey& key = keys[i];
+
+            VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.format = key.Format;
+            imageInfo.extent = {key.Width, key.Height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.usage = key.Usage;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            TransientImages[i] = {};
+            if (vkCreateImage(Device, &imageInfo, nullptr, &TransientImages[i].Image) != VK_SUCCESS) {
+                EM_ERROR("Could not create transient image %s", Resources[transients[i]].Name);
+                RetireTransients();
+                return false;
+            }
+
+            vkGetImageMemoryRequirements(Device, TransientImages[i].Image, &requirements[i]);
+            TransientBytes += requirements[i].size;
+        }
+
+        // Assign in order of first use; keys are already in declaration
+        // order, which is close but not guaranteed to match.
+        std::vector<u32> order(keys.size());
+        for (u32 i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return keys[a].FirstPass < keys[b].FirstPass; });
+
+        for (u32 index : order) {
+            const VkMemoryRequirements& required = requirements[index];
+            u32 best = ~0u;
+
+            for (u32 b = 0; b < Buckets.size(); b++) {
+                const MemoryBucket& bucket = Buckets[b];
+                if (bucket.LastPass >= keys[index].FirstPass || (bucket.TypeBits & required.memoryTypeBits) == 0) {
+                    continue;
+                }
+
+                // Prefer a bucket that is already big enough, then the biggest one.
+                if (best == ~0u) {
+                    best = b;
+                    continue;
+                }
+
+                bool fits = bucket.Size >= required.size;
+                bool bestFits = Buckets[best].Size >= required.size;
+                if ((fits && !bestFits) || (fits == bestFits && (fits ? bucket.Size < Buckets[best].Size : bucket.Size > Buckets[best].Size))) {
+                    best = b;
+                }
+            }
+
+            if (best == ~0u) {
+                Buckets.push_back({});
+                best = (u32)Buckets.size() - 1;
+                Buckets[best].TypeBits = required.memoryTypeBits;
+            }
+
+            MemoryBucket& bucket = Buckets[best];
+            bucket.Size = std::max(bucket.Size, required.size);
+            bucket.Alignment = std::max(bucket.Alignment, required.alignment);
+            bucket.TypeBits &= required.memoryTypeBits;
+            bucket.LastPass = keys[index].LastPass;
+            TransientImages[index].Bucket = best;
+        }
+
+        for (MemoryBucket& bucket : Buckets) {
+            VkMemoryRequirements requirement{bucket.Size, bucket.Alignment, bucket.TypeBits};
+            u32 memoryType = FindMemoryType(bucket.TypeBits);
+
+            if (memoryType == ~0u || !Allocator->Allocate(requirement, memoryType, bucket.Allocation)) {
+                EM_ERROR("Could not allocate %llu bytes of transient image memory", (unsigned long long)bucket.Size);
+                RetireTransients();
+                return false;
+            }
+
+            bucket.Stages = 0;
+            bucket.Access = 0;
+            AllocatedBytes += bucket.Size;
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            TransientImage& transient = TransientImages[i];
+            const GpuAllocation& allocation = Buckets[transient.Bucket].Allocation;
+            vkBindImageMemory(Device, transient.Image, allocation.Memory, allocation.Offset);
+
+            VkImageViewCreateInfo viewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+            viewInfo.image = transient.Image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = keys[i].Format;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.levelCount = 1;
+            viewInfo.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(Device, &viewInfo, nullptr, &transient.View) != VK_SUCCESS) {
+                EM_ERROR("Could not create transient image view %s", Resources[transients[i]].Name);
+                RetireTransients();
+                return false;
+            }
+        }
+
+        EM_INFO("Render graph transients: %u images, %llu KB aliased into %llu KB",
+                (u32)keys.size(), (unsigned long long)(TransientBytes / 1024), (unsigned long long)(AllocatedBytes / 1024));
+    }
+
+    for (size_t i = 0; i < transients.size(); i++) {
+        Resource& resource = Resources[transients[i]];
+        resource.Physical = (u32)i;
+        resource.Image = TransientImages[i].Image;
+        resource.View = TransientImages[i].View;
+    }
+
+    Stats.TransientImageCount = (u32)transients.size();
+    Stats.TransientBytes = TransientBytes;
+    Stats.AllocatedBytes = AllocatedBytes;
+
+    return true;
+}
+
+void RenderGraph::RetireTransients() {
+    if (TransientImages.empty() && Buckets.empty()) {
+        return;
+    }
+
+    RetiredTransients retired;
+    retired.Images = TransientImages;
+    retired.Frame = Frame;
+    for (MemoryBucket& bucket : Buckets) {
+        if (bucket.Allocation.Memory != VK_NULL_HANDLE) {
+            retired.Allocations.push_back(bucket.Allocation);
+        }
+    }
+    Retired.push_back(retired);
+
+    TransientKeys.clear();
+    TransientImages.clear();
+    Buckets.clear();
+}
+
+// Retired transients were last used by frames before the one they were
+// retired in, so they are free once that many frames have completed.
+void RenderGraph::DestroyRetired(bool all) {
+    for (size_t i = 0; i < Retired.size();) {
+        RetiredTransients& retired = Retired[i];
+        if (!all && retired.Frame + FramesInFlight > Frame) {
+            i++;
+            continue;
+        }
+
+        for (TransientImage& transient : retired.Images) {
+            ReleaseImageView(transient.View);
+
+            if (transient.View != VK_NULL_HANDLE) {
+                vkDestroyImageView(Device, transient.View, nullptr);
+            }
+            if (transient.Image != VK_NULL_HANDLE) {
+                vkDestroyImage(Device, transient.Image, nullptr);
+            }
+        }
+
+        for (GpuAllocation& allocation : retired.Allocations) {
+            Allocator->Free(allocation);
+        }
+
+        Retired[i] = Retired.back();
+        Retired.pop_back();
+    }
+}
+
+void RenderGraph::ReleaseImageView(VkImageView view) {
+    for (size_t i = 0; i < Framebuffers.size();) {
+        FramebufferEntry& entry = Framebuffers[i];
+        bool references = std::find(entry.Views, entry.Views + entry.ViewCount, view) != entry.Views + entry.ViewCount;
+        if (references) {
+            vkDestroyFramebuffer(Device, entry.Framebuffer, nullptr);
+            entry = Framebuffers.back();
+            Framebuffers.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+void RenderGraph::ReleaseFramebuffers() {
+    for (FramebufferEntry& entry : Framebuffers) {
+        vkDestroyFramebuffer(Device, entry.Framebuffer, nullptr);
+    }
+    Framebuffers.clear();
+}
+
+// Attachments stay in COLOR_ATTACHMENT_OPTIMAL for the whole render pass;
+// the graph's own barriers do every transition, so the passes need no
+// subpass dependencies. A transient whose last use is this pass is not
+// stored.
+VkRenderPass RenderGraph::GetRenderPass(const Pass& pass) {
+    RenderPassEntry key{};
+    key.ColorCount = pass.ColorCount;
+
+    u32 passIndex = (u32)(&pass - Passes.data());
+    for (u32 i = 0; i < pass.ColorCount; i++) {
+        const Resource& resource = Resources[pass.Colors[i]];
+        key.Formats[i] = resource.Format;
+        key.LoadOps[i] = pass.LoadOps[i];
+        key.StoreOps[i] = (!resource.Imported && resource.LastPass == passIndex) ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+    }
+
+    for (const RenderPassEntry& entry : RenderPasses) {
+        if (entry.ColorCount != key.ColorCount) {
+            continue;
+        }
+
+        bool match = true;
+        for (u32 i = 0; i < key.ColorCount && match; i++) {
+            match = entry.Formats[i] == key.Formats[i] && entry.LoadOps[i] == key.LoadOps[i] && entry.StoreOps[i] == key.StoreOps[i];
+        }
+
+        if (match) {
+            return entry.RenderPass;
+        }
+    }
+
+    VkAttachmentDescription attachments[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS]{};
+    VkAttachmentReference references[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS]{};
+
+    for (u32 i = 0; i < key.ColorCount; i++) {
+        attachments[i].format = key.Formats[i];
+        attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[i].loadOp = key.LoadOps[i];
+        attachments[i].storeOp = key.StoreOps[i];
+        attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[i].initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachments[i].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        references[i].attachment = i;
+        references[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = key.ColorCount;
+    subpass.pColorAttachments = references;
+
+    VkRenderPassCreateInfo renderPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    renderPassInfo.attachmentCount = key.ColorCount;
+    renderPassInfo.pAttachments = attachments;
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    if (vkCreateRenderPass(Device, &renderPassInfo, nullptr, &key.RenderPass) != VK_SUCCESS) {
+        EM_ERROR("Could not create render pass for %s", pass.Name);
+        return VK_NULL_HANDLE;
+    }
+
+    RenderPasses.push_back(key);
+    return key.RenderPass;
+}
+
+// Cached until one of its views is released. A swapchain image's framebuffer
+// comes back only when that image is acquired again, in any order, so age is
+// no sign that it is unused.
+VkFramebuffer RenderGraph::GetFramebuffer(const Pass& pass, VkRenderPass renderPass) {
+    FramebufferEntry key{};
+    key.RenderPass = renderPass;
+    key.ViewCount = pass.ColorCount;
+    key.Extent = Resources[pass.Colors[0]].Extent;
+    for (u32 i = 0; i < pass.ColorCount; i++) {
+        key.Views[i] = Resources[pass.Colors[i]].View;
+    }
+
+    for (FramebufferEntry& entry : Framebuffers) {
+        if (entry.RenderPass == key.RenderPass && entry.ViewCount == key.ViewCount &&
+            entry.Extent.width == key.Extent.width && entry.Extent.height == key.Extent.height &&
+            std::equal(entry.Views, entry.Views + entry.ViewCount, key.Views)) {
+            return entry.Framebuffer;
+        }
+    }
+
+    VkFramebufferCreateInfo createInfo{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+    createInfo.renderPass = renderPass;
+    createInfo.attachmentCount = key.ViewCount;
+    createInfo.pAttachments = key.Views;
+    createInfo.width = key.Extent.width;
+    createInfo.height = key.Extent.height;
+    createInfo.layers = 1;
+
+    if (vkCreateFramebuffer(Device, &createInfo, nullptr, &key.Framebuffer) != VK_SUCCESS) {
+        EM_ERROR("Could not create framebuffer for %s", pass.Name);
+        return VK_NULL_HANDLE;
+    }
+
+    Framebuffers.push_back(key);
+    return key.Framebuffer;
+}
+
+// A barrier is needed for a layout change, after any write (read-after-write
+// and write-after-write), and before a write that follows reads
+// (write-after-read, execution dependency only). Reads that follow reads in
+// the same layout just widen the set of stages a later writer waits for.
+static bool NeedsBarrier(VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access, bool isImage, VkImageLayout toLayout, bool toWrite) {
+    if (isImage && layout != toLayout) {
+        return true;
+    }
+    if (access & WRITE_ACCESS_MASK) {
+        return true;
+    }
+    return toWrite && stages != 0;
+}
+
+void RenderGraph::Execute(VkCommandBuffer commandBuffer) {
+    for (u32 i = 0; i < PassCount; i++) {
+        const Pass& pass = Passes[i];
+        if (!pass.Live) {
+            continue;
+        }
+
+        u32 zone = Profiler != nullptr ? Profiler->BeginZone(commandBuffer, pass.Name) : ~0u;
+
+        ImageBarriers.clear();
+        BufferBarriers.clear();
+        VkPipelineStageFlags srcStages = 0;
+        VkPipelineStageFlags dstStages = 0;
+
+        for (const Access& access : pass.Accesses) {
+            Resource& resource = Resources[access.Resource];
+            ResourceState& state = resource.State;
+
+            // A transient starts out undefined, after whatever last used its memory.
+            if (!resource.Imported && resource.FirstPass == i) {
+                const MemoryBucket& bucket = Buckets[TransientImages[resource.Physical].Bucket];
+                state = {VK_IMAGE_LAYOUT_UNDEFINED, bucket.Stages, bucket.Access};
+            }
+
+            bool firstTransientUse = !resource.Imported && resource.FirstPass == i;
+            if (!firstTransientUse && !NeedsBarrier(state.Layout, state.Stages, state.Access, resource.IsImage, access.Layout, access.Write)) {
+                state.Stages |= access.Stages;
+                state.Access |= access.AccessMask;
+                continue;
+            }
+
+            srcStages |= state.Stages != 0 ? state.Stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            dstStages |= access.Stages;
+
+            if (resource.IsImage) {
+                VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+                barrier.srcAccessMask = state.Access & WRITE_ACCESS_MASK;
+                barrier.dstAccessMask = access.AccessMask;
+                barrier.oldLayout = state.Layout;
+                barrier.newLayout = access.Layout;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = resource.Image;
+                barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                barrier.subresourceRange.levelCount = 1;
+                barrier.subresourceRange.layerCount = 1;
+                ImageBarriers.push_back(barrier);
+            } else {
+                VkBufferMemoryBarrier barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER};
+                barrier.srcAccessMask = state.Access & WRITE_ACCESS_MASK;
+                barrier.dstAccessMask = access.AccessMask;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = resource.Buffer;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+                BufferBarriers.push_back(barrier);
+            }
+
+            state = {access.Layout, access.Stages, access.AccessMask};
+        }
+
+        if (!ImageBarriers.empty() || !BufferBarriers.empty()) {
+            vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0, 0, nullptr,
+                                 (u32)BufferBarriers.size(), BufferBarriers.data(), (u32)ImageBarriers.size(), ImageBarriers.data());
+            Stats.BarrierCount += (u32)(ImageBarriers.size() + BufferBarriers.size());
+        }
+
+        RenderGraphPassContext context{};
+
+        if (pass.ColorCount > 0) {
+            context.RenderPass = pass.RenderPass;
+            context.Framebuffer = pass.Framebuffer;
+            context.Extent = Resources[pass.Colors[0]].Extent;
+
+            VkRenderPassBeginInfo renderPassInfo{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+            renderPassInfo.renderPass = pass.RenderPass;
+            renderPassInfo.framebuffer = pass.Framebuffer;
+            renderPassInfo.renderArea.offset = {0, 0};
+            renderPassInfo.renderArea.extent = context.Extent;
+            renderPassInfo.clearValueCount = pass.ColorCount;
+            renderPassInfo.pClearValues = pass.ClearValues;
+
+            vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, pass.Secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+        }
+
+        pass.Execute(commandBuffer, context);
+
+        if (pass.ColorCount > 0) {
+            vkCmdEndRenderPass(commandBuffer);
+        }
+
+        if (Profiler != nullptr) {
+            Profiler->EndZone(commandBuffer, zone);
+        }
+
+        for (const Access& access : pass.Accesses) {
+            Resource& resource = Resources[access.Resource];
+            if (!resource.Imported && resource.LastPass == i) {
+                MemoryBucket& bucket = Buckets[TransientImages[resource.Physical].Bucket];
+                bucket.Stages = resource.State.Stages;
+                bucket.Access = resource.State.Access;
+            }
+        }
+    }
+
+    // Hand imported images back in the layout their owner expects.
+    ImageBarriers.clear();
+    VkPipelineStageFlags srcStages = 0;
+
+    for (Resource& resource : Resources) {
+        if (!resource.Imported || !resource.IsImage || resource.FinalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
+            resource.FinalLayout == resource.State.Layout) {
+            continue;
+        }
+
+        VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        barrier.srcAccessMask = resource.State.Access & WRITE_ACCESS_MASK;
+        barrier.dstAccessMask = 0;
+        barrier.oldLayout = resource.State.Layout;
+        barrier.newLayout = resource.FinalLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = resource.Image;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        ImageBarriers.push_back(barrier);
+
+        srcStages |= resource.State.Stages != 0 ? resource.State.Stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        resource.State = {resource.FinalLayout, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0};
+    }
+
+    if (!ImageBarriers.empty()) {
+        vkCmdPipelineBarrier(commandBuffer, srcStages, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr,
+                             (u32)ImageBarriers.size(), ImageBarriers.data());
+        Stats.BarrierCount += (u32)ImageBarriers.size();
+    }
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include "GpuAllocator.h"
+#include "GpuProfiler.h"
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <vector>
+
+typedef u32 RenderGraphResource;
+
+const RenderGraphResource RENDER_GRAPH_NONE = ~0u;
+const u32 MAX_RENDER_GRAPH_COLOR_ATTACHMENTS = 4;
+
+enum RenderGraphImageUsage
+{
+    RENDER_GRAPH_SAMPLED = 0,        // sampled in fragment or compute shaders
+    RENDER_GRAPH_STORAGE_READ = 1,   // storage image, compute
+    RENDER_GRAPH_STORAGE_WRITE = 2,
+    RENDER_GRAPH_TRANSFER_SRC = 3,
+    RENDER_GRAPH_TRANSFER_DST = 4,
+};
+
+struct RenderGraphImageDesc
+{
+    VkFormat Format;
+    u32 Width;
+    u32 Height;
+};
+
+// What a pass gets while it is being recorded. Graphics passes (those with
+// color attachments) run inside their render pass; RenderPass and
+// Framebuffer are VK_NULL_HANDLE for the others.
+struct RenderGraphPassContext
+{
+    VkRenderPass RenderPass;
+    VkFramebuffer Framebuffer;
+    VkExtent2D Extent;
+};
+
+struct RenderGraphStats
+{
+    u32 PassCount;
+    u32 CulledPassCount;
+    u32 BarrierCount;
+    u32 TransientImageCount;
+    VkDeviceSize TransientBytes;   // what the transients would take unaliased
+    VkDeviceSize AllocatedBytes;   // what they actually take
+};
+
+// Frame graph rebuilt every frame: passes declare which images and buffers
+// they read and write, Compile drops passes whose results nobody consumes
+// and places transient images with disjoint lifetimes in the same memory,
+// Execute records the live passes in declaration order with the barriers
+// and layout transitions their accesses need, and nothing more.
+//
+// Transient images and their memory are cached while the graph keeps the
+// same shape, so steady-state frames create no Vulkan objects.
+class RenderGraph {
+public:
+    typedef std::function<void(VkCommandBuffer commandBuffer, const RenderGraphPassContext& context)> ExecuteFunction;
+
+    bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator* allocator, u32 framesInFlight);
+    void Shutdown();
+
+    // Each live pass, with its barriers, becomes a GPU zone named after it.
+    void SetProfiler(GpuProfiler* profiler) { Profiler = profiler; }
+
+    // Starts a new frame's declarations.
+    void Reset();
+
+    // External images enter in initialLayout, with initialStages as the
+    // stages the first barrier has to wait for (e.g. the stage the acquire
+    // semaphore is waited at), and are left in finalLayout.
+    RenderGraphResource ImportImage(const char* name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+                                    VkImageLayout initialLayout, VkPipelineStageFlags initialStages, VkImageLayout finalLayout);
+    RenderGraphResource ImportBuffer(const char* name, VkBuffer buffer);
+    RenderGraphResource CreateImage(const char* name, const RenderGraphImageDesc& desc);
+
+    u32 AddPass(const char* name, const ExecuteFunction& execute);
+
+    // LOAD_OP_LOAD makes the pass a reader of the previous contents as well.
+    // WriteImage takes the writing usages (storage write, transfer dst).
+    void WriteColor(u32 pass, RenderGraphResource image, VkAttachmentLoadOp loadOp, VkClearValue clearValue = {});
+    void ReadImage(u32 pass, RenderGraphResource image, RenderGraphImageUsage usage);
+    void WriteImage(u32 pass, RenderGraphResource image, RenderGraphImageUsage usage);
+    void ReadBuffer(u32 pass, RenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+    void WriteBuffer(u32 pass, RenderGraphResource buffer, VkPipelineStageFlags stages, VkAccessFlags access);
+
+    // Passes with effects the graph cannot see (readbacks, queries) are never culled.
+    void SetSideEffect(u32 pass);
+    void SetSecondaryCommandBuffers(u32 pass, bool secondary);
+
+    bool Compile(u64 frame);
+    void Execute(VkCommandBuffer commandBuffer);
+
+    VkImageView GetImageView(RenderGraphResource image) const;
+    const RenderGraphStats& GetStats() const { return Stats; }
+
+    // Framebuffers hold on to imported views; call after the device is idle
+    // and before those views are destroyed.
+    void ReleaseFramebuffers();
+    // Same for the framebuffers of one view, once no frame in flight uses it.
+    void ReleaseImageView(VkImageView view);
+
+private:
+    struct ResourceState {
+        VkImageLayout Layout;
+        VkPipelineStageFlags Stages;
+        VkAccessFlags Access;
+    };
+
+    struct Resource {
+        const char* Name;
+        bool IsImage;
+        bool Imported;
+        VkImage Image;
+        VkImageView View;
+        VkBuffer Buffer;
+        VkFormat Format;
+        VkExtent2D Extent;
+        VkImageUsageFlags Usage;
+        VkImageLayout FinalLayout;
+        ResourceState State;
+        u32 FirstPass;
+        u32 LastPass;
+        u32 Physical;   // index into TransientImages
+        bool Needed;
+    };
+
+    struct Access {
+        RenderGraphResource Resource;
+        VkImageLayout Layout;
+        VkPipelineStageFlags Stages;
+        VkAccessFlags AccessMask;
+        bool Read;
+        bool Write;
+    };
+
+    struct Pass {
+        const char* Name;
+        ExecuteFunction Execute;
+        std::vector<Access> Accesses;
+        RenderGraphResource Colors[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        VkAttachmentLoadOp LoadOps[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        VkClearValue ClearValues[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        u32 ColorCount;
+        bool SideEffect;
+        bool Secondary;
+        bool Live;
+        VkRenderPass RenderPass;
+        VkFramebuffer Framebuffer;
+    };
+
+    // One transient image as created last time the graph changed shape.
+    struct TransientKey {
+        VkFormat Format;
+        u32 Width;
+        u32 Height;
+        VkImageUsageFlags Usage;
+        u32 FirstPass;
+        u32 LastPass;
+    };
+
+    struct TransientImage {
+        VkImage Image;
+        VkImageView View;
+        u32 Bucket;
+    };
+
+    // A block of memory shared by transients whose lifetimes do not overlap.
+    // Stages/Access describe the last use of whichever image touched it
+    // last, which is what the next user's first barrier waits on (this also
+    // orders consecutive frames that reuse the same memory).
+    struct MemoryBucket {
+        GpuAllocation Allocation;
+        VkDeviceSize Size;
+        VkDeviceSize Alignment;
+        u32 TypeBits;
+        u32 LastPass;
+        VkPipelineStageFlags Stages;
+        VkAccessFlags Access;
+    };
+
+    struct RenderPassEntry {
+        VkFormat Formats[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        VkAttachmentLoadOp LoadOps[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        VkAttachmentStoreOp StoreOps[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        u32 ColorCount;
+        VkRenderPass RenderPass;
+    };
+
+    struct FramebufferEntry {
+        VkRenderPass RenderPass;
+        VkImageView Views[MAX_RENDER_GRAPH_COLOR_ATTACHMENTS];
+        u32 ViewCount;
+        VkExtent2D Extent;
+        VkFramebuffer Framebuffer;
+    };
+
+    struct RetiredTransients {
+        std::vector<TransientImage> Images;
+        std::vector<GpuAllocation> Allocations;
+        u64 Frame;
+    };
+
+    void AddAccess(u32 pass, RenderGraphResource resource, VkImageLayout layout, VkPipelineStageFlags stages, VkAccessFlags access, bool read, bool write);
+    void CullPasses();
+    bool AllocateTransients();
+    void RetireTransients();
+    void DestroyRetired(bool all);
+    VkRenderPass GetRenderPass(const Pass& pass);
+    VkFramebuffer GetFramebuffer(const Pass& pass, VkRenderPass renderPass);
+    u32 FindMemoryType(u32 typeBits) const;
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties MemoryProperties;
+    GpuAllocator* Allocator = nullptr;
+    GpuProfiler* Profiler = nullptr;
+    u32 FramesInFlight = 1;
+    u64 Frame = 0;
+
+    std::vector<Resource> Resources;
+    std::vector<Pass> Passes;
+    u32 PassCount = 0;
+    RenderGraphStats Stats{};
+
+    std::vector<TransientKey> TransientKeys;
+    std::vector<RenderGraphResource> TransientScratch;
+    std::vector<TransientKey> KeyScratch;
+    std::vector<TransientImage> TransientImages;
+    std::vector<MemoryBucket> Buckets;
+    std::vector<RetiredTransients> Retired;
+    VkDeviceSize TransientBytes = 0;
+    VkDeviceSize AllocatedBytes = 0;
+
+    std::vector<RenderPassEntry> RenderPasses;
+    std::vector<FramebufferEntry> Framebuffers;
+
+    std::vector<VkImageMemoryBarrier> ImageBarriers;
+    std::vector<VkBufferMemoryBarrier> BufferBarriers;
+};
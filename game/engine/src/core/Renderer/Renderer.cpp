@@ -1,26 +1,47 @@
 #include "Renderer.h"
 #include "core/Logger/Logger.h"
+#include "core/Memory/AllocationHook.h"
 #include "core/Window/Window.h"
 #include "defines.h"
 #include "VulkanTypes.h"
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <string>
+#if EM_PLATFORM_WINDOWS
 #include <vulkan/vulkan_win32.h>
+#endif
 #include <algorithm>
+#include <cfloat>
 #include <set>
 #include <fstream>
 #include <core/Math/Vertex.h>
 #include "UniformBuffer.h"
+#include "SpriteBatch.h"
 #define GLM_FORCE_RADIANS
 #include <vendor/glm/glm/glm.hpp>
 #include <vendor/glm/glm/gtc/matrix_transform.hpp>
 #include <chrono>
+#include <thread>
 #define GLFW_INCLUDE_VULKAN
 #include <vendor/GLFW/glfw3.h>
 
 static VulkanContext VulkanContext;
-const int MAX_FRAMES_IN_FLIGHT = 2;
+// Per-frame resources are created for the deepest latency mode; the current
+// mode only cycles through the first FramesInFlight of them.
+const int MAX_FRAMES_IN_FLIGHT = 3;
+
+struct LatencyProfile {
+    u32 FramesInFlight;
+    VkPresentModeKHR PresentModes[3];   // in order of preference, FIFO is always available
+};
+
+static const LatencyProfile LATENCY_PROFILES[] = {
+    {2, {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR}},
+    {1, {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR}},
+    {3, {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_KHR}},
+};
+const VkDeviceSize STAGING_BUFFER_SIZE = 32 * 1024 * 1024;
+const char* PIPELINE_CACHE_PATH = "pipeline_cache.bin";
 
 VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
     auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
@@ -38,11 +59,12 @@ void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT
     }
 }
 
+// Empty if the file can't be opened; callers decide whether that's fatal.
 static std::vector<char> ReadFile(const std::string& filename) {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
     if (!file.is_open()) {
-        EM_FATAL("Could not open file %s", filename);
+        return {};
     }
 
     size_t fileSize = (size_t)file.tellg();
@@ -97,63 +119,238 @@ bool Renderer::Initialize(const char* name, Window* window) {
     bool hasDevice = PickPhysicalDevice();
     CreateLogicalDevice();
     CreateSwapChain(&window->State);
+    CreateRenderResources();
+
+    return instance && surface && hasDevice;
+}
+
+bool Renderer::InitializeHeadless(const char* name, u32 width, u32 height) {
+    Headless = true;
+    MainWindow = nullptr;
+
+    bool instance = CreateVulkanInstance();
+    if (!instance) {
+        return false;
+    }
+
+    if (!EnableValidationLayers) {
+        CreateDebugger();
+    }
+    bool hasDevice = PickPhysicalDevice();
+    if (!hasDevice) {
+        return false;
+    }
+
+    CreateLogicalDevice();
+    CreateOffscreenTargets(width, height);
+    CreateRenderResources();
+
+    EM_INFO("Headless renderer initialized (%ux%u)", width, height);
+
+    return true;
+}
+
+void Renderer::CreateRenderResources() {
+    FramesInFlight = LATENCY_PROFILES[Latency].FramesInFlight;
+    InputSampleTimes.assign(MAX_FRAMES_IN_FLIGHT, std::chrono::steady_clock::time_point());
+
     CreateImageViews();
     CreateRenderPass();
     CreateDescriptorSetLayout();
-    CreateGraphicsPipeline();
-    CreateFrameBuffers();
+    CreateTextureTable();
+
+    VulkanContext.PipelineCache.Load(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.VulkanDevice.Properties, PIPELINE_CACHE_PATH);
+
+    auto pipelinesStart = std::chrono::high_resolution_clock::now();
+    CreatePipelineLayout();
+    CreatePipelines();
+    f64 pipelinesMs = std::chrono::duration<f64, std::milli>(std::chrono::high_resolution_clock::now() - pipelinesStart).count();
+    EM_INFO("Pipelines created in %.2f ms (%s cache)", pipelinesMs, VulkanContext.PipelineCache.Warm ? "warm" : "cold");
+
+    CreateRenderGraph();
     CreateCommandPool();
+    CreateRecordThreads();
+    CreateUploadQueue();
     CreateVertexBuffer();
     CreateIndexBuffer();
+    CreateTileIndexBuffer();
+
+    u32 white = 0xffffffff;
+    CreateTexture(&white, 1, 1);
     CreateUniformBuffers();
-    CreateDescriptorPool();
+    CreateFrameArena();
+    CreateObjectBuffers();
+    CreateCulling();
+    CreateDescriptorAllocator();
     CreateDescriptorSets();
     CreateCommandBuffer();
     CreateSyncObjects();
+    CreateProfiler();
 
-    return instance && surface && hasDevice;
+    VulkanContext.Uploads.Flush();
+
+    if (!CustomCamera) {
+        ResetCamera();
+    }
 }
 
 void Renderer::Draw() {
     vkWaitForFences(VulkanContext.VulkanDevice.LogicalDevice, 1, &VulkanContext.InFlightFences[CurrentFrame], VK_TRUE, UINT64_MAX);
 
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChain, UINT64_MAX, VulkanContext.ImageAvailableSemaphores[CurrentFrame], VK_NULL_HANDLE, &imageIndex);
+    auto frameDone = std::chrono::steady_clock::now();
+    LastFrameStats.InputLatencyValid = InputSampleTimes[CurrentFrame] != std::chrono::steady_clock::time_point();
+    if (LastFrameStats.InputLatencyValid) {
+        LastFrameStats.InputLatencyMs = std::chrono::duration<f64, std::milli>(frameDone - InputSampleTimes[CurrentFrame]).count();
+        InputSampleTimes[CurrentFrame] = std::chrono::steady_clock::time_point();
+    }
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        RecreateSwapChain();
-        return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-        EM_FATAL("failed to acquire swap chain image!");
+    LastFrameStats.PacingMs = Pacer.Wait();
+
+    ResolveGpuProfile(CurrentFrame);
+
+    VulkanContext.Textures.CollectGarbage(FrameNumber, MAX_FRAMES_IN_FLIGHT, VulkanContext.MemoryAllocator);
+    DestroyRetiredBuffers(false);
+    VulkanContext.Descriptors.BeginFrame(CurrentFrame);
+    VulkanContext.Arena.BeginFrame(CurrentFrame);
+
+    if (!Headless) {
+        DestroyRetiredSwapChains(false);
+
+        if (SwapChainSuspended) {
+            RecreateSwapChain();
+        }
+        if (SwapChainSuspended) {
+            Sprites.Clear();
+            Objects.clear();
+            return;
+        }
+    }
+
+    // Headless targets are owned by the frame slot, so there is nothing to acquire.
+    uint32_t imageIndex = CurrentFrame;
+    VkResult result = VK_SUCCESS;
+
+    if (!Headless) {
+        result = vkAcquireNextImageKHR(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChain, UINT64_MAX, VulkanContext.ImageAvailableSemaphores[CurrentFrame], VK_NULL_HANDLE, &imageIndex);
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            Sprites.Clear();
+            Objects.clear();
+            RecreateSwapChain();
+            return;
+        } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            EM_FATAL("failed to acquire swap chain image!");
+        }
     }
 
+    if (LateUpdate) {
+        LateUpdate();
+    }
+    InputSampleTimes[CurrentFrame] = std::chrono::steady_clock::now();
+
     UpdateUniformBuffer(CurrentFrame);
 
+    auto prepareStart = std::chrono::high_resolution_clock::now();
+
+    // Queues the copies of rebuilt chunks, so it goes before the flush.
+    UpdateTileChunks();
+
+    // Submit whatever was queued since last frame; this frame's submit waits for it on the GPU.
+    VulkanContext.Uploads.Flush();
+    VulkanContext.Uploads.RetireCompleted();
+
+    u32 spriteCapacity = std::min(Sprites.GetSubmittedCount(), MAX_SPRITES_PER_FRAME);
+    FrameAllocation spriteInstances = VulkanContext.Arena.Allocate(spriteCapacity * sizeof(SpriteInstance));
+    if (spriteInstances.Mapped != nullptr) {
+        SpriteInstanceCount = Sprites.Flush((SpriteInstance*)spriteInstances.Mapped, spriteCapacity);
+        SpriteInstanceOffset = spriteInstances.Offset;
+    } else {
+        Sprites.Clear();
+        SpriteInstanceCount = 0;
+    }
+
+    ObjectCount = static_cast<u32>(std::min<size_t>(Objects.size(), MAX_OBJECTS_PER_FRAME));
+    if (Objects.size() > MAX_OBJECTS_PER_FRAME) {
+        EM_WARN("Object buffer overflow, dropped %u objects", (u32)(Objects.size() - MAX_OBJECTS_PER_FRAME));
+    }
+    memcpy(VulkanContext.ObjectBuffersMapped[CurrentFrame], Objects.data(), ObjectCount * sizeof(ObjectData));
+
+    Cull.ObjectCount = ObjectCount;
+    Cull.IndexCount = static_cast<u32>(Indices.size());
+    GpuCulling::ExtractFrustumPlanes(CameraProjection * CameraView, Cull.Planes);
+
+    if (!GpuCullingEnabled) {
+        VkDrawIndexedIndirectCommand* commands = (VkDrawIndexedIndirectCommand*)VulkanContext.DrawCommandBuffersAllocation[CurrentFrame].Mapped;
+        VisibleObjectCount = GpuCulling::CullOnCpu(Cull, Objects.data(), commands);
+    }
+    Objects.clear();
+
     vkResetFences(VulkanContext.VulkanDevice.LogicalDevice, 1, &VulkanContext.InFlightFences[CurrentFrame]);
 
+    auto recordStart = std::chrono::high_resolution_clock::now();
+
     vkResetCommandBuffer(VulkanContext.CommandBuffers[CurrentFrame], 0);
 
     RecordCommandBuffer(VulkanContext.CommandBuffers[CurrentFrame], imageIndex);
 
+    auto recordEnd = std::chrono::high_resolution_clock::now();
+
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = {VulkanContext.ImageAvailableSemaphores[CurrentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    VkSemaphore waitSemaphores[2];
+    VkPipelineStageFlags waitStages[2];
+    uint64_t waitValues[2] = {0, 0};
+    u32 waitCount = 0;
+
+    if (!Headless) {
+        waitSemaphores[waitCount] = VulkanContext.ImageAvailableSemaphores[CurrentFrame];
+        waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        waitCount++;
+    }
+
+    VkSemaphore uploadSemaphore;
+    u64 uploadValue;
+    bool waitUploads = VulkanContext.Uploads.TakeGraphicsWait(uploadSemaphore, uploadValue);
+    if (waitUploads) {
+        waitSemaphores[waitCount] = uploadSemaphore;
+        waitStages[waitCount] = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        waitValues[waitCount] = uploadValue;
+        waitCount++;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+
+    submitInfo.pNext = waitUploads ? &timelineInfo : nullptr;
+    submitInfo.waitSemaphoreCount = waitCount;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &VulkanContext.CommandBuffers[CurrentFrame];
 
     VkSemaphore signalSemaphores[] = {VulkanContext.RenderFinishedSemaphores[CurrentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = Headless ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     if (vkQueueSubmit(VulkanContext.GraphicsQueue, 1, &submitInfo, VulkanContext.InFlightFences[CurrentFrame]) != VK_SUCCESS) {
         EM_FATAL("COULD NOT DRAW FRAME!");
     }
 
+    auto submitEnd = std::chrono::high_resolution_clock::now();
+
+    LastFrameStats.CpuPrepareMs = std::chrono::duration<f64, std::milli>(recordStart - prepareStart).count();
+    LastFrameStats.CpuRecordMs = std::chrono::duration<f64, std::milli>(recordEnd - recordStart).count();
+    LastFrameStats.CpuSubmitMs = std::chrono::duration<f64, std::milli>(submitEnd - recordEnd).count();
+
+    if (Headless) {
+        CurrentFrame = (CurrentFrame + 1) % FramesInFlight;
+        FrameNumber++;
+        return;
+    }
+
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -172,7 +369,8 @@ void Renderer::Draw() {
         EM_FATAL("failed to present swap chain image!");
     }
 
-    CurrentFrame = (CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    CurrentFrame = (CurrentFrame + 1) % FramesInFlight;
+    FrameNumber++;
 }
 
 bool Renderer::CreateVulkanInstance() {
@@ -185,8 +383,20 @@ bool Renderer::CreateVulkanInstance() {
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
 
     std::vector<const char*> enabledInstanceExtensions;
-    enabledInstanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
-    enabledInstanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+    if (!Headless) {
+        enabledInstanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#if EM_PLATFORM_WINDOWS
+        enabledInstanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#else
+        u32 glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        for (u32 i = 0; i < glfwExtensionCount; i++) {
+            if (strcmp(glfwExtensions[i], VK_KHR_SURFACE_EXTENSION_NAME) != 0) {
+                enabledInstanceExtensions.push_back(glfwExtensions[i]);
+            }
+        }
+#endif
+    }
 
 #if defined(_DEBUG)
     enabledInstanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -196,8 +406,11 @@ bool Renderer::CreateVulkanInstance() {
     createInfo.pApplicationInfo = &appInfo;
     createInfo.enabledExtensionCount = (u32)enabledInstanceExtensions.size();
     createInfo.ppEnabledExtensionNames = enabledInstanceExtensions.data();
-    createInfo.enabledLayerCount = static_cast<u32>(ValidationLayers.size());
-    createInfo.ppEnabledLayerNames = ValidationLayers.data();
+    // Build boxes running a software driver usually don't ship the validation layers.
+    if (!Headless || CheckValidationLayerSupport()) {
+        createInfo.enabledLayerCount = static_cast<u32>(ValidationLayers.size());
+        createInfo.ppEnabledLayerNames = ValidationLayers.data();
+    }
 
     VkResult result = vkCreateInstance(&createInfo, VulkanContext.Allocator, &VulkanContext.Instance);
 
@@ -212,12 +425,16 @@ bool Renderer::CreateVulkanInstance() {
 }
 
 bool Renderer::CreateVulkanSurface(WindowState* state) {
+#if EM_PLATFORM_WINDOWS
     VkWin32SurfaceCreateInfoKHR surface_info = {VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
     surface_info.pNext = NULL;
     surface_info.hinstance = state->GetWindow();
     surface_info.hwnd = state->GetHWND();
 
     VkResult result = vkCreateWin32SurfaceKHR(VulkanContext.Instance, &surface_info, NULL, &state->Surface);
+#else
+    VkResult result = glfwCreateWindowSurface(VulkanContext.Instance, state->GlfwWindow, NULL, &state->Surface);
+#endif
 
     if (result != VK_SUCCESS) {
         EM_FATAL("Vulkan surface creation failed. %e", result);
@@ -265,6 +482,11 @@ void Renderer::CreateLogicalDevice() {
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<u32> uniqueQueueFamilies = {indices.GraphicsFamily.value(), indices.PresentFamily.value()};
 
+    bool useTransferFamily = UseTransferQueue && indices.TransferFamily.has_value();
+    if (useTransferFamily) {
+        uniqueQueueFamilies.insert(indices.TransferFamily.value());
+    }
+
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo{};
@@ -275,12 +497,24 @@ void Renderer::CreateLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // Only turn on the 1.2 features the renderer actually uses.
+    VkPhysicalDeviceVulkan12Features enabledFeatures12{};
+    enabledFeatures12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledFeatures12.timelineSemaphore = VulkanContext.VulkanDevice.Features12.timelineSemaphore;
+    enabledFeatures12.drawIndirectCount = VulkanContext.VulkanDevice.Features12.drawIndirectCount;
+    enabledFeatures12.runtimeDescriptorArray = VK_TRUE;
+    enabledFeatures12.descriptorBindingPartiallyBound = VK_TRUE;
+    enabledFeatures12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    enabledFeatures12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    enabledFeatures12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &enabledFeatures12;
     createInfo.queueCreateInfoCount = static_cast<u32>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &VulkanContext.VulkanDevice.Features;
-    createInfo.enabledExtensionCount = static_cast<u32>(DeviceExtensions.size());
+    createInfo.enabledExtensionCount = Headless ? 0 : static_cast<u32>(DeviceExtensions.size());
     createInfo.ppEnabledExtensionNames = DeviceExtensions.data();
 
     if (EnableValidationLayers) {
@@ -298,13 +532,19 @@ void Renderer::CreateLogicalDevice() {
 
     vkGetDeviceQueue(VulkanContext.VulkanDevice.LogicalDevice, indices.GraphicsFamily.value(), 0, &VulkanContext.GraphicsQueue);
     vkGetDeviceQueue(VulkanContext.VulkanDevice.LogicalDevice, indices.PresentFamily.value(), 0, &VulkanContext.PresentQueue);
+
+    VulkanContext.GraphicsFamily = indices.GraphicsFamily.value();
+    VulkanContext.TransferFamily = useTransferFamily ? indices.TransferFamily.value() : VulkanContext.GraphicsFamily;
+    vkGetDeviceQueue(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.TransferFamily, 0, &VulkanContext.TransferQueue);
+
+    VulkanContext.MemoryAllocator.Initialize(VulkanContext.VulkanDevice.PhysicalDevice, VulkanContext.VulkanDevice.LogicalDevice);
 }
 
 void Renderer::CreateSwapChain(WindowState* state) {
     SwapChainSupport swapChainSupport = QuerySwapChainSupport(VulkanContext.VulkanDevice.PhysicalDevice);
 
-    VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.Formats);
-    VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.PresentModes);
+    VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport);
+    VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport);
     VkExtent2D extent = ChooseSwapExtent(swapChainSupport.Capabilities, state);
 
     VkSurfaceTransformFlagBitsKHR pre_transform;
@@ -331,7 +571,8 @@ void Renderer::CreateSwapChain(WindowState* state) {
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // Hand over from the current swapchain, which the caller retires.
+    createInfo.oldSwapchain = VulkanContext.SwapChain;
     createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
     VkResult result = vkCreateSwapchainKHR(VulkanContext.VulkanDevice.LogicalDevice, &createInfo, nullptr, &VulkanContext.SwapChain);
@@ -350,32 +591,115 @@ void Renderer::CreateSwapChain(WindowState* state) {
     EM_INFO("created surface");
 }
 
+void Renderer::CreateOffscreenTargets(u32 width, u32 height) {
+    VulkanContext.SwapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    VulkanContext.SwapChainExtent = {width, height};
+    VulkanContext.SwapChainImages.resize(MAX_FRAMES_IN_FLIGHT);
+    VulkanContext.OffscreenImagesAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = VulkanContext.SwapChainImageFormat;
+        imageInfo.extent = {width, height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(VulkanContext.VulkanDevice.LogicalDevice, &imageInfo, nullptr, &VulkanContext.SwapChainImages[i]) != VK_SUCCESS) {
+            EM_FATAL("Could not create offscreen image");
+            continue;
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChainImages[i], &memRequirements);
+
+        u32 memoryType = FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        GpuAllocation& allocation = VulkanContext.OffscreenImagesAllocation[i];
+
+        if (!VulkanContext.MemoryAllocator.Allocate(memRequirements, memoryType, allocation)) {
+            EM_FATAL("Could not allocate offscreen image memory");
+            continue;
+        }
+
+        vkBindImageMemory(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChainImages[i], allocation.Memory, allocation.Offset);
+    }
+
+    EM_INFO("created offscreen targets");
+}
+
+// Builds the new swapchain from the old one and keeps rendering. The old
+// swapchain and its views stay alive until the frames that used them have
+// completed, so a resize never waits for the device.
 void Renderer::RecreateSwapChain() {
+    // A resize is an event, not steady state.
+    ScopedAllocationAllowance allowance;
+
+    FramebufferResized = false;
+
+    // Minimized: no swapchain can have a zero extent, so Draw skips frames
+    // until the window has a size again.
     int width = 0, height = 0;
     glfwGetFramebufferSize(MainWindow->State.GlfwWindow, &width, &height);
-    while (width == 0 || height == 0) {
-        glfwGetFramebufferSize(MainWindow->State.GlfwWindow, &width, &height);
-        glfwWaitEvents();
+    SwapChainSuspended = width == 0 || height == 0;
+    if (SwapChainSuspended) {
+        return;
     }
 
-    vkDeviceWaitIdle(VulkanContext.VulkanDevice.LogicalDevice);
-
-    CleanSwapChain();
+    RetiredSwapChain retired;
+    retired.SwapChain = VulkanContext.SwapChain;
+    retired.ImageViews = VulkanContext.SwapChainImageViews;
+    retired.Frame = FrameNumber;
+    VulkanContext.RetiredSwapChains.push_back(retired);
 
     CreateSwapChain(&MainWindow->State);
     CreateImageViews();
-    CreateFrameBuffers();
+
+    if (!CustomCamera) {
+        ResetCamera();
+    }
 }
 
-void Renderer::CleanSwapChain() {
-    for (size_t i = 0; i < VulkanContext.Framebuffers.size(); i++) {
-        vkDestroyFramebuffer(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.Framebuffers[i], nullptr);
+void Renderer::DestroyRetiredSwapChains(bool all) {
+    std::vector<RetiredSwapChain>& retired = VulkanContext.RetiredSwapChains;
+
+    for (size_t i = 0; i < retired.size();) {
+        if (!all && retired[i].Frame + FramesInFlight > FrameNumber) {
+            i++;
+            continue;
+        }
+
+        for (VkImageView view : retired[i].ImageViews) {
+            VulkanContext.Graph.ReleaseImageView(view);
+            vkDestroyImageView(VulkanContext.VulkanDevice.LogicalDevice, view, nullptr);
+        }
+        vkDestroySwapchainKHR(VulkanContext.VulkanDevice.LogicalDevice, retired[i].SwapChain, nullptr);
+
+        retired[i] = retired.back();
+        retired.pop_back();
     }
+}
+
+void Renderer::CleanSwapChain() {
+    VulkanContext.Graph.ReleaseFramebuffers();
+    DestroyRetiredSwapChains(true);
 
     for (size_t i = 0; i < VulkanContext.SwapChainImageViews.size(); i++) {
         vkDestroyImageView(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChainImageViews[i], nullptr);
     }
 
+    if (Headless) {
+        for (size_t i = 0; i < VulkanContext.SwapChainImages.size(); i++) {
+            vkDestroyImage(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChainImages[i], nullptr);
+            VulkanContext.MemoryAllocator.Free(VulkanContext.OffscreenImagesAllocation[i]);
+        }
+        return;
+    }
+
     vkDestroySwapchainKHR(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.SwapChain, nullptr);
 }
 
@@ -385,22 +709,38 @@ bool Renderer::IsDeviceCompatible(VkPhysicalDevice device) {
     vkGetPhysicalDeviceProperties(device, &deviceProperties);
     vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
 
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &features12;
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+
     QueueFamilyIndices indices = FindQueueFamilies(device);
 
     if (indices.IsComplete()) {
         VulkanContext.VulkanDevice.Features = deviceFeatures;
+        VulkanContext.VulkanDevice.Features12 = features12;
         VulkanContext.VulkanDevice.Properties = deviceProperties;
         VulkanContext.VulkanDevice.PhysicalDevice = device;
     }
 
-    bool extensionsSupported = CheckDeviceExtensionSupport(device);
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    bool extensionsSupported = Headless || CheckDeviceExtensionSupport(device);
+    bool swapChainAdequate = Headless;
+    if (extensionsSupported && !Headless) {
         SwapChainSupport swapChainSupport = QuerySwapChainSupport(device);
-        swapChainAdequate = !swapChainSupport.Formats.empty() && !swapChainSupport.PresentModes.empty();
+        swapChainAdequate = swapChainSupport.FormatCount > 0 && swapChainSupport.PresentModeCount > 0;
     }
 
-    return indices.IsComplete() && extensionsSupported && swapChainAdequate;
+    // The bindless texture table needs descriptor indexing (core in 1.2).
+    bool bindlessSupported = features12.runtimeDescriptorArray &&
+                             features12.descriptorBindingPartiallyBound &&
+                             features12.descriptorBindingSampledImageUpdateAfterBind &&
+                             features12.descriptorBindingUpdateUnusedWhilePending &&
+                             features12.shaderSampledImageArrayNonUniformIndexing;
+
+    return indices.IsComplete() && extensionsSupported && swapChainAdequate && bindlessSupported;
 }
 
 bool Renderer::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -430,18 +770,22 @@ QueueFamilyIndices Renderer::FindQueueFamilies(VkPhysicalDevice device) {
 
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-            VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, VulkanContext.Surface, &presentSupport);
+        // A transfer-only family maps to the DMA engines and lets uploads overlap rendering.
+        if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+            indices.TransferFamily = i;
+        }
+
+        if (!indices.IsComplete() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+            VkBool32 presentSupport = Headless;
+            if (!Headless) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, VulkanContext.Surface, &presentSupport);
+            }
             if (presentSupport) {
                 indices.PresentFamily = i;
             }
             indices.GraphicsFamily = i;
         }
 
-        if (indices.IsComplete())
-            break;
-
         i++;
     }
 
@@ -488,49 +832,72 @@ void Renderer::CreateDebugger() {
     }
 }
 
+// Anything past the array sizes is dropped (VK_INCOMPLETE); drivers report
+// a handful of each.
 SwapChainSupport Renderer::QuerySwapChainSupport(VkPhysicalDevice device) {
     SwapChainSupport details;
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, VulkanContext.Surface, &details.Capabilities);
 
-    u32 formatCount;
-    vkGetPhysicalDeviceSurfaceFormatsKHR(device, VulkanContext.Surface, &formatCount, nullptr);
-
-    if (formatCount != 0) {
-        details.Formats.resize(formatCount);
-        vkGetPhysicalDeviceSurfaceFormatsKHR(device, VulkanContext.Surface, &formatCount, details.Formats.data());
-    }
-
-    u32 presentModeCount;
-    vkGetPhysicalDeviceSurfacePresentModesKHR(device, VulkanContext.Surface, &presentModeCount, nullptr);
+    details.FormatCount = MAX_SURFACE_FORMATS;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(device, VulkanContext.Surface, &details.FormatCount, details.Formats);
 
-    if (presentModeCount != 0) {
-        details.PresentModes.resize(presentModeCount);
-        vkGetPhysicalDeviceSurfacePresentModesKHR(device, VulkanContext.Surface, &presentModeCount, details.PresentModes.data());
-    }
+    details.PresentModeCount = MAX_PRESENT_MODES;
+    vkGetPhysicalDeviceSurfacePresentModesKHR(device, VulkanContext.Surface, &details.PresentModeCount, details.PresentModes);
 
     return details;
 }
 
-VkSurfaceFormatKHR Renderer::ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
-    for (const auto& availableFormat : availableFormats) {
+VkSurfaceFormatKHR Renderer::ChooseSwapSurfaceFormat(const SwapChainSupport& support) {
+    for (u32 i = 0; i < support.FormatCount; i++) {
+        const VkSurfaceFormatKHR& availableFormat = support.Formats[i];
         if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB && availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
             return availableFormat;
         }
     }
 
-    return availableFormats[0];
+    return support.Formats[0];
 }
 
-VkPresentModeKHR Renderer::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-    for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            return availablePresentMode;
+VkPresentModeKHR Renderer::ChooseSwapPresentMode(const SwapChainSupport& support) {
+    const LatencyProfile& profile = LATENCY_PROFILES[Latency];
+    const VkPresentModeKHR* available = support.PresentModes;
+
+    for (VkPresentModeKHR preferred : profile.PresentModes) {
+        if (std::find(available, available + support.PresentModeCount, preferred) != available + support.PresentModeCount) {
+            return preferred;
         }
     }
 
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+void Renderer::SetLatencyMode(LatencyMode mode) {
+    // Before Initialize there is nothing to rebuild yet.
+    if (VulkanContext.VulkanDevice.LogicalDevice == VK_NULL_HANDLE) {
+        Latency = mode;
+        return;
+    }
+
+    vkDeviceWaitIdle(VulkanContext.VulkanDevice.LogicalDevice);
+
+    bool presentModeChanged = memcmp(LATENCY_PROFILES[mode].PresentModes, LATENCY_PROFILES[Latency].PresentModes, sizeof(LATENCY_PROFILES[mode].PresentModes)) != 0;
+
+    Latency = mode;
+    FramesInFlight = LATENCY_PROFILES[mode].FramesInFlight;
+    CurrentFrame = 0;
+    InputSampleTimes.assign(MAX_FRAMES_IN_FLIGHT, std::chrono::steady_clock::time_point());
+
+    if (!Headless && presentModeChanged) {
+        RecreateSwapChain();
+    }
+
+    EM_INFO("Latency mode %u: %u frames in flight", (u32)mode, FramesInFlight);
+}
+
+void Renderer::SetFrameRateLimit(f64 framesPerSecond) {
+    Pacer.SetTargetFrameRate(framesPerSecond);
+}
+
 VkExtent2D Renderer::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities, WindowState* state) {
     if (surfaceCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
         return surfaceCapabilities.currentExtent;
@@ -577,6 +944,9 @@ void Renderer::CreateImageViews() {
     }
 }
 
+// Frames are recorded through the render graph, which creates its own render
+// passes. This one only has to be compatible with the graph's backbuffer pass
+// for pipeline creation: same attachment format, no subpass dependencies.
 void Renderer::CreateRenderPass() {
     VkAttachmentDescription colorAttachment{};
     colorAttachment.format = VulkanContext.SwapChainImageFormat;
@@ -585,8 +955,8 @@ void Renderer::CreateRenderPass() {
     colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -597,22 +967,12 @@ void Renderer::CreateRenderPass() {
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
 
-    VkSubpassDependency dependency{};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
-    dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.srcAccessMask = 0;
-    dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &colorAttachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
 
     if (vkCreateRenderPass(VulkanContext.VulkanDevice.LogicalDevice, &renderPassInfo, nullptr, &VulkanContext.RenderPass) != VK_SUCCESS) {
         EM_FATAL("Could not create render pass!");
@@ -621,146 +981,73 @@ void Renderer::CreateRenderPass() {
     }
 }
 
-void Renderer::CreateGraphicsPipeline() {
-
-    const std::vector<char>& vertShaderCode = ReadFile("src/shaders/VertShader.spv");
-    const std::vector<char>& fragShaderCode = ReadFile("src/shaders/FragShader.spv");
-
-    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
-
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-
-    auto bindingDescription = Vertex::GetBindingDescription();
-    auto attributeDescriptions = Vertex::GetAttributeDescriptions();
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    std::vector<VkDynamicState> dynamicStates = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR};
-
-    VkPipelineDynamicStateCreateInfo dynamicState{};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
-
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (f32)VulkanContext.SwapChainExtent.width;
-    viewport.height = (f32)VulkanContext.SwapChainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = VulkanContext.SwapChainExtent;
-
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
-    viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
-
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-    multisampling.minSampleShading = 1.0f;           // Optional
-    multisampling.pSampleMask = nullptr;             // Optional
-    multisampling.alphaToCoverageEnable = VK_FALSE;  // Optional
-    multisampling.alphaToOneEnable = VK_FALSE;       // Optional
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_TRUE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = VK_LOGIC_OP_COPY;  // Optional
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;  // Optional
-    colorBlending.blendConstants[1] = 0.0f;  // Optional
-    colorBlending.blendConstants[2] = 0.0f;  // Optional
-    colorBlending.blendConstants[3] = 0.0f;  // Optional
-
+void Renderer::CreatePipelineLayout() {
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;             
-    pipelineLayoutInfo.pSetLayouts = &VulkanContext.DescriptorSetLayout;          
+    // Set 0 is per-frame data, set 1 the bindless texture table.
+    VkDescriptorSetLayout setLayouts[] = {VulkanContext.DescriptorSetLayout, VulkanContext.Textures.Layout};
+    pipelineLayoutInfo.setLayoutCount = 2;
+    pipelineLayoutInfo.pSetLayouts = setLayouts;
+
+    // Per-draw constants, only the tile shaders read them.
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(TileChunkConstants);
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
     if (vkCreatePipelineLayout(VulkanContext.VulkanDevice.LogicalDevice, &pipelineLayoutInfo, nullptr, &VulkanContext.PipelineLayout) != VK_SUCCESS) {
         EM_FATAL("Could not create pipeline!");
     } else {
         EM_INFO("CREATED pipeline");
     }
+}
 
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = VulkanContext.PipelineLayout;
-    pipelineInfo.renderPass = VulkanContext.RenderPass;
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; 
-
-    if (vkCreateGraphicsPipelines(VulkanContext.VulkanDevice.LogicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &VulkanContext.GraphicsPipeline) != VK_SUCCESS) {
+// Queues every pipeline variant on the library's workers and waits only for
+// the ones the others fall back to; variants finish in the background.
+void Renderer::CreatePipelines() {
+    u32 threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    VulkanContext.Pipelines.Initialize(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.PipelineCache.Handle, VulkanContext.PipelineLayout, VulkanContext.RenderPass, threadCount);
+
+    PipelineDesc objectDesc{};
+    objectDesc.VertexShader = "src/shaders/VertShader.spv";
+    objectDesc.FragmentShader = "src/shaders/FragShader.spv";
+    objectDesc.VertexLayout = PIPELINE_VERTEX_QUAD;
+    objectDesc.Blend = PIPELINE_BLEND_ALPHA;
+    objectDesc.CullMode = VK_CULL_MODE_BACK_BIT;
+    ObjectPipeline = VulkanContext.Pipelines.Request(objectDesc);
+
+    // No culling so sprites can be mirrored with a negative size.
+    PipelineDesc spriteDesc{};
+    spriteDesc.VertexShader = "src/shaders/SpriteVert.spv";
+    spriteDesc.FragmentShader = "src/shaders/SpriteFrag.spv";
+    spriteDesc.VertexLayout = PIPELINE_VERTEX_SPRITE;
+    spriteDesc.Blend = PIPELINE_BLEND_ALPHA;
+    spriteDesc.CullMode = VK_CULL_MODE_NONE;
+    SpritePipelines[SPRITE_BLEND_ALPHA] = VulkanContext.Pipelines.Request(spriteDesc);
+
+    spriteDesc.Blend = PIPELINE_BLEND_ADDITIVE;
+    SpritePipelines[SPRITE_BLEND_ADDITIVE] = VulkanContext.Pipelines.Request(spriteDesc, SpritePipelines[SPRITE_BLEND_ALPHA]);
+
+    // SpriteFrag's ALPHA_CUTOFF.
+    f32 cutoff = 0.5f;
+    spriteDesc.Blend = PIPELINE_BLEND_OPAQUE;
+    spriteDesc.SpecializationCount = 1;
+    memcpy(&spriteDesc.Specialization[0], &cutoff, sizeof(cutoff));
+    SpritePipelines[SPRITE_BLEND_CUTOUT] = VulkanContext.Pipelines.Request(spriteDesc, SpritePipelines[SPRITE_BLEND_ALPHA]);
+
+    PipelineDesc tileDesc{};
+    tileDesc.VertexShader = "src/shaders/TileVert.spv";
+    tileDesc.FragmentShader = "src/shaders/TileFrag.spv";
+    tileDesc.VertexLayout = PIPELINE_VERTEX_TILE;
+    tileDesc.Blend = PIPELINE_BLEND_ALPHA;
+    tileDesc.CullMode = VK_CULL_MODE_NONE;
+    TilePipeline = VulkanContext.Pipelines.Request(tileDesc);
+
+    if (!VulkanContext.Pipelines.Wait(ObjectPipeline) || !VulkanContext.Pipelines.Wait(SpritePipelines[SPRITE_BLEND_ALPHA])) {
         EM_FATAL("failed to create graphics pipeline!");
-    } else {
-        EM_INFO("CREATED Graphics pipeline");
     }
-
-    vkDestroyShaderModule(VulkanContext.VulkanDevice.LogicalDevice, fragShaderModule, nullptr);
-    vkDestroyShaderModule(VulkanContext.VulkanDevice.LogicalDevice, vertShaderModule, nullptr);
 }
 
 VkShaderModule Renderer::CreateShaderModule(const std::vector<char>& code) {
@@ -768,7 +1055,6 @@ VkShaderModule Renderer::CreateShaderModule(const std::vector<char>& code) {
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     createInfo.codeSize = code.size();
     createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-    EM_INFO("%s", code.data());
     VkShaderModule shaderModule;
     if (vkCreateShaderModule(VulkanContext.VulkanDevice.LogicalDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
         EM_FATAL("Could not create shader module");
@@ -777,25 +1063,11 @@ VkShaderModule Renderer::CreateShaderModule(const std::vector<char>& code) {
     return shaderModule;
 }
 
-void Renderer::CreateFrameBuffers() {
-    VulkanContext.Framebuffers.resize(VulkanContext.SwapChainImageViews.size());
-
-    for (size_t i = 0; i < VulkanContext.SwapChainImageViews.size(); i++) {
-        VkImageView attachments[]{VulkanContext.SwapChainImageViews[i]};
-
-        VkFramebufferCreateInfo createInfo{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
-        createInfo.renderPass = VulkanContext.RenderPass;
-        createInfo.attachmentCount = 1;
-        createInfo.pAttachments = attachments;
-        createInfo.width = VulkanContext.SwapChainExtent.width;
-        createInfo.height = VulkanContext.SwapChainExtent.height;
-        createInfo.layers = 1;
-
-        if (vkCreateFramebuffer(VulkanContext.VulkanDevice.LogicalDevice, &createInfo, nullptr, &VulkanContext.Framebuffers[i]) != VK_SUCCESS) {
-            EM_FATAL("Could not create framebuffer");
-        } else {
-            EM_INFO("created frame buffers");
-        }
+void Renderer::CreateRenderGraph() {
+    if (!VulkanContext.Graph.Initialize(VulkanContext.VulkanDevice.PhysicalDevice, VulkanContext.VulkanDevice.LogicalDevice, &VulkanContext.MemoryAllocator, MAX_FRAMES_IN_FLIGHT)) {
+        EM_FATAL("Could not create render graph");
+    } else {
+        EM_INFO("created render graph");
     }
 }
 
@@ -830,6 +1102,23 @@ void Renderer::CreateCommandBuffer() {
     }
 }
 
+void Renderer::CreateRecordThreads() {
+    u32 threadCount = RecordThreadCount;
+    if (threadCount == 0) {
+        threadCount = Jobs != nullptr ? Jobs->GetWorkerCount() : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    VulkanContext.Recorder.Initialize(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.GraphicsFamily, MAX_FRAMES_IN_FLIGHT, threadCount, Jobs);
+}
+
+void Renderer::SetRecordThreadCount(u32 count) {
+    vkDeviceWaitIdle(VulkanContext.VulkanDevice.LogicalDevice);
+
+    RecordThreadCount = count;
+    VulkanContext.Recorder.Shutdown();
+    CreateRecordThreads();
+}
+
 void Renderer::RecordCommandBuffer(VkCommandBuffer commandBuffer, u32 imageIndex) {
    VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -838,50 +1127,181 @@ void Renderer::RecordCommandBuffer(VkCommandBuffer commandBuffer, u32 imageIndex
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
-        VkRenderPassBeginInfo renderPassInfo{};
-        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = VulkanContext.RenderPass;
-        renderPassInfo.framebuffer = VulkanContext.Framebuffers[imageIndex];
-        renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = VulkanContext.SwapChainExtent;
+        VulkanContext.Profiler.BeginFrame(commandBuffer, CurrentFrame);
+
+        // Draw 0 is the instanced demo quads, the rest are the sprite batches.
+        u32 drawCount = 1 + static_cast<u32>(Sprites.GetBatches().size());
+
+        // Small draw lists are cheaper to record inline than to hand off to threads.
+        bool useSecondaries = VulkanContext.Recorder.GetThreadCount() > 1 && drawCount >= 2 * MinDrawsPerRecordThread;
+
+        RenderGraph& graph = VulkanContext.Graph;
+        graph.Reset();
+
+        // The backbuffer's old contents are cleared, so it enters undefined
+        // once the acquire semaphore has been waited at color output.
+        RenderGraphResource backbuffer = graph.ImportImage("Backbuffer", VulkanContext.SwapChainImages[imageIndex], VulkanContext.SwapChainImageViews[imageIndex],
+                                                           VulkanContext.SwapChainImageFormat, VulkanContext.SwapChainExtent,
+                                                           VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                           Headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+        RenderGraphResource drawCommands = RENDER_GRAPH_NONE;
+        RenderGraphResource drawCountBuffer = RENDER_GRAPH_NONE;
+
+        if (GpuCullingEnabled && ObjectCount > 0) {
+            drawCommands = graph.ImportBuffer("DrawCommands", VulkanContext.DrawCommandBuffers[CurrentFrame]);
+            drawCountBuffer = graph.ImportBuffer("DrawCount", VulkanContext.DrawCountBuffers[CurrentFrame]);
+
+            u32 cullPass = graph.AddPass("Cull", [this](VkCommandBuffer commandBuffer, const RenderGraphPassContext& context) {
+                VulkanContext.Culling.Record(commandBuffer, CurrentFrame, Cull);
+            });
+            graph.WriteBuffer(cullPass, drawCommands, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+            graph.ReadBuffer(cullPass, drawCountBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+            graph.WriteBuffer(cullPass, drawCountBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        }
+
+        u32 scenePass = graph.AddPass("Scene", [this, drawCount, useSecondaries](VkCommandBuffer commandBuffer, const RenderGraphPassContext& context) {
+            if (useSecondaries) {
+                VkCommandBufferInheritanceInfo inheritanceInfo{};
+                inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+                inheritanceInfo.renderPass = context.RenderPass;
+                inheritanceInfo.subpass = 0;
+                inheritanceInfo.framebuffer = context.Framebuffer;
+                inheritanceInfo.pipelineStatistics = VulkanContext.Profiler.GetInheritedStatistics();
+
+                CommandRecorder::RecordFunction recordDraws = [this](VkCommandBuffer secondary, u32 first, u32 count) {
+                    RecordDraws(secondary, first, count);
+                };
+
+                VkCommandBuffer secondaries[MAX_RECORD_THREADS];
+                u32 secondaryCount = VulkanContext.Recorder.Record(CurrentFrame, inheritanceInfo, drawCount, MinDrawsPerRecordThread, recordDraws, secondaries);
+
+                vkCmdExecuteCommands(commandBuffer, secondaryCount, secondaries);
+            } else {
+                RecordDraws(commandBuffer, 0, drawCount);
+            }
+        });
 
         VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-        renderPassInfo.clearValueCount = 1;
-        renderPassInfo.pClearValues = &clearColor;
+        graph.WriteColor(scenePass, backbuffer, VK_ATTACHMENT_LOAD_OP_CLEAR, clearColor);
+        graph.SetSecondaryCommandBuffers(scenePass, useSecondaries);
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        if (drawCommands != RENDER_GRAPH_NONE) {
+            graph.ReadBuffer(scenePass, drawCommands, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+            graph.ReadBuffer(scenePass, drawCountBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+        }
 
-            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanContext.GraphicsPipeline);
+        if (!graph.Compile(FrameNumber)) {
+            EM_FATAL("Could not compile render graph");
+        } else {
+            graph.Execute(commandBuffer);
+        }
 
-            VkViewport viewport{};
-            viewport.x = 0.0f;
-            viewport.y = 0.0f;
-            viewport.width = (f32) VulkanContext.SwapChainExtent.width;
-            viewport.height = (f32) VulkanContext.SwapChainExtent.height;
-            viewport.minDepth = 0.0f;
-            viewport.maxDepth = 1.0f;
-            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        VulkanContext.Profiler.EndFrame(commandBuffer);
 
-            VkRect2D scissor{};
-            scissor.offset = {0, 0};
-            scissor.extent = VulkanContext.SwapChainExtent;
-            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);            
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+}
+
+// Records draws [first, first + count) of the frame's draw list. Called from
+// record threads, so it may only read renderer state, and it binds all the
+// state it needs because secondary command buffers inherit none of it.
+void Renderer::RecordDraws(VkCommandBuffer commandBuffer, u32 first, u32 count) {
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (f32) VulkanContext.SwapChainExtent.width;
+    viewport.height = (f32) VulkanContext.SwapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = VulkanContext.SwapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    vkCmdBindIndexBuffer(commandBuffer, VulkanContext.IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+
+    VkDescriptorSet descriptorSets[] = {VulkanContext.DescriptorSets[CurrentFrame], VulkanContext.Textures.Set};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanContext.PipelineLayout, 0, 2, descriptorSets, 0, nullptr);
+
+    u32 end = first + count;
+
+    if (first == 0) {
+        // The map goes beneath everything else, one draw per chunk in view.
+        VkPipeline tilePipeline = VulkanContext.Pipelines.Get(TilePipeline);
+        if (!VisibleTileChunks.empty() && tilePipeline != VK_NULL_HANDLE) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, tilePipeline);
+            vkCmdBindIndexBuffer(commandBuffer, VulkanContext.TileIndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+
+            TileChunkConstants constants{};
+            constants.TileSize = Tiles->GetTileSize();
+            constants.Texture = Tiles->GetTexture();
+
+            VkDeviceSize offset = 0;
+            for (u32 chunk : VisibleTileChunks) {
+                const TileChunkBuffer& buffer = VulkanContext.TileChunks[chunk];
+                constants.Origin = Tiles->GetChunkOrigin(chunk);
+
+                vkCmdPushConstants(commandBuffer, VulkanContext.PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(constants), &constants);
+                vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer.Buffer, &offset);
+                vkCmdDrawIndexed(commandBuffer, buffer.QuadCount * 6, 1, 0, 0, 0);
+            }
+
+            vkCmdBindIndexBuffer(commandBuffer, VulkanContext.IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+        }
+
+        // All objects share the quad mesh: one indirect draw per visible
+        // object, whose firstInstance picks its transform from the object buffer.
+        VkPipeline objectPipeline = VulkanContext.Pipelines.Get(ObjectPipeline);
+        if (ObjectCount > 0 && objectPipeline != VK_NULL_HANDLE) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, objectPipeline);
 
             VkBuffer vertexBuffers[] = {VulkanContext.VertexBuffer};
             VkDeviceSize offsets[] = {0};
             vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
-            vkCmdBindIndexBuffer(commandBuffer, VulkanContext.IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, VulkanContext.PipelineLayout, 0, 1, &VulkanContext.DescriptorSets[CurrentFrame], 0, nullptr);
+            VkBuffer drawCommands = VulkanContext.DrawCommandBuffers[CurrentFrame];
+            u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+
+            if (GpuCullingEnabled) {
+                vkCmdDrawIndexedIndirectCount(commandBuffer, drawCommands, 0, VulkanContext.DrawCountBuffers[CurrentFrame], 0, ObjectCount, stride);
+            } else if (IndirectDrawSupported) {
+                vkCmdDrawIndexedIndirect(commandBuffer, drawCommands, 0, VisibleObjectCount, stride);
+            } else {
+                const VkDrawIndexedIndirectCommand* commands = (const VkDrawIndexedIndirectCommand*)VulkanContext.DrawCommandBuffersAllocation[CurrentFrame].Mapped;
+                for (u32 i = 0; i < VisibleObjectCount; i++) {
+                    vkCmdDrawIndexed(commandBuffer, commands[i].indexCount, 1, 0, 0, commands[i].firstInstance);
+                }
+            }
+        }
+        first = 1;
+    }
 
-            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(Indices.size()), 1, 0, 0, 0);
+    if (first < end && SpriteInstanceCount > 0) {
+        VkBuffer spriteBuffers[] = {VulkanContext.VertexBuffer, VulkanContext.ArenaBuffer};
+        VkDeviceSize spriteOffsets[] = {0, SpriteInstanceOffset};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 2, spriteBuffers, spriteOffsets);
 
-        vkCmdEndRenderPass(commandBuffer);
+        // Variants still compiling draw with the alpha pipeline.
+        VkPipeline bound = VK_NULL_HANDLE;
+        const std::vector<SpriteDrawBatch>& batches = Sprites.GetBatches();
+        for (u32 i = first; i < end; i++) {
+            const SpriteDrawBatch& batch = batches[i - 1];
 
-        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to record command buffer!");
+            VkPipeline pipeline = VulkanContext.Pipelines.Get(SpritePipelines[batch.Blend]);
+            if (pipeline == VK_NULL_HANDLE) {
+                continue;
+            }
+            if (pipeline != bound) {
+                vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                bound = pipeline;
+            }
+            vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(Indices.size()), batch.InstanceCount, 0, 0, batch.FirstInstance);
         }
+    }
 }
 
 void Renderer::CreateSyncObjects() {
@@ -905,7 +1325,35 @@ void Renderer::CreateSyncObjects() {
     }
 }
 
-void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+void Renderer::CreateProfiler() {
+    if (!VulkanContext.Profiler.Initialize(VulkanContext.VulkanDevice.PhysicalDevice, VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.GraphicsFamily, MAX_FRAMES_IN_FLIGHT)) {
+        EM_ERROR("Could not create GPU profiler");
+    }
+
+    VulkanContext.Graph.SetProfiler(&VulkanContext.Profiler);
+}
+
+void Renderer::ResolveGpuProfile(u32 frame) {
+    LastFrameStats.GpuValid = VulkanContext.Profiler.Resolve(frame) && VulkanContext.Profiler.GetFrameTime(LastFrameStats.GpuMs);
+
+    if (GpuProfilePath != nullptr && GpuProfileDumpInterval > 0 && FrameNumber > 0 && FrameNumber % GpuProfileDumpInterval == 0) {
+        VulkanContext.Profiler.Dump(GpuProfilePath);
+    }
+}
+
+const std::vector<GpuZoneStats>& Renderer::GetGpuZoneStats() {
+    return VulkanContext.Profiler.GetZoneStats();
+}
+
+bool Renderer::GetGpuPipelineStatistics(GpuPipelineStatistics& statistics) {
+    return VulkanContext.Profiler.GetPipelineStatistics(statistics);
+}
+
+bool Renderer::DumpGpuProfile(const char* path) {
+    return VulkanContext.Profiler.Dump(path);
+}
+
+void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, GpuAllocation& allocation)
 {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -913,6 +1361,15 @@ void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemor
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    // Upload destinations are written by the transfer queue and read by graphics;
+    // concurrent sharing avoids queue family ownership transfers for them.
+    u32 queueFamilies[] = {VulkanContext.GraphicsFamily, VulkanContext.TransferFamily};
+    if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && VulkanContext.GraphicsFamily != VulkanContext.TransferFamily) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = queueFamilies;
+    }
+
     if (vkCreateBuffer(VulkanContext.VulkanDevice.LogicalDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to create buffer!");
     }
@@ -920,58 +1377,163 @@ void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemor
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(VulkanContext.VulkanDevice.LogicalDevice, buffer, &memRequirements);
 
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
+    u32 memoryType = FindMemoryType(memRequirements.memoryTypeBits, properties);
 
-    if (vkAllocateMemory(VulkanContext.VulkanDevice.LogicalDevice, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+    if (!VulkanContext.MemoryAllocator.Allocate(memRequirements, memoryType, allocation)) {
         throw std::runtime_error("failed to allocate buffer memory!");
     }
 
-    vkBindBufferMemory(VulkanContext.VulkanDevice.LogicalDevice, buffer, bufferMemory, 0);
+    vkBindBufferMemory(VulkanContext.VulkanDevice.LogicalDevice, buffer, allocation.Memory, allocation.Offset);
+}
+
+void Renderer::DestroyBuffer(VkBuffer& buffer, GpuAllocation& allocation)
+{
+    vkDestroyBuffer(VulkanContext.VulkanDevice.LogicalDevice, buffer, nullptr);
+    VulkanContext.MemoryAllocator.Free(allocation);
+    buffer = VK_NULL_HANDLE;
+}
+
+RenderGraphStats Renderer::GetRenderGraphStats()
+{
+    return VulkanContext.Graph.GetStats();
+}
+
+DescriptorAllocatorStats Renderer::GetDescriptorStats()
+{
+    return VulkanContext.Descriptors.GetStats();
+}
+
+GpuAllocatorStats Renderer::GetMemoryStats()
+{
+    return VulkanContext.MemoryAllocator.GetStats();
 }
 
 void Renderer::CreateIndexBuffer()
 {
     VkDeviceSize bufferSize = sizeof(Indices[0]) * Indices.size();
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.IndexBuffer, VulkanContext.IndexBufferAllocation);
+
+    VulkanContext.Uploads.UploadBuffer(VulkanContext.IndexBuffer, 0, Indices.data(), bufferSize);
+}
 
-    void* data;
-    vkMapMemory(VulkanContext.VulkanDevice.LogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, Indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(VulkanContext.VulkanDevice.LogicalDevice, stagingBufferMemory);
+// Every chunk shares one index buffer: quad i is vertices 4i to 4i + 3.
+void Renderer::CreateTileIndexBuffer()
+{
+    std::vector<uint16_t> indices(TILE_CHUNK_MAX_QUADS * 6);
+    for (u32 quad = 0; quad < TILE_CHUNK_MAX_QUADS; quad++) {
+        for (u32 i = 0; i < 6; i++) {
+            indices[quad * 6 + i] = (uint16_t)(quad * 4 + Indices[i]);
+        }
+    }
 
-    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.IndexBuffer, VulkanContext.IndexBufferMemory);
+    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
-    CopyBuffer(stagingBuffer, VulkanContext.IndexBuffer, bufferSize);
+    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.TileIndexBuffer, VulkanContext.TileIndexBufferAllocation);
 
-    vkDestroyBuffer(VulkanContext.VulkanDevice.LogicalDevice, stagingBuffer, nullptr);
-    vkFreeMemory(VulkanContext.VulkanDevice.LogicalDevice, stagingBufferMemory, nullptr);
+    VulkanContext.Uploads.UploadBuffer(VulkanContext.TileIndexBuffer, 0, indices.data(), bufferSize);
 }
 
 void Renderer::CreateVertexBuffer() {
 
-    VkDeviceSize bufferSize = sizeof(Vertices[0]) * Vertices.size();
+    // The GPU reads the quad packed; UVs follow the sprite convention of
+    // y-up world space over top-to-bottom texture rows.
+    std::vector<PackedVertex> packedVertices;
+    for (const Vertex& vertex : Vertices) {
+        packedVertices.push_back(PackVertex(vertex, glm::vec2(vertex.pos.x + 0.5f, 0.5f - vertex.pos.y)));
+    }
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+    VkDeviceSize bufferSize = sizeof(packedVertices[0]) * packedVertices.size();
 
-    void* data;
-    vkMapMemory(VulkanContext.VulkanDevice.LogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-    memcpy(data, Vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(VulkanContext.VulkanDevice.LogicalDevice, stagingBufferMemory);
+    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.VertexBuffer, VulkanContext.VertexBufferAllocation);
 
-    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.VertexBuffer, VulkanContext.VertexBufferMemory);
+    VulkanContext.Uploads.UploadBuffer(VulkanContext.VertexBuffer, 0, packedVertices.data(), bufferSize);
+}
 
-    CopyBuffer(stagingBuffer, VulkanContext.VertexBuffer, bufferSize);
+void Renderer::CreateTextureTable() {
+    if (!VulkanContext.Textures.Initialize(VulkanContext.VulkanDevice.PhysicalDevice, VulkanContext.VulkanDevice.LogicalDevice)) {
+        EM_FATAL("failed to create bindless texture table!");
+    }
+}
+
+u32 Renderer::CreateTexture(const void* pixels, u32 width, u32 height) {
+    Texture texture{};
+    texture.Width = width;
+    texture.Height = height;
+
+    VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {width, height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // Written on the transfer queue and sampled on graphics, like upload buffers.
+    u32 queueFamilies[] = {VulkanContext.GraphicsFamily, VulkanContext.TransferFamily};
+    if (VulkanContext.GraphicsFamily != VulkanContext.TransferFamily) {
+        imageInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        imageInfo.queueFamilyIndexCount = 2;
+        imageInfo.pQueueFamilyIndices = queueFamilies;
+    }
+
+    if (vkCreateImage(VulkanContext.VulkanDevice.LogicalDevice, &imageInfo, nullptr, &texture.Image) != VK_SUCCESS) {
+        EM_ERROR("Could not create %ux%u texture", width, height);
+        return WHITE_TEXTURE;
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(VulkanContext.VulkanDevice.LogicalDevice, texture.Image, &memRequirements);
+
+    u32 memoryType = FindMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (!VulkanContext.MemoryAllocator.Allocate(memRequirements, memoryType, texture.Allocation)) {
+        EM_ERROR("Could not allocate %ux%u texture", width, height);
+        vkDestroyImage(VulkanContext.VulkanDevice.LogicalDevice, texture.Image, nullptr);
+        return WHITE_TEXTURE;
+    }
+
+    vkBindImageMemory(VulkanContext.VulkanDevice.LogicalDevice, texture.Image, texture.Allocation.Memory, texture.Allocation.Offset);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = texture.Image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if (vkCreateImageView(VulkanContext.VulkanDevice.LogicalDevice, &viewInfo, nullptr, &texture.View) != VK_SUCCESS) {
+        EM_ERROR("Could not create texture view");
+        vkDestroyImage(VulkanContext.VulkanDevice.LogicalDevice, texture.Image, nullptr);
+        VulkanContext.MemoryAllocator.Free(texture.Allocation);
+        return WHITE_TEXTURE;
+    }
+
+    VulkanContext.Uploads.UploadImage(texture.Image, width, height, 4, pixels);
+
+    return VulkanContext.Textures.Add(texture);
+}
+
+void Renderer::DestroyTexture(u32 texture) {
+    VulkanContext.Textures.Remove(texture, FrameNumber);
+}
 
-    vkDestroyBuffer(VulkanContext.VulkanDevice.LogicalDevice, stagingBuffer, nullptr);
-    vkFreeMemory(VulkanContext.VulkanDevice.LogicalDevice, stagingBufferMemory, nullptr);
+void Renderer::CreateUploadQueue() {
+    CreateBuffer(STAGING_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanContext.StagingBuffer, VulkanContext.StagingAllocation);
+
+    bool useTimeline = VulkanContext.VulkanDevice.Features12.timelineSemaphore;
+
+    if (!VulkanContext.Uploads.Initialize(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.TransferQueue, VulkanContext.TransferFamily, VulkanContext.StagingBuffer, VulkanContext.StagingAllocation.Mapped, STAGING_BUFFER_SIZE, useTimeline)) {
+        EM_FATAL("failed to create upload queue!");
+    }
 }
 
 void Renderer::CreateUniformBuffers()
@@ -979,119 +1541,281 @@ void Renderer::CreateUniformBuffers()
     VkDeviceSize bufferSize = sizeof(UniformBufferObject);
 
     VulkanContext.UniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    VulkanContext.UniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+    VulkanContext.UniformBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
     VulkanContext.UniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanContext.UniformBuffers[i], VulkanContext.UniformBuffersMemory[i]);
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanContext.UniformBuffers[i], VulkanContext.UniformBuffersAllocation[i]);
 
-        vkMapMemory(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.UniformBuffersMemory[i], 0, bufferSize, 0, &VulkanContext.UniformBuffersMapped[i]);
+        VulkanContext.UniformBuffersMapped[i] = VulkanContext.UniformBuffersAllocation[i].Mapped;
     }
 }
 
-void Renderer::UpdateUniformBuffer(u32 currentImage)
+void Renderer::CreateFrameArena()
 {
-    static auto startTime = std::chrono::high_resolution_clock::now();
+    VkDeviceSize bufferSize = FRAME_ARENA_SIZE * MAX_FRAMES_IN_FLIGHT;
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
 
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+    CreateBuffer(bufferSize, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanContext.ArenaBuffer, VulkanContext.ArenaAllocation);
 
-    UniformBufferObject ubo{};
-    ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    if (!VulkanContext.Arena.Initialize(VulkanContext.ArenaBuffer, VulkanContext.ArenaAllocation.Mapped, FRAME_ARENA_SIZE, MAX_FRAMES_IN_FLIGHT, VulkanContext.VulkanDevice.Properties.limits)) {
+        EM_FATAL("Could not create frame arena");
+    }
+}
 
-    ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+void Renderer::CreateObjectBuffers()
+{
+    VkDeviceSize bufferSize = sizeof(ObjectData) * MAX_OBJECTS_PER_FRAME;
 
-    ubo.proj = glm::perspective(glm::radians(45.0f), VulkanContext.SwapChainExtent.width / (float) VulkanContext.SwapChainExtent.height, 0.1f, 10.0f);
+    VulkanContext.ObjectBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    VulkanContext.ObjectBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+    VulkanContext.ObjectBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 
-    ubo.proj[1][1] *= -1;
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        CreateBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanContext.ObjectBuffers[i], VulkanContext.ObjectBuffersAllocation[i]);
 
-    memcpy(VulkanContext.UniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+        VulkanContext.ObjectBuffersMapped[i] = VulkanContext.ObjectBuffersAllocation[i].Mapped;
+    }
+
+    Objects.reserve(MAX_OBJECTS_PER_FRAME);
 }
 
-void Renderer::CreateDescriptorPool() {
-    
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+void Renderer::CreateCulling()
+{
+    const VkPhysicalDeviceFeatures& features = VulkanContext.VulkanDevice.Features;
+    IndirectDrawSupported = features.multiDrawIndirect && features.drawIndirectFirstInstance;
+    GpuCullingEnabled = IndirectDrawSupported && VulkanContext.VulkanDevice.Features12.drawIndirectCount;
+
+    if (GpuCullingEnabled) {
+        std::vector<char> code = ReadFile("src/shaders/Cull.spv");
+        if (code.empty()) {
+            EM_WARN("Could not open src/shaders/Cull.spv, culling on the CPU");
+        }
+        VkShaderModule shader = code.empty() ? VK_NULL_HANDLE : CreateShaderModule(code);
 
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
-    poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        GpuCullingEnabled = shader != VK_NULL_HANDLE &&
+                            VulkanContext.Culling.Initialize(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.PipelineCache.Handle, shader, MAX_FRAMES_IN_FLIGHT);
 
-    if (vkCreateDescriptorPool(VulkanContext.VulkanDevice.LogicalDevice, &poolInfo, nullptr, &VulkanContext.DescriptoPool) != VK_SUCCESS) {
-        EM_FATAL("failed to create descriptor pool!");
+        if (shader != VK_NULL_HANDLE) {
+            vkDestroyShaderModule(VulkanContext.VulkanDevice.LogicalDevice, shader, nullptr);
+        }
+        if (!GpuCullingEnabled) {
+            VulkanContext.Culling.Shutdown();
+        }
     }
+
+    VkDeviceSize commandsSize = sizeof(VkDrawIndexedIndirectCommand) * MAX_OBJECTS_PER_FRAME;
+
+    VulkanContext.DrawCommandBuffers.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    VulkanContext.DrawCommandBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+    VulkanContext.DrawCountBuffers.assign(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+    VulkanContext.DrawCountBuffersAllocation.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        if (GpuCullingEnabled) {
+            CreateBuffer(commandsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.DrawCommandBuffers[i], VulkanContext.DrawCommandBuffersAllocation[i]);
+            CreateBuffer(sizeof(u32), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VulkanContext.DrawCountBuffers[i], VulkanContext.DrawCountBuffersAllocation[i]);
+
+            VulkanContext.Culling.SetBuffers((u32)i, VulkanContext.ObjectBuffers[i], VulkanContext.DrawCommandBuffers[i], VulkanContext.DrawCountBuffers[i]);
+        } else {
+            CreateBuffer(commandsSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VulkanContext.DrawCommandBuffers[i], VulkanContext.DrawCommandBuffersAllocation[i]);
+        }
+    }
+
+    EM_INFO("Object culling on the %s", GpuCullingEnabled ? "GPU" : "CPU");
 }
 
-void Renderer::CreateDescriptorSets()
+void Renderer::SetCamera(const glm::mat4& view, const glm::mat4& projection)
+{
+    CameraView = view;
+    CameraProjection = projection;
+    CustomCamera = true;
+    CameraDirtyFrames = ~0u;
+}
+
+void Renderer::ResetCamera()
 {
-    std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, VulkanContext.DescriptorSetLayout);
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = VulkanContext.DescriptoPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-    allocInfo.pSetLayouts = layouts.data();
+    f32 width = (f32)VulkanContext.SwapChainExtent.width;
+    f32 height = (f32)VulkanContext.SwapChainExtent.height;
 
-    VulkanContext.DescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-    if (vkAllocateDescriptorSets(VulkanContext.VulkanDevice.LogicalDevice, &allocInfo, VulkanContext.DescriptorSets.data()) != VK_SUCCESS) {
-        EM_FATAL("failed to allocate descriptor sets!");
+    CameraView = glm::mat4(1.0f);
+
+    // Pixel-space 2D camera, origin at the bottom left and y up. Swapping
+    // bottom/top accounts for Vulkan's downward clip-space y.
+    CameraProjection = glm::ortho(0.0f, width, height, 0.0f, -1.0f, 1.0f);
+
+    CustomCamera = false;
+    CameraDirtyFrames = ~0u;
+}
+
+void Renderer::GetViewBounds(glm::vec2& min, glm::vec2& max) const
+{
+    glm::mat4 inverse = glm::inverse(CameraProjection * CameraView);
+
+    min = glm::vec2(FLT_MAX);
+    max = glm::vec2(-FLT_MAX);
+    for (u32 i = 0; i < 4; i++) {
+        glm::vec4 corner = inverse * glm::vec4(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, 0.0f, 1.0f);
+        glm::vec2 point = glm::vec2(corner) / corner.w;
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+}
+
+void Renderer::SetTileMap(TileMap* map)
+{
+    // Chunk buffers are rebuilt from scratch for whichever map comes next.
+    for (TileChunkBuffer& chunk : VulkanContext.TileChunks) {
+        if (chunk.Buffer != VK_NULL_HANDLE) {
+            RetireBuffer(chunk.Buffer, chunk.Allocation);
+        }
     }
+    VulkanContext.TileChunks.clear();
+    VisibleTileChunks.clear();
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        VkDescriptorBufferInfo bufferInfo{};
-        bufferInfo.buffer = VulkanContext.UniformBuffers[i];
-        bufferInfo.offset = 0;
-        bufferInfo.range = sizeof(UniformBufferObject);
+    Tiles = map;
+    if (map != nullptr) {
+        TileVertices.resize(TILE_CHUNK_MAX_QUADS * 4);
+    }
+}
+
+// Brings the chunk buffers up to date with the map and collects the chunks
+// in view. A static map costs one rectangle lookup over the chunk grid.
+void Renderer::UpdateTileChunks()
+{
+    VisibleTileChunks.clear();
+    LastFrameStats.TileChunksDrawn = 0;
+    LastFrameStats.TileChunksRebuilt = 0;
 
-        VkWriteDescriptorSet descriptorWrite{};
-        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptorWrite.dstSet = VulkanContext.DescriptorSets[i];
-        descriptorWrite.dstBinding = 0;
-        descriptorWrite.dstArrayElement = 0;
-        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        descriptorWrite.descriptorCount = 1;
-        descriptorWrite.pBufferInfo = &bufferInfo;
+    if (Tiles == nullptr) {
+        return;
+    }
 
-        vkUpdateDescriptorSets(VulkanContext.VulkanDevice.LogicalDevice, 1, &descriptorWrite, 0, nullptr);
+    // A newly attached or reinitialized map has no buffers that fit it yet.
+    u32 chunkCount = Tiles->GetChunkCount();
+    if (VulkanContext.TileChunks.size() != chunkCount) {
+        for (TileChunkBuffer& buffer : VulkanContext.TileChunks) {
+            if (buffer.Buffer != VK_NULL_HANDLE) {
+                RetireBuffer(buffer.Buffer, buffer.Allocation);
+            }
+        }
+        VulkanContext.TileChunks.assign(chunkCount, TileChunkBuffer{});
+        for (u32 chunk = 0; chunk < chunkCount; chunk++) {
+            RebuildTileChunk(chunk);
+        }
+    } else {
+        for (u32 chunk : Tiles->GetDirtyChunks()) {
+            RebuildTileChunk(chunk);
+        }
     }
+    Tiles->ClearDirty();
+
+    glm::vec2 viewMin, viewMax;
+    GetViewBounds(viewMin, viewMax);
+    Tiles->FindChunks(viewMin, viewMax, VisibleTileChunks);
+
+    VisibleTileChunks.erase(std::remove_if(VisibleTileChunks.begin(), VisibleTileChunks.end(), [](u32 chunk) {
+        return VulkanContext.TileChunks[chunk].QuadCount == 0;
+    }), VisibleTileChunks.end());
+    LastFrameStats.TileChunksDrawn = static_cast<u32>(VisibleTileChunks.size());
 }
 
-void Renderer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+// Writes the chunk into a new buffer instead of over the old one, which
+// frames still in flight may be drawing from.
+void Renderer::RebuildTileChunk(u32 chunk)
+{
+    // Map edits are content changes; the GPU allocator's bookkeeping may grow.
+    ScopedAllocationAllowance allowance;
 
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = VulkanContext.CommandPool;
-    allocInfo.commandBufferCount = 1;
+    TileChunkBuffer& buffer = VulkanContext.TileChunks[chunk];
+    if (buffer.Buffer != VK_NULL_HANDLE) {
+        RetireBuffer(buffer.Buffer, buffer.Allocation);
+    }
 
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(VulkanContext.VulkanDevice.LogicalDevice, &allocInfo, &commandBuffer);
+    buffer.QuadCount = Tiles->BuildChunk(chunk, TileVertices.data());
+    if (buffer.QuadCount == 0) {
+        return;
+    }
+
+    VkDeviceSize bufferSize = sizeof(HalfVertex) * 4 * buffer.QuadCount;
+    CreateBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer.Buffer, buffer.Allocation);
+    VulkanContext.Uploads.UploadBuffer(buffer.Buffer, 0, TileVertices.data(), bufferSize);
 
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    LastFrameStats.TileChunksRebuilt++;
+}
+
+void Renderer::RetireBuffer(VkBuffer& buffer, GpuAllocation& allocation)
+{
+    VulkanContext.RetiredBuffers.push_back({buffer, allocation, FrameNumber});
+    buffer = VK_NULL_HANDLE;
+}
 
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+void Renderer::DestroyRetiredBuffers(bool all)
+{
+    // Retired in frame order, so the ready ones are at the front.
+    std::vector<RetiredBuffer>& retired = VulkanContext.RetiredBuffers;
+    size_t ready = 0;
+    while (ready < retired.size() && (all || retired[ready].Frame + MAX_FRAMES_IN_FLIGHT <= FrameNumber)) {
+        DestroyBuffer(retired[ready].Buffer, retired[ready].Allocation);
+        ready++;
+    }
 
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;  // Optional
-    copyRegion.dstOffset = 0;  // Optional
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    retired.erase(retired.begin(), retired.begin() + ready);
+}
 
-    vkEndCommandBuffer(commandBuffer);
+void Renderer::SubmitObject(const glm::mat4& model)
+{
+    // Bounding sphere of the transformed unit quad.
+    f32 radius = 0.5f * sqrtf(glm::dot(glm::vec3(model[0]), glm::vec3(model[0])) + glm::dot(glm::vec3(model[1]), glm::vec3(model[1])));
+    Objects.push_back({model, glm::vec4(glm::vec3(model[3]), radius)});
+}
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
+void Renderer::UpdateUniformBuffer(u32 currentImage)
+{
+    // Each frame in flight has its own copy, so a change is written once per copy.
+    u32 frameBit = 1u << currentImage;
+    if (!(CameraDirtyFrames & frameBit)) {
+        return;
+    }
+
+    UniformBufferObject ubo{};
+    ubo.view = CameraView;
+    ubo.proj = CameraProjection;
+
+    memcpy(VulkanContext.UniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+
+    CameraDirtyFrames &= ~frameBit;
+}
+
+void Renderer::CreateDescriptorAllocator() {
+    if (!VulkanContext.Descriptors.Initialize(VulkanContext.VulkanDevice.LogicalDevice, MAX_FRAMES_IN_FLIGHT)) {
+        EM_FATAL("failed to create descriptor allocator!");
+    }
+}
 
-    vkQueueSubmit(VulkanContext.GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(VulkanContext.GraphicsQueue);
+// Each frame slot's set never changes, so it comes from the allocator's cache.
+void Renderer::CreateDescriptorSets()
+{
+    VulkanContext.DescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 
-    vkFreeCommandBuffers(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.CommandPool, 1, &commandBuffer);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        DescriptorBinding bindings[2]{};
+        bindings[0].Binding = 0;
+        bindings[0].Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        bindings[0].Buffer = VulkanContext.UniformBuffers[i];
+        bindings[0].Range = sizeof(UniformBufferObject);
+
+        bindings[1].Binding = 1;
+        bindings[1].Type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].Buffer = VulkanContext.ObjectBuffers[i];
+        bindings[1].Range = VK_WHOLE_SIZE;
+
+        VulkanContext.DescriptorSets[i] = VulkanContext.Descriptors.GetCached(VulkanContext.DescriptorSetLayout, bindings, 2);
+        if (VulkanContext.DescriptorSets[i] == VK_NULL_HANDLE) {
+            EM_FATAL("failed to allocate descriptor sets!");
+        }
+    }
 }
 
 u32 Renderer::FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties) {
@@ -1117,10 +1841,18 @@ void Renderer::CreateDescriptorSetLayout() {
     uboLayoutBinding.descriptorCount = 1;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
+    VkDescriptorSetLayoutBinding objectLayoutBinding{};
+    objectLayoutBinding.binding = 1;
+    objectLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    objectLayoutBinding.descriptorCount = 1;
+    objectLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutBinding bindings[] = {uboLayoutBinding, objectLayoutBinding};
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &uboLayoutBinding;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = bindings;
 
     if (vkCreateDescriptorSetLayout(VulkanContext.VulkanDevice.LogicalDevice, &layoutInfo, nullptr, &VulkanContext.DescriptorSetLayout) != VK_SUCCESS) {
         EM_FATAL("failed to create descriptor set layout!");
@@ -1130,23 +1862,32 @@ void Renderer::CreateDescriptorSetLayout() {
 void Renderer::Shutdown() {
     CleanSwapChain();
     
-    vkDestroyDescriptorPool(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.DescriptoPool, nullptr);
+    VulkanContext.Descriptors.Shutdown();
     vkDestroyDescriptorSetLayout(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.DescriptorSetLayout, nullptr);
 
-    vkDestroyBuffer(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.IndexBuffer, nullptr);
-    vkFreeMemory(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.IndexBufferMemory, nullptr);
+    DestroyBuffer(VulkanContext.IndexBuffer, VulkanContext.IndexBufferAllocation);
+    DestroyBuffer(VulkanContext.TileIndexBuffer, VulkanContext.TileIndexBufferAllocation);
+    SetTileMap(nullptr);
+    DestroyRetiredBuffers(true);
+    DestroyBuffer(VulkanContext.VertexBuffer, VulkanContext.VertexBufferAllocation);
 
-    vkDestroyBuffer(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.VertexBuffer, nullptr);
-    vkFreeMemory(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.VertexBufferMemory, nullptr);
+    VulkanContext.Arena.Shutdown();
+    DestroyBuffer(VulkanContext.ArenaBuffer, VulkanContext.ArenaAllocation);
 
      for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroyBuffer(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.UniformBuffers[i], nullptr);
-        vkFreeMemory(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.UniformBuffersMemory[i], nullptr);
+        DestroyBuffer(VulkanContext.UniformBuffers[i], VulkanContext.UniformBuffersAllocation[i]);
+        DestroyBuffer(VulkanContext.ObjectBuffers[i], VulkanContext.ObjectBuffersAllocation[i]);
+        DestroyBuffer(VulkanContext.DrawCommandBuffers[i], VulkanContext.DrawCommandBuffersAllocation[i]);
+        DestroyBuffer(VulkanContext.DrawCountBuffers[i], VulkanContext.DrawCountBuffersAllocation[i]);
     }
 
     vkDestroyDescriptorSetLayout(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.DescriptorSetLayout, nullptr);
 
-    vkDestroyPipeline(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.GraphicsPipeline, nullptr);
+    VulkanContext.Pipelines.Shutdown();
+    VulkanContext.Culling.Shutdown();
+
+    VulkanContext.PipelineCache.Save();
+    VulkanContext.PipelineCache.Destroy();
     vkDestroyPipelineLayout(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.PipelineLayout, nullptr);
     vkDestroyRenderPass(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.RenderPass, nullptr);
 
@@ -1156,13 +1897,28 @@ void Renderer::Shutdown() {
         vkDestroyFence(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.InFlightFences[i], nullptr);
     }
 
+    if (GpuProfilePath != nullptr) {
+        VulkanContext.Profiler.Dump(GpuProfilePath);
+    }
+    VulkanContext.Profiler.Shutdown();
+
+    VulkanContext.Recorder.Shutdown();
     vkDestroyCommandPool(VulkanContext.VulkanDevice.LogicalDevice, VulkanContext.CommandPool, nullptr);
+
+    VulkanContext.Uploads.Shutdown();
+    DestroyBuffer(VulkanContext.StagingBuffer, VulkanContext.StagingAllocation);
+
+    VulkanContext.Graph.Shutdown();
+    VulkanContext.Textures.Shutdown(VulkanContext.MemoryAllocator);
+    VulkanContext.MemoryAllocator.Shutdown();
     vkDestroyDevice(VulkanContext.VulkanDevice.LogicalDevice, nullptr);
 
     if (EnableValidationLayers) {
         DestroyDebugUtilsMessengerEXT(VulkanContext.Instance, VulkanContext.DebugMessenger, nullptr);
     }
 
-    vkDestroySurfaceKHR(VulkanContext.Instance, VulkanContext.Surface, nullptr);
+    if (!Headless) {
+        vkDestroySurfaceKHR(VulkanContext.Instance, VulkanContext.Surface, nullptr);
+    }
     vkDestroyInstance(VulkanContext.Instance, nullptr);
 }
\ No newline at end of file
@@ -1,25 +1,111 @@
 #pragma once
 
 #include "VulkanTypes.h"
+#include "SpriteBatch.h"
+#include "UniformBuffer.h"
+#include "FramePacer.h"
+#include "core/Jobs/JobSystem.h"
+#include "core/Scene/TileMap.h"
 #include "core/Window/Window.h"
 #include "defines.h"
 #include <vulkan/vulkan.h>
+#include <chrono>
+#include <functional>
 #include <vector>
 
+struct FrameStats {
+    f64 CpuPrepareMs;
+    f64 CpuRecordMs;
+    f64 CpuSubmitMs;
+    f64 GpuMs;
+    bool GpuValid;
+    f64 PacingMs;
+    // From the input sample before the camera update until the frame's
+    // fence is seen signalled. Exact when the CPU waits on that fence (low
+    // latency mode); an upper bound when the frame had already finished.
+    f64 InputLatencyMs;
+    bool InputLatencyValid;
+    u32 TileChunksDrawn;
+    u32 TileChunksRebuilt;
+};
+
+enum LatencyMode
+{
+    // 2 frames in flight, MAILBOX falling back to FIFO.
+    LATENCY_MODE_BALANCED = 0,
+    // 1 frame in flight, IMMEDIATE then MAILBOX then FIFO.
+    LATENCY_MODE_LOW = 1,
+    // 3 frames in flight, FIFO.
+    LATENCY_MODE_THROUGHPUT = 2,
+};
+
 class Renderer {
 public:
     u32 CurrentFrame = 0;
     bool FramebufferResized = false;
+    bool Headless = false;
+    bool UseTransferQueue = true;
+    u32 RecordThreadCount = 0;          // 0 = one per hardware thread
+    u32 MinDrawsPerRecordThread = 64;
+    // Set before Initialize to record on the job system's workers instead
+    // of dedicated record threads.
+    JobSystem* Jobs = nullptr;
+    const char* GpuProfilePath = nullptr;   // .csv or .json, rewritten every GpuProfileDumpInterval frames
+    u32 GpuProfileDumpInterval = 600;
     Window* MainWindow;
+    // Runs after the frame's image is acquired and right before the camera
+    // uniforms are written; sample input here to render it a frame sooner.
+    std::function<void()> LateUpdate;
+    FrameStats LastFrameStats{};
+    SpriteBatch Sprites;
     
     public:
     Renderer();
     ~Renderer();
 
     bool Initialize(const char* appName, Window* window);
+    bool InitializeHeadless(const char* appName, u32 width, u32 height);
     void Draw();
     void Shutdown();
     VkDevice GetLogicalDevice();
+    GpuAllocatorStats GetMemoryStats();
+    RenderGraphStats GetRenderGraphStats();
+    DescriptorAllocatorStats GetDescriptorStats();
+
+    // Rolling per-zone GPU times (one zone per render graph pass, plus
+    // "Frame") and the last frame's pipeline statistics.
+    const std::vector<GpuZoneStats>& GetGpuZoneStats();
+    bool GetGpuPipelineStatistics(GpuPipelineStatistics& statistics);
+    bool DumpGpuProfile(const char* path);
+    void SetRecordThreadCount(u32 count);
+
+    // Can be called before Initialize. Afterwards it waits for the device to
+    // go idle and may recreate the swapchain.
+    void SetLatencyMode(LatencyMode mode);
+    LatencyMode GetLatencyMode() const { return Latency; }
+    u32 GetFramesInFlight() const { return FramesInFlight; }
+    // Caps Draw at the given rate by sleeping before the frame starts; 0 = uncapped.
+    void SetFrameRateLimit(f64 framesPerSecond);
+
+    // Camera defaults to pixel space with the origin at the bottom left;
+    // SetCamera overrides it until ResetCamera is called.
+    void SetCamera(const glm::mat4& view, const glm::mat4& projection);
+    void ResetCamera();
+    // World-space rectangle the camera sees at z = 0, for querying a SpatialGrid.
+    void GetViewBounds(glm::vec2& min, glm::vec2& max) const;
+
+    // Draws the map's chunks in view beneath objects and sprites; nullptr
+    // detaches it. The map must stay alive while attached.
+    void SetTileMap(TileMap* map);
+
+    // Queues one demo quad with the given transform for the next Draw.
+    void SubmitObject(const glm::mat4& model);
+
+    // Creates a texture from tightly packed RGBA8 pixels and returns its
+    // bindless index for Sprite::Texture. The upload is asynchronous; the
+    // next Draw waits for it on the GPU.
+    u32 CreateTexture(const void* pixels, u32 width, u32 height);
+    void DestroyTexture(u32 texture);
 
     static VKAPI_ATTR VkBool32 VKAPI_CALL VulkanDebugCallback(
     VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
@@ -54,32 +140,84 @@ private:
     bool PickPhysicalDevice();
     void CreateLogicalDevice();
     void CreateSwapChain(WindowState* state);
+    void CreateOffscreenTargets(u32 width, u32 height);
+    void CreateRenderResources();
     void RecreateSwapChain();
     void CleanSwapChain();
+    void DestroyRetiredSwapChains(bool all);
     bool IsDeviceCompatible(VkPhysicalDevice device);
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
     QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
     SwapChainSupport QuerySwapChainSupport(VkPhysicalDevice device);
-    VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-    VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
+    VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const SwapChainSupport& support);
+    VkPresentModeKHR ChooseSwapPresentMode(const SwapChainSupport& support);
     VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, WindowState* state);
     void CreateImageViews();
     void CreateRenderPass();
-    void CreateGraphicsPipeline();
+    void CreatePipelineLayout();
+    void CreatePipelines();
     VkShaderModule CreateShaderModule(const std::vector<char>& code);
-    void CreateFrameBuffers();
+    void CreateRenderGraph();
     void CreateCommandPool();
     void CreateCommandBuffer();
+    void CreateRecordThreads();
     void RecordCommandBuffer(VkCommandBuffer commandBuffer, u32 imageIndex);
+    void RecordDraws(VkCommandBuffer commandBuffer, u32 first, u32 count);
     void CreateSyncObjects();
+    void CreateProfiler();
+    void ResolveGpuProfile(u32 frame);
     void CreateUniformBuffers();
+    void CreateFrameArena();
+    void CreateObjectBuffers();
+    void CreateCulling();
     void CreateVertexBuffer();
     void CreateIndexBuffer();
-    void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+    void CreateTileIndexBuffer();
+    void UpdateTileChunks();
+    void RebuildTileChunk(u32 chunk);
+    void RetireBuffer(VkBuffer& buffer, GpuAllocation& allocation);
+    void DestroyRetiredBuffers(bool all);
+    void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, GpuAllocation& allocation);
+    void DestroyBuffer(VkBuffer& buffer, GpuAllocation& allocation);
     void CreateDescriptorSetLayout();
-    void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    void CreateUploadQueue();
+    void CreateTextureTable();
     void UpdateUniformBuffer(u32 currentImage);
-    void CreateDescriptorPool();
+    void CreateDescriptorAllocator();
     void CreateDescriptorSets();
     u32  FindMemoryType(u32 typeFilter, VkMemoryPropertyFlags properties);
+
+    u32 SpriteInstanceCount = 0;
+    VkDeviceSize SpriteInstanceOffset = 0;   // in the frame arena
+    u64 FrameNumber = 0;
+
+    LatencyMode Latency = LATENCY_MODE_BALANCED;
+    u32 FramesInFlight = 2;
+    bool SwapChainSuspended = false;   // minimized, nothing to render to
+    FramePacer Pacer;
+    std::vector<std::chrono::steady_clock::time_point> InputSampleTimes;
+
+    std::vector<ObjectData> Objects;
+    u32 ObjectCount = 0;
+
+    // Objects are culled by a compute pass feeding vkCmdDrawIndexedIndirectCount
+    // when the device can, otherwise on the CPU into a mapped indirect buffer.
+    bool GpuCullingEnabled = false;
+    bool IndirectDrawSupported = false;
+    u32 VisibleObjectCount = 0;   // CPU culling only
+    CullConstants Cull{};
+
+    // Pipeline library handles.
+    u32 ObjectPipeline = PIPELINE_NONE;
+    u32 SpritePipelines[SPRITE_BLEND_COUNT];
+    u32 TilePipeline = PIPELINE_NONE;
+
+    TileMap* Tiles = nullptr;
+    std::vector<u32> VisibleTileChunks;   // non-empty chunks in view
+    std::vector<HalfVertex> TileVertices;  // one chunk's geometry while rebuilding
+
+    glm::mat4 CameraView = glm::mat4(1.0f);
+    glm::mat4 CameraProjection = glm::mat4(1.0f);
+    bool CustomCamera = false;
+    u32 CameraDirtyFrames = ~0u;  // bit per frame in flight
 };
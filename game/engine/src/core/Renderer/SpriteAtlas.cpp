@@ -0,0 +1,124 @@
+#include "SpriteAtlas.h"
+#include "Renderer.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <fstream>
+
+bool SpriteAtlas::Load(Renderer& renderer, const char* path) {
+    Unload(renderer);
+
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file.is_open()) {
+        EM_ERROR("Could not open atlas %s", path);
+        return false;
+    }
+
+    AtlasFileHeader header{};
+    file.read((char*)&header, sizeof(header));
+
+    if (!file || header.Magic != ATLAS_MAGIC || header.Version != ATLAS_VERSION) {
+        EM_ERROR("%s is not a version %u sprite atlas", path, ATLAS_VERSION);
+        return false;
+    }
+
+    if (header.TableSize == 0 || (header.TableSize & (header.TableSize - 1)) != 0 || header.PageSize == 0) {
+        EM_ERROR("Atlas %s has a malformed header", path);
+        return false;
+    }
+
+    size_t pageBytes = (size_t)header.PageSize * header.PageSize * 4;
+    std::vector<u8> pixels(pageBytes);
+
+    for (u32 page = 0; page < header.PageCount; page++) {
+        if (!file.read((char*)pixels.data(), pageBytes)) {
+            EM_ERROR("Atlas %s is truncated", path);
+            Unload(renderer);
+            return false;
+        }
+
+        Pages.push_back(renderer.CreateTexture(pixels.data(), header.PageSize, header.PageSize));
+    }
+
+    std::vector<AtlasFileEntry> entries(header.TableSize);
+    if (!file.read((char*)entries.data(), entries.size() * sizeof(AtlasFileEntry))) {
+        EM_ERROR("Atlas %s is truncated", path);
+        Unload(renderer);
+        return false;
+    }
+
+    // Keep the packer's slot layout so probing works unchanged, but resolve
+    // everything a draw needs up front.
+    TableMask = header.TableSize - 1;
+    Hashes.resize(header.TableSize);
+    Regions.resize(header.TableSize);
+
+    f32 pageSize = (f32)header.PageSize;
+    u32 used = 0;
+
+    for (u32 i = 0; i < header.TableSize; i++) {
+        const AtlasFileEntry& entry = entries[i];
+        Hashes[i] = entry.NameHash;
+
+        if (entry.NameHash == 0) {
+            Regions[i] = {};
+            continue;
+        }
+
+        if (entry.Page >= Pages.size()) {
+            EM_ERROR("Atlas %s references missing page %u", path, entry.Page);
+            Unload(renderer);
+            return false;
+        }
+
+        used++;
+
+        SpriteRegion& region = Regions[i];
+        region.Texture = Pages[entry.Page];
+        region.UV = glm::vec4(entry.X / pageSize, entry.Y / pageSize, (entry.X + entry.Width) / pageSize, (entry.Y + entry.Height) / pageSize);
+        region.Size = glm::vec2(entry.Width, entry.Height);
+        region.SourceSize = glm::vec2(entry.SourceWidth, entry.SourceHeight);
+
+        // Image rows run top to bottom, world y runs up.
+        region.Offset = glm::vec2(entry.TrimX + entry.Width * 0.5f - entry.SourceWidth * 0.5f,
+                                  entry.SourceHeight * 0.5f - (entry.TrimY + entry.Height * 0.5f));
+    }
+
+    // Lookups stop at the first empty slot, so there has to be one.
+    if (used == header.TableSize) {
+        EM_ERROR("Atlas %s has a full lookup table", path);
+        Unload(renderer);
+        return false;
+    }
+
+    EM_INFO("Loaded atlas %s: %u sprites on %u pages of %u px", path, header.EntryCount, header.PageCount, header.PageSize);
+
+    return true;
+}
+
+void SpriteAtlas::Unload(Renderer& renderer) {
+    for (u32 page : Pages) {
+        renderer.DestroyTexture(page);
+    }
+
+    Pages.clear();
+    Hashes.clear();
+    Regions.clear();
+    TableMask = 0;
+}
+
+const SpriteRegion* SpriteAtlas::Find(u64 nameHash) const {
+    if (Hashes.empty()) {
+        return nullptr;
+    }
+
+    // The packer keeps the table at most half full, so probes stay short.
+    for (u32 slot = (u32)nameHash & TableMask;; slot = (slot + 1) & TableMask) {
+        if (Hashes[slot] == nameHash) {
+            return &Regions[slot];
+        }
+        if (Hashes[slot] == 0) {
+            return nullptr;
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include "AtlasFormat.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vector>
+
+class Renderer;
+
+// Where a named sprite ended up in a packed atlas.
+struct SpriteRegion {
+    u32 Texture;        // bindless index of the atlas page
+    glm::vec4 UV;       // (min.x, min.y, max.x, max.y), ready for Sprite::UV
+    glm::vec2 Size;     // trimmed size in pixels
+    glm::vec2 Offset;   // trimmed center relative to the untrimmed center, y up
+    glm::vec2 SourceSize;
+};
+
+// Runtime side of tools/AtlasPacker: uploads the atlas pages as textures and
+// resolves sprite names with a single hash and (almost always) one probe.
+class SpriteAtlas {
+public:
+    bool Load(Renderer& renderer, const char* path);
+    void Unload(Renderer& renderer);
+
+    const SpriteRegion* Find(const char* name) const { return Find(HashSpriteName(name)); }
+    const SpriteRegion* Find(u64 nameHash) const;
+
+    u32 GetPageCount() const { return (u32)Pages.size(); }
+
+private:
+    std::vector<u32> Pages;
+    std::vector<u64> Hashes;
+    std::vector<SpriteRegion> Regions;
+    u32 TableMask = 0;
+};
@@ -0,0 +1,105 @@
+#include "SpriteBatch.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vendor/glm/glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cstring>
+
+u32 PackColor(const glm::vec4& color) {
+    return glm::packUnorm4x8(color);
+}
+
+SpriteBatch::SpriteBatch() {
+    Instances.reserve(MAX_SPRITES_PER_FRAME);
+    Layers.reserve(MAX_SPRITES_PER_FRAME);
+    Blends.reserve(MAX_SPRITES_PER_FRAME);
+    LayerOffsets.reserve(MAX_SPRITE_LAYERS);
+}
+
+void SpriteBatch::Submit(const Sprite& sprite) {
+    // Bounded so the counting sort in Flush has a bounded table.
+    u32 layer = std::min(sprite.Layer, MAX_SPRITE_LAYERS - 1);
+    if (!Layers.empty() && layer < Layers.back()) {
+        LayersSorted = false;
+    }
+
+    MaxLayer = std::max(MaxLayer, layer);
+
+    SpriteInstance& instance = Instances.emplace_back();
+    instance.Position = sprite.Position;
+    instance.Size = glm::packHalf2x16(sprite.Size);
+    instance.UV[0] = glm::packUnorm2x16(glm::vec2(sprite.UV.x, sprite.UV.y));
+    instance.UV[1] = glm::packUnorm2x16(glm::vec2(sprite.UV.z, sprite.UV.w));
+    instance.Rotation = sprite.Rotation;
+    instance.Color = sprite.Color;
+    instance.Texture = sprite.Texture;
+
+    Layers.push_back(layer);
+    Blends.push_back(sprite.Blend);
+}
+
+void SpriteBatch::Clear() {
+    Instances.clear();
+    Layers.clear();
+    Blends.clear();
+    MaxLayer = 0;
+    LayersSorted = true;
+}
+
+u32 SpriteBatch::Flush(SpriteInstance* destination, u32 capacity) {
+    Batches.clear();
+
+    u32 count = (u32)std::min<size_t>(Instances.size(), capacity);
+
+    if (Instances.size() > capacity) {
+        EM_WARN("Sprite batch overflow, dropped %u sprites", (u32)(Instances.size() - capacity));
+    }
+
+    const u32* layers = Layers.data();
+    const SpriteBlend* blends = Blends.data();
+
+    if (LayersSorted) {
+        // Already in layer order: stream straight into the mapped buffer.
+        memcpy(destination, Instances.data(), count * sizeof(SpriteInstance));
+    } else {
+        // Counting sort by layer so each layer is one contiguous instance range
+        // and sprites keep their submission order within a layer.
+        LayerOffsets.assign(MaxLayer + 1, 0);
+        for (u32 i = 0; i < count; i++) {
+            LayerOffsets[Layers[i]]++;
+        }
+
+        u32 offset = 0;
+        for (u32 layer = 0; layer <= MaxLayer; layer++) {
+            u32 layerCount = LayerOffsets[layer];
+            LayerOffsets[layer] = offset;
+            offset += layerCount;
+        }
+
+        SortedInstances.resize(count);
+        SortedLayers.resize(count);
+        SortedBlends.resize(count);
+        for (u32 i = 0; i < count; i++) {
+            u32 target = LayerOffsets[Layers[i]]++;
+            SortedInstances[target] = Instances[i];
+            SortedLayers[target] = Layers[i];
+            SortedBlends[target] = Blends[i];
+        }
+
+        memcpy(destination, SortedInstances.data(), count * sizeof(SpriteInstance));
+
+        layers = SortedLayers.data();
+        blends = SortedBlends.data();
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        if (Batches.empty() || Batches.back().Layer != layers[i] || Batches.back().Blend != blends[i]) {
+            Batches.push_back({layers[i], blends[i], i, 0});
+        }
+        Batches.back().InstanceCount++;
+    }
+
+    Clear();
+
+    return count;
+}
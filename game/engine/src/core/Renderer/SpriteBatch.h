@@ -0,0 +1,137 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vulkan/vulkan.h>
+#include <array>
+#include <vector>
+
+const u32 MAX_SPRITES_PER_FRAME = 131072;
+const u32 MAX_SPRITE_LAYERS = 65536;
+
+enum SpriteBlend
+{
+    SPRITE_BLEND_ALPHA = 0,
+    SPRITE_BLEND_ADDITIVE = 1,
+    // Opaque, discarding texels below half alpha.
+    SPRITE_BLEND_CUTOUT = 2,
+    SPRITE_BLEND_COUNT = 3,
+};
+
+// A sprite as submitted by gameplay code. Position is the sprite's center in
+// world units, rotation is in radians and UV is (min.x, min.y, max.x, max.y).
+// Texture is a bindless texture index (0 is plain white); layers are drawn
+// in ascending order and clamped to MAX_SPRITE_LAYERS - 1. Blend picks the
+// sprite's pipeline variant.
+struct Sprite {
+    glm::vec2 Position;
+    glm::vec2 Size;
+    f32 Rotation;
+    u32 Color;
+    glm::vec4 UV;
+    u32 Texture;
+    u32 Layer;
+    SpriteBlend Blend;
+};
+
+// Per-instance data as the sprite vertex shader reads it (vertex binding 1).
+// Position stays float for world-space precision; size is half float and UV
+// unorm16, which is exact enough for atlases up to 16k texels.
+struct SpriteInstance {
+    glm::vec2 Position;
+    u32 Size;
+    u32 UV[2];
+    f32 Rotation;
+    u32 Color;
+    u32 Texture;
+
+    static VkVertexInputBindingDescription GetBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription;
+
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(SpriteInstance);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 6> GetAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 6> attributeDescriptions{};
+
+        attributeDescriptions[0].binding = 1;
+        attributeDescriptions[0].location = 2;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[0].offset = offsetof(SpriteInstance, Position);
+
+        attributeDescriptions[1].binding = 1;
+        attributeDescriptions[1].location = 3;
+        attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+        attributeDescriptions[1].offset = offsetof(SpriteInstance, Size);
+
+        attributeDescriptions[2].binding = 1;
+        attributeDescriptions[2].location = 4;
+        attributeDescriptions[2].format = VK_FORMAT_R16G16B16A16_UNORM;
+        attributeDescriptions[2].offset = offsetof(SpriteInstance, UV);
+
+        attributeDescriptions[3].binding = 1;
+        attributeDescriptions[3].location = 5;
+        attributeDescriptions[3].format = VK_FORMAT_R32_SFLOAT;
+        attributeDescriptions[3].offset = offsetof(SpriteInstance, Rotation);
+
+        attributeDescriptions[4].binding = 1;
+        attributeDescriptions[4].location = 6;
+        attributeDescriptions[4].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[4].offset = offsetof(SpriteInstance, Color);
+
+        attributeDescriptions[5].binding = 1;
+        attributeDescriptions[5].location = 7;
+        attributeDescriptions[5].format = VK_FORMAT_R32_UINT;
+        attributeDescriptions[5].offset = offsetof(SpriteInstance, Texture);
+
+        return attributeDescriptions;
+    }
+};
+
+STATIC_ASSERT(sizeof(SpriteInstance) == 32, "Expected SpriteInstance to be 32 bytes.");
+
+// A run of instances on one layer with one blend mode, drawn with one
+// instanced draw. Textures come from the bindless table, so they never
+// split a batch.
+struct SpriteDrawBatch {
+    u32 Layer;
+    SpriteBlend Blend;
+    u32 FirstInstance;
+    u32 InstanceCount;
+};
+
+u32 PackColor(const glm::vec4& color);
+
+class SpriteBatch {
+public:
+    SpriteBatch();
+
+    void Submit(const Sprite& sprite);
+    void Clear();
+
+    // Writes this frame's sprites into the instance buffer grouped by layer,
+    // rebuilds the draw batches and clears the submission list. Within a
+    // layer sprites keep their submission order, so a blend mode change
+    // starts a new batch.
+    u32 Flush(SpriteInstance* destination, u32 capacity);
+
+    const std::vector<SpriteDrawBatch>& GetBatches() const { return Batches; }
+    u32 GetSubmittedCount() const { return (u32)Instances.size(); }
+
+private:
+    std::vector<SpriteInstance> Instances;
+    std::vector<u32> Layers;
+    std::vector<SpriteBlend> Blends;
+    std::vector<SpriteInstance> SortedInstances;
+    std::vector<u32> SortedLayers;
+    std::vector<SpriteBlend> SortedBlends;
+    std::vector<u32> LayerOffsets;
+    std::vector<SpriteDrawBatch> Batches;
+    u32 MaxLayer = 0;
+    bool LayersSorted = true;
+};
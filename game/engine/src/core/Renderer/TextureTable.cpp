@@ -0,0 +1,193 @@
+#include "TextureTable.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+
+bool TextureTable::Initialize(VkPhysicalDevice physicalDevice, VkDevice device) {
+    Device = device;
+
+    VkPhysicalDeviceVulkan12Properties properties12{};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+    Capacity = std::min(MAX_BINDLESS_TEXTURES, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    Capacity = std::min(Capacity, properties12.maxDescriptorSetUpdateAfterBindSampledImages);
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = Capacity;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+
+    if (vkCreateDescriptorSetLayout(Device, &layoutInfo, nullptr, &Layout) != VK_SUCCESS) {
+        EM_FATAL("Could not create bindless texture set layout");
+        return false;
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = Capacity;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(Device, &poolInfo, nullptr, &Pool) != VK_SUCCESS) {
+        EM_FATAL("Could not create bindless texture pool");
+        return false;
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = Pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &Layout;
+
+    if (vkAllocateDescriptorSets(Device, &allocInfo, &Set) != VK_SUCCESS) {
+        EM_FATAL("Could not allocate bindless texture set");
+        return false;
+    }
+
+    // Nearest filtering keeps pixel art crisp.
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.maxLod = 0.0f;
+
+    if (vkCreateSampler(Device, &samplerInfo, nullptr, &Sampler) != VK_SUCCESS) {
+        EM_FATAL("Could not create texture sampler");
+        return false;
+    }
+
+    Textures.reserve(Capacity);
+    Used.reserve(Capacity);
+
+    EM_INFO("Bindless texture table initialized with %u slots", Capacity);
+
+    return true;
+}
+
+void TextureTable::Shutdown(GpuAllocator& allocator) {
+    for (u32 i = 0; i < Textures.size(); i++) {
+        if (Used[i]) {
+            DestroyTexture(Textures[i], allocator);
+        }
+    }
+
+    for (const PendingRemoval& removal : Removals) {
+        DestroyTexture(Textures[removal.Index], allocator);
+    }
+
+    Textures.clear();
+    Used.clear();
+    FreeIndices.clear();
+    Removals.clear();
+
+    vkDestroySampler(Device, Sampler, nullptr);
+    vkDestroyDescriptorPool(Device, Pool, nullptr);
+    vkDestroyDescriptorSetLayout(Device, Layout, nullptr);
+}
+
+u32 TextureTable::Add(const Texture& texture) {
+    u32 index;
+
+    if (!FreeIndices.empty()) {
+        index = FreeIndices.back();
+        FreeIndices.pop_back();
+        Textures[index] = texture;
+    } else if (Textures.size() < Capacity) {
+        index = (u32)Textures.size();
+        Textures.push_back(texture);
+        Used.push_back(false);
+    } else {
+        EM_ERROR("Bindless texture table is full (%u textures)", Capacity);
+        return WHITE_TEXTURE;
+    }
+
+    Used[index] = true;
+
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = Sampler;
+    imageInfo.imageView = texture.View;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = Set;
+    descriptorWrite.dstBinding = 0;
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(Device, 1, &descriptorWrite, 0, nullptr);
+
+    return index;
+}
+
+void TextureTable::Remove(u32 index, u64 frame) {
+    if (index == WHITE_TEXTURE || index >= Textures.size() || !Used[index]) {
+        return;
+    }
+
+    // The slot stays reserved until the GPU is done with it.
+    Used[index] = false;
+    Removals.push_back({index, frame});
+}
+
+void TextureTable::CollectGarbage(u64 currentFrame, u32 framesInFlight, GpuAllocator& allocator) {
+    // Removals are queued in frame order, so the ready ones are at the front.
+    size_t ready = 0;
+    while (ready < Removals.size() && Removals[ready].Frame + framesInFlight <= currentFrame) {
+        u32 index = Removals[ready].Index;
+
+        DestroyTexture(Textures[index], allocator);
+        FreeIndices.push_back(index);
+        ready++;
+    }
+
+    Removals.erase(Removals.begin(), Removals.begin() + ready);
+}
+
+const Texture* TextureTable::Get(u32 index) const {
+    if (index >= Textures.size() || !Used[index]) {
+        return nullptr;
+    }
+
+    return &Textures[index];
+}
+
+void TextureTable::DestroyTexture(Texture& texture, GpuAllocator& allocator) {
+    vkDestroyImageView(Device, texture.View, nullptr);
+    vkDestroyImage(Device, texture.Image, nullptr);
+    allocator.Free(texture.Allocation);
+    texture = {};
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include "GpuAllocator.h"
+#include <vulkan/vulkan.h>
+#include <vector>
+
+const u32 MAX_BINDLESS_TEXTURES = 4096;
+const u32 WHITE_TEXTURE = 0;
+
+struct Texture {
+    VkImage Image;
+    VkImageView View;
+    GpuAllocation Allocation;
+    u32 Width;
+    u32 Height;
+};
+
+// One big sampler2D array that every texture lives in for its whole life.
+// The descriptor set is bound once per command buffer; a texture is just an
+// index, so changing textures never rebinds a set or breaks a batch.
+// Slots are written with update-after-bind and only reused once the frames
+// that could still sample the old texture have finished.
+class TextureTable {
+public:
+    bool Initialize(VkPhysicalDevice physicalDevice, VkDevice device);
+    void Shutdown(GpuAllocator& allocator);
+
+    // Takes ownership of the image and returns its stable index.
+    u32 Add(const Texture& texture);
+    void Remove(u32 index, u64 frame);
+
+    // Frees textures removed at least framesInFlight frames before currentFrame.
+    void CollectGarbage(u64 currentFrame, u32 framesInFlight, GpuAllocator& allocator);
+
+    const Texture* Get(u32 index) const;
+
+    VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+    VkDescriptorSet Set = VK_NULL_HANDLE;
+
+private:
+    struct PendingRemoval {
+        u32 Index;
+        u64 Frame;
+    };
+
+    void DestroyTexture(Texture& texture, GpuAllocator& allocator);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkDescriptorPool Pool = VK_NULL_HANDLE;
+    VkSampler Sampler = VK_NULL_HANDLE;
+    u32 Capacity = 0;
+
+    std::vector<Texture> Textures;
+    std::vector<bool> Used;
+    std::vector<u32> FreeIndices;
+    std::vector<PendingRemoval> Removals;
+};
@@ -1,8 +1,22 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
 #include <vendor/glm/glm/glm.hpp>
 #include <vulkan/vulkan.h>
 
+const u32 MAX_OBJECTS_PER_FRAME = 65536;
+
+// Camera data, binding 0. Only rewritten when the camera changes.
 struct UniformBufferObject {
-    alignas(16) glm::mat4 model;
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
-};
\ No newline at end of file
+};
+
+// Per-object data, one element of the storage buffer at binding 1,
+// indexed in the shader by gl_InstanceIndex. Bounds are the bounding sphere
+// (xyz center, w radius) the culling pass tests.
+struct ObjectData {
+    alignas(16) glm::mat4 model;
+    alignas(16) glm::vec4 bounds;
+};
@@ -0,0 +1,341 @@
+#include "UploadQueue.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+#include <cstring>
+
+const VkDeviceSize STAGING_COPY_ALIGNMENT = 16;
+
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool UploadQueue::Initialize(VkDevice device, VkQueue queue, u32 queueFamily, VkBuffer stagingBuffer, void* stagingMapped, VkDeviceSize stagingSize, bool useTimeline) {
+    Device = device;
+    Queue = queue;
+    StagingBuffer = stagingBuffer;
+    StagingMapped = (u8*)stagingMapped;
+    StagingSize = stagingSize;
+    UseTimeline = useTimeline;
+
+    VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    if (vkCreateCommandPool(Device, &poolInfo, nullptr, &CommandPool) != VK_SUCCESS) {
+        EM_FATAL("Could not create upload command pool");
+        return false;
+    }
+
+    VkCommandBuffer commandBuffers[UPLOAD_BATCH_COUNT];
+
+    VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocInfo.commandPool = CommandPool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = UPLOAD_BATCH_COUNT;
+
+    if (vkAllocateCommandBuffers(Device, &allocInfo, commandBuffers) != VK_SUCCESS) {
+        EM_FATAL("Could not allocate upload command buffers");
+        return false;
+    }
+
+    VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+
+    for (u32 i = 0; i < UPLOAD_BATCH_COUNT; i++) {
+        Batches[i] = {};
+        Batches[i].CommandBuffer = commandBuffers[i];
+        vkCreateFence(Device, &fenceInfo, nullptr, &Batches[i].Fence);
+    }
+
+    if (UseTimeline) {
+        VkSemaphoreTypeCreateInfo timelineInfo{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+        timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        timelineInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+        semaphoreInfo.pNext = &timelineInfo;
+
+        if (vkCreateSemaphore(Device, &semaphoreInfo, nullptr, &TimelineSemaphore) != VK_SUCCESS) {
+            EM_WARN("Could not create upload timeline semaphore, falling back to fences");
+            UseTimeline = false;
+        }
+    }
+
+    EM_INFO("Upload queue initialized (%.1f MB staging, family %u)", (f64)stagingSize / (1024.0 * 1024.0), queueFamily);
+
+    return true;
+}
+
+void UploadQueue::Shutdown() {
+    Flush();
+    Wait(LastSubmittedTicket);
+
+    for (u32 i = 0; i < UPLOAD_BATCH_COUNT; i++) {
+        vkDestroyFence(Device, Batches[i].Fence, nullptr);
+    }
+
+    if (TimelineSemaphore != VK_NULL_HANDLE) {
+        vkDestroySemaphore(Device, TimelineSemaphore, nullptr);
+    }
+
+    vkDestroyCommandPool(Device, CommandPool, nullptr);
+}
+
+VkCommandBuffer UploadQueue::BeginCommands() {
+    UploadBatch& batch = Batches[CurrentBatch];
+
+    if (!Recording) {
+        // Every slot busy: the oldest batch has to finish before we can reuse one.
+        if (batch.InFlight) {
+            RetireOldest(true);
+        }
+
+        VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkResetCommandBuffer(batch.CommandBuffer, 0);
+        vkBeginCommandBuffer(batch.CommandBuffer, &beginInfo);
+
+        batch.StagingUsed = 0;
+        Recording = true;
+    }
+
+    return batch.CommandBuffer;
+}
+
+bool UploadQueue::UploadBuffer(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size) {
+    // Large uploads go through in chunks so they never need the whole ring at once.
+    VkDeviceSize maxChunk = StagingSize / 4;
+    const u8* source = (const u8*)data;
+
+    while (size > 0) {
+        VkDeviceSize chunk = std::min(size, maxChunk);
+        VkDeviceSize stagingOffset;
+
+        if (!AllocateStaging(chunk, STAGING_COPY_ALIGNMENT, stagingOffset)) {
+            EM_ERROR("Upload of %llu bytes does not fit in the staging buffer", (u64)chunk);
+            return false;
+        }
+
+        memcpy(StagingMapped + stagingOffset, source, (size_t)chunk);
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.dstOffset = destinationOffset;
+        copyRegion.size = chunk;
+        vkCmdCopyBuffer(BeginCommands(), StagingBuffer, destination, 1, &copyRegion);
+
+        source += chunk;
+        destinationOffset += chunk;
+        size -= chunk;
+    }
+
+    return true;
+}
+
+static void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+                            VkAccessFlags srcAccess, VkAccessFlags dstAccess, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+bool UploadQueue::UploadImage(VkImage destination, u32 width, u32 height, u32 texelSize, const void* data) {
+    if (width == 0 || height == 0) {
+        return false;
+    }
+
+    VkDeviceSize rowPitch = (VkDeviceSize)width * texelSize;
+    u32 rowsPerChunk = (u32)std::max<VkDeviceSize>(1, (StagingSize / 4) / rowPitch);
+
+    if (rowPitch > StagingSize) {
+        EM_ERROR("Image row of %llu bytes does not fit in the staging buffer", (u64)rowPitch);
+        return false;
+    }
+
+    TransitionImage(BeginCommands(), destination, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    // Big images go up a band of rows at a time. Bands may land in different
+    // batches, which is fine: batches execute in submission order on one queue.
+    const u8* source = (const u8*)data;
+    for (u32 row = 0; row < height; row += rowsPerChunk) {
+        u32 rows = std::min(rowsPerChunk, height - row);
+        VkDeviceSize chunk = rowPitch * rows;
+        VkDeviceSize stagingOffset;
+
+        if (!AllocateStaging(chunk, std::max<VkDeviceSize>(STAGING_COPY_ALIGNMENT, texelSize), stagingOffset)) {
+            EM_ERROR("Upload of %llu bytes does not fit in the staging buffer", (u64)chunk);
+            return false;
+        }
+
+        memcpy(StagingMapped + stagingOffset, source + rowPitch * row, (size_t)chunk);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset = stagingOffset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, (i32)row, 0};
+        region.imageExtent = {width, rows, 1};
+
+        vkCmdCopyBufferToImage(BeginCommands(), StagingBuffer, destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    // The transfer queue may not know fragment stages; the semaphore the
+    // graphics submit waits on makes the writes visible there.
+    TransitionImage(BeginCommands(), destination, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    VK_ACCESS_TRANSFER_WRITE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    return true;
+}
+
+bool UploadQueue::AllocateStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset) {
+    if (size > StagingSize) {
+        return false;
+    }
+
+    while (true) {
+        // Open the batch that will own this space first; doing so may retire an old one.
+        BeginCommands();
+
+        VkDeviceSize aligned = AlignUp(StagingHead, alignment);
+        VkDeviceSize padding = aligned - StagingHead;
+
+        // Not enough room before the end: skip the tail and wrap to the start.
+        if (aligned + size > StagingSize) {
+            padding = StagingSize - StagingHead;
+            aligned = 0;
+        }
+
+        if (StagingUsed + padding + size <= StagingSize) {
+            StagingHead = aligned + size;
+            StagingUsed += padding + size;
+            Batches[CurrentBatch].StagingUsed += padding + size;
+            offset = aligned;
+            return true;
+        }
+
+        // Ring is full: submit what we have and wait for the oldest batch.
+        if (Recording && Batches[CurrentBatch].StagingUsed > 0) {
+            Flush();
+        }
+
+        if (!RetireOldest(true)) {
+            return false;
+        }
+    }
+}
+
+u64 UploadQueue::Flush() {
+    if (!Recording) {
+        return LastSubmittedTicket;
+    }
+
+    UploadBatch& batch = Batches[CurrentBatch];
+    vkEndCommandBuffer(batch.CommandBuffer);
+
+    batch.Ticket = NextTicket++;
+
+    VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.CommandBuffer;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    if (UseTimeline) {
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &batch.Ticket;
+
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &TimelineSemaphore;
+    }
+
+    vkResetFences(Device, 1, &batch.Fence);
+
+    if (vkQueueSubmit(Queue, 1, &submitInfo, batch.Fence) != VK_SUCCESS) {
+        EM_FATAL("Could not submit upload batch");
+    }
+
+    batch.InFlight = true;
+    InFlightCount++;
+    LastSubmittedTicket = batch.Ticket;
+    Recording = false;
+    CurrentBatch = (CurrentBatch + 1) % UPLOAD_BATCH_COUNT;
+
+    return batch.Ticket;
+}
+
+bool UploadQueue::RetireOldest(bool wait) {
+    if (InFlightCount == 0) {
+        return false;
+    }
+
+    UploadBatch& batch = Batches[OldestBatch];
+
+    if (wait) {
+        vkWaitForFences(Device, 1, &batch.Fence, VK_TRUE, UINT64_MAX);
+    } else if (vkGetFenceStatus(Device, batch.Fence) != VK_SUCCESS) {
+        return false;
+    }
+
+    StagingUsed -= batch.StagingUsed;
+    if (StagingUsed == 0) {
+        StagingHead = 0;
+    }
+
+    LastCompletedTicket = batch.Ticket;
+    batch.InFlight = false;
+    InFlightCount--;
+    OldestBatch = (OldestBatch + 1) % UPLOAD_BATCH_COUNT;
+
+    return true;
+}
+
+void UploadQueue::RetireCompleted() {
+    while (RetireOldest(false)) {
+    }
+}
+
+bool UploadQueue::IsComplete(u64 ticket) {
+    RetireCompleted();
+    return ticket <= LastCompletedTicket;
+}
+
+void UploadQueue::Wait(u64 ticket) {
+    while (ticket > LastCompletedTicket && RetireOldest(true)) {
+    }
+}
+
+bool UploadQueue::TakeGraphicsWait(VkSemaphore& semaphore, u64& value) {
+    if (LastSubmittedTicket == LastGraphicsWaitTicket) {
+        return false;
+    }
+
+    LastGraphicsWaitTicket = LastSubmittedTicket;
+
+    if (!UseTimeline) {
+        // No timeline semaphores: the CPU waits for the uploads instead.
+        Wait(LastSubmittedTicket);
+        return false;
+    }
+
+    semaphore = TimelineSemaphore;
+    value = LastSubmittedTicket;
+    return true;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vulkan/vulkan.h>
+
+const u32 UPLOAD_BATCH_COUNT = 8;
+
+// Batches CPU -> GPU copies through a persistent staging ring buffer.
+// Copies are recorded into the current batch and submitted together on
+// Flush; completion is tracked per batch with a fence, and (when timeline
+// semaphores are available) the graphics queue waits on the GPU instead of
+// the CPU ever blocking the queue.
+class UploadQueue {
+public:
+    bool Initialize(VkDevice device, VkQueue queue, u32 queueFamily, VkBuffer stagingBuffer, void* stagingMapped, VkDeviceSize stagingSize, bool useTimeline);
+    void Shutdown();
+
+    bool UploadBuffer(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size);
+
+    // Fills a whole 2D image from tightly packed texels and leaves it in
+    // SHADER_READ_ONLY_OPTIMAL. The image must be in UNDEFINED layout.
+    bool UploadImage(VkImage destination, u32 width, u32 height, u32 texelSize, const void* data);
+
+    // Submits the copies recorded so far. Returns the batch ticket, or the
+    // last submitted ticket when there was nothing to submit.
+    u64 Flush();
+
+    void RetireCompleted();
+    bool IsComplete(u64 ticket);
+    void Wait(u64 ticket);
+
+    // Timeline semaphore and value the next graphics submit must wait on;
+    // returns false when nothing new was submitted since the last call.
+    bool TakeGraphicsWait(VkSemaphore& semaphore, u64& value);
+
+    VkCommandBuffer BeginCommands();
+
+private:
+    struct UploadBatch {
+        VkCommandBuffer CommandBuffer;
+        VkFence Fence;
+        uint64_t Ticket;
+        VkDeviceSize StagingUsed;
+        bool InFlight;
+    };
+
+    bool AllocateStaging(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    bool RetireOldest(bool wait);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkQueue Queue = VK_NULL_HANDLE;
+    VkCommandPool CommandPool = VK_NULL_HANDLE;
+    VkSemaphore TimelineSemaphore = VK_NULL_HANDLE;
+    bool UseTimeline = false;
+
+    VkBuffer StagingBuffer = VK_NULL_HANDLE;
+    u8* StagingMapped = nullptr;
+    VkDeviceSize StagingSize = 0;
+    VkDeviceSize StagingHead = 0;
+    VkDeviceSize StagingUsed = 0;
+
+    UploadBatch Batches[UPLOAD_BATCH_COUNT];
+    u32 CurrentBatch = 0;
+    u32 OldestBatch = 0;
+    u32 InFlightCount = 0;
+    bool Recording = false;
+
+    u64 NextTicket = 1;
+    u64 LastSubmittedTicket = 0;
+    u64 LastCompletedTicket = 0;
+    u64 LastGraphicsWaitTicket = 0;
+};
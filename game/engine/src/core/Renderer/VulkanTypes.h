@@ -3,6 +3,18 @@
 #include "core/Logger/Logger.h"
 #include "core/Window/Window.h"
 #include "defines.h"
+#include "GpuAllocator.h"
+#include "UploadQueue.h"
+#include "PipelineCache.h"
+#include "PipelineLibrary.h"
+#include "DescriptorAllocator.h"
+#include "FrameArena.h"
+#include "CommandRecorder.h"
+#include "TextureTable.h"
+#include "RenderGraph.h"
+#include "GpuProfiler.h"
+#include "GpuCulling.h"
+#include <vendor/glm/glm/glm.hpp>
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <optional>
@@ -11,6 +23,7 @@ struct QueueFamilyIndices
 {
     std::optional<u32> GraphicsFamily;
     std::optional<u32> PresentFamily;
+    std::optional<u32> TransferFamily;
 
      bool IsComplete() {
         return GraphicsFamily.has_value() && PresentFamily.has_value();
@@ -23,47 +36,116 @@ struct VulkanDevice
     VkDevice LogicalDevice;
     VkPhysicalDeviceProperties Properties;
     VkPhysicalDeviceFeatures Features;
+    VkPhysicalDeviceVulkan12Features Features12;
+};
+
+// A swapchain replaced by a resize, kept alive until the frames that
+// rendered to it have completed.
+struct RetiredSwapChain
+{
+    VkSwapchainKHR SwapChain;
+    std::vector<VkImageView> ImageViews;
+    u64 Frame;
+};
+
+// A buffer that frames still in flight may read, destroyed once they complete.
+struct RetiredBuffer
+{
+    VkBuffer Buffer;
+    GpuAllocation Allocation;
+    u64 Frame;
+};
+
+// Device-local geometry of one TileMap chunk: four HalfVertex per quad,
+// drawn with the shared tile index buffer.
+struct TileChunkBuffer
+{
+    VkBuffer Buffer;
+    GpuAllocation Allocation;
+    u32 QuadCount;
+};
+
+// Push constants of TileVert/TileFrag, one set per chunk draw.
+struct TileChunkConstants
+{
+    glm::vec2 Origin;
+    f32 TileSize;
+    u32 Texture;
 };
 
 struct VulkanContext {
     VkInstance Instance;
     VkAllocationCallbacks* Allocator;
     VulkanDevice VulkanDevice;
+    GpuAllocator MemoryAllocator;
     VkQueue GraphicsQueue;
     VkQueue PresentQueue;
+    VkQueue TransferQueue;
+    u32 GraphicsFamily;
+    u32 TransferFamily;
+    UploadQueue Uploads;
+    VkBuffer StagingBuffer;
+    GpuAllocation StagingAllocation;
     VkSurfaceKHR Surface;
     VkSwapchainKHR SwapChain;
     VkDebugUtilsMessengerEXT DebugMessenger;
     std::vector<VkImage> SwapChainImages;
     std::vector<VkImageView> SwapChainImageViews;
+    std::vector<RetiredSwapChain> RetiredSwapChains;
     VkFormat SwapChainImageFormat;
     VkExtent2D SwapChainExtent;
-    VkRenderPass RenderPass;
+    VkRenderPass RenderPass;   // compatible with the graph's backbuffer pass, for pipeline creation
     VkDescriptorSetLayout DescriptorSetLayout;
     VkPipelineLayout PipelineLayout;
-    VkPipeline GraphicsPipeline;
-    std::vector<VkFramebuffer> Framebuffers;
+    PipelineCache PipelineCache;
+    PipelineLibrary Pipelines;
+    RenderGraph Graph;
     VkCommandPool CommandPool;
     std::vector<VkCommandBuffer> CommandBuffers;
+    CommandRecorder Recorder;
     std::vector<VkSemaphore> ImageAvailableSemaphores;
     std::vector<VkSemaphore> RenderFinishedSemaphores;
     std::vector<VkFence> InFlightFences;
     VkBuffer VertexBuffer;
-    VkDeviceMemory VertexBufferMemory;
+    GpuAllocation VertexBufferAllocation;
     VkBuffer IndexBuffer;
-    VkDeviceMemory IndexBufferMemory;
+    GpuAllocation IndexBufferAllocation;
+    VkBuffer TileIndexBuffer;
+    GpuAllocation TileIndexBufferAllocation;
+    std::vector<TileChunkBuffer> TileChunks;
+    std::vector<RetiredBuffer> RetiredBuffers;
     std::vector<VkBuffer> UniformBuffers;
-    std::vector<VkDeviceMemory> UniformBuffersMemory;
+    std::vector<GpuAllocation> UniformBuffersAllocation;
     std::vector<void*> UniformBuffersMapped;
-    VkDescriptorPool DescriptoPool;
+    FrameArena Arena;
+    VkBuffer ArenaBuffer;
+    GpuAllocation ArenaAllocation;
+    std::vector<VkBuffer> ObjectBuffers;
+    std::vector<GpuAllocation> ObjectBuffersAllocation;
+    std::vector<void*> ObjectBuffersMapped;
+    GpuCulling Culling;
+    std::vector<VkBuffer> DrawCommandBuffers;
+    std::vector<GpuAllocation> DrawCommandBuffersAllocation;
+    std::vector<VkBuffer> DrawCountBuffers;
+    std::vector<GpuAllocation> DrawCountBuffersAllocation;
+    DescriptorAllocator Descriptors;
     std::vector<VkDescriptorSet> DescriptorSets;
+    TextureTable Textures;
+    std::vector<GpuAllocation> OffscreenImagesAllocation;
+    GpuProfiler Profiler;
 };
 
+const u32 MAX_SURFACE_FORMATS = 64;
+const u32 MAX_PRESENT_MODES = 16;
+
+// Fixed arrays so a swapchain rebuild doesn't allocate just to query it.
 struct SwapChainSupport
 {
     VkSurfaceCapabilitiesKHR Capabilities;
-    std::vector<VkSurfaceFormatKHR> Formats;
-    std::vector<VkPresentModeKHR> PresentModes;
+    VkSurfaceFormatKHR Formats[MAX_SURFACE_FORMATS];
+    u32 FormatCount;
+    VkPresentModeKHR PresentModes[MAX_PRESENT_MODES];
+    u32 PresentModeCount;
 };
 
 const std::vector<const char*> ValidationLayers = {
@@ -0,0 +1,186 @@
+#include "SpatialGrid.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+#include <cmath>
+
+bool SpatialGrid::Initialize(const glm::vec2& worldMin, const glm::vec2& worldMax, f32 cellSize) {
+    if (cellSize <= 0.0f || worldMax.x <= worldMin.x || worldMax.y <= worldMin.y) {
+        EM_ERROR("Invalid spatial grid bounds or cell size");
+        return false;
+    }
+
+    WorldMin = worldMin;
+    CellSize = cellSize;
+    InverseCellSize = 1.0f / cellSize;
+    Columns = (u32)std::ceil((worldMax.x - worldMin.x) * InverseCellSize);
+    Rows = (u32)std::ceil((worldMax.y - worldMin.y) * InverseCellSize);
+
+    Cells.clear();
+    Cells.resize((size_t)Columns * Rows);
+    Clear();
+
+    return true;
+}
+
+void SpatialGrid::Shutdown() {
+    Cells.clear();
+    Cells.shrink_to_fit();
+    Oversized.clear();
+    Oversized.shrink_to_fit();
+    Slots.clear();
+    Slots.shrink_to_fit();
+    FreeSlot = SPATIAL_GRID_NONE;
+    ObjectCount = 0;
+    Columns = 0;
+    Rows = 0;
+}
+
+// Keeps every array's capacity so refilling the grid does not allocate.
+void SpatialGrid::Clear() {
+    for (std::vector<Entry>& cell : Cells) {
+        cell.clear();
+    }
+    Oversized.clear();
+    Slots.clear();
+    FreeSlot = SPATIAL_GRID_NONE;
+    ObjectCount = 0;
+}
+
+u32 SpatialGrid::FindCell(const glm::vec2& min, const glm::vec2& max) const {
+    glm::vec2 halfSize = (max - min) * 0.5f;
+    if (halfSize.x > CellSize * 0.5f || halfSize.y > CellSize * 0.5f) {
+        return SPATIAL_GRID_NONE;
+    }
+
+    glm::vec2 cell = (min + halfSize - WorldMin) * InverseCellSize;
+    if (cell.x < 0.0f || cell.y < 0.0f || cell.x >= (f32)Columns || cell.y >= (f32)Rows) {
+        return SPATIAL_GRID_NONE;
+    }
+
+    return (u32)cell.y * Columns + (u32)cell.x;
+}
+
+void SpatialGrid::AddEntry(u32 cell, const Entry& entry) {
+    std::vector<Entry>& entries = GetCell(cell);
+
+    Slot& slot = Slots[entry.Handle];
+    slot.Cell = cell;
+    slot.Index = (u32)entries.size();
+
+    entries.push_back(entry);
+}
+
+// Swap-removes so cells stay dense; the moved entry's slot follows it.
+void SpatialGrid::RemoveEntry(u32 cell, u32 index) {
+    std::vector<Entry>& entries = GetCell(cell);
+
+    if (index + 1 < entries.size()) {
+        entries[index] = entries.back();
+        Slots[entries[index].Handle].Index = index;
+    }
+    entries.pop_back();
+}
+
+u32 SpatialGrid::Insert(const glm::vec2& min, const glm::vec2& max, u32 userData) {
+    u32 handle = FreeSlot;
+    if (handle != SPATIAL_GRID_NONE) {
+        FreeSlot = Slots[handle].Index;
+    } else {
+        handle = (u32)Slots.size();
+        Slots.push_back({});
+    }
+
+    Slots[handle].Used = true;
+    AddEntry(FindCell(min, max), {min, max, userData, handle});
+    ObjectCount++;
+
+    return handle;
+}
+
+void SpatialGrid::Move(u32 handle, const glm::vec2& min, const glm::vec2& max) {
+    if (handle >= Slots.size() || !Slots[handle].Used) {
+        EM_WARN("Moving an invalid spatial grid handle %u", handle);
+        return;
+    }
+
+    Slot& slot = Slots[handle];
+    u32 cell = FindCell(min, max);
+    std::vector<Entry>& entries = GetCell(slot.Cell);
+
+    if (cell == slot.Cell) {
+        entries[slot.Index].Min = min;
+        entries[slot.Index].Max = max;
+        return;
+    }
+
+    u32 userData = entries[slot.Index].UserData;
+    RemoveEntry(slot.Cell, slot.Index);
+    AddEntry(cell, {min, max, userData, handle});
+}
+
+void SpatialGrid::Remove(u32 handle) {
+    if (handle >= Slots.size() || !Slots[handle].Used) {
+        EM_WARN("Removing an invalid spatial grid handle %u", handle);
+        return;
+    }
+
+    Slot& slot = Slots[handle];
+    RemoveEntry(slot.Cell, slot.Index);
+
+    slot.Used = false;
+    slot.Index = FreeSlot;
+    FreeSlot = handle;
+    ObjectCount--;
+}
+
+u32 SpatialGrid::Query(const glm::vec2& min, const glm::vec2& max, std::vector<u32>& results) const {
+    size_t first = results.size();
+
+    for (const Entry& entry : Oversized) {
+        if (entry.Min.x <= max.x && entry.Max.x >= min.x && entry.Min.y <= max.y && entry.Max.y >= min.y) {
+            results.push_back(entry.UserData);
+        }
+    }
+
+    // Widen by the half cell that cell contents may spill over.
+    glm::vec2 looseMin = (min - WorldMin) * InverseCellSize - 0.5f;
+    glm::vec2 looseMax = (max - WorldMin) * InverseCellSize + 0.5f;
+
+    if (looseMax.x < 0.0f || looseMax.y < 0.0f || looseMin.x >= (f32)Columns || looseMin.y >= (f32)Rows) {
+        return (u32)(results.size() - first);
+    }
+
+    u32 x0 = (u32)std::max(looseMin.x, 0.0f);
+    u32 y0 = (u32)std::max(looseMin.y, 0.0f);
+    u32 x1 = (u32)std::min(looseMax.x, (f32)(Columns - 1));
+    u32 y1 = (u32)std::min(looseMax.y, (f32)(Rows - 1));
+
+    for (u32 y = y0; y <= y1; y++) {
+        for (u32 x = x0; x <= x1; x++) {
+            for (const Entry& entry : Cells[y * Columns + x]) {
+                if (entry.Min.x <= max.x && entry.Max.x >= min.x && entry.Min.y <= max.y && entry.Max.y >= min.y) {
+                    results.push_back(entry.UserData);
+                }
+            }
+        }
+    }
+
+    return (u32)(results.size() - first);
+}
+
+SpatialGridStats SpatialGrid::GetStats() const {
+    SpatialGridStats stats{};
+    stats.ObjectCount = ObjectCount;
+    stats.CellCount = (u32)Cells.size();
+    stats.OversizedObjects = (u32)Oversized.size();
+
+    for (const std::vector<Entry>& cell : Cells) {
+        if (!cell.empty()) {
+            stats.OccupiedCells++;
+            stats.MaxCellObjects = std::max(stats.MaxCellObjects, (u32)cell.size());
+        }
+    }
+
+    return stats;
+}
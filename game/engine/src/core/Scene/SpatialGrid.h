@@ -0,0 +1,76 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vector>
+
+const u32 SPATIAL_GRID_NONE = ~0u;
+
+struct SpatialGridStats {
+    u32 ObjectCount;
+    u32 CellCount;
+    u32 OccupiedCells;
+    u32 MaxCellObjects;
+    u32 OversizedObjects;
+};
+
+// Loose uniform grid over axis-aligned rectangles, for view culling and
+// proximity queries. An object lives in the cell holding its center, and a
+// cell's contents may spill up to half a cell past its edges, so a query
+// only has to widen its rectangle by half a cell to find everything. Objects
+// larger than a cell or centered outside the world go to a separate list
+// that every query scans.
+//
+// Each cell keeps its objects' bounds inline in one array, so a query reads
+// memory linearly; handles stay stable across moves and removals.
+class SpatialGrid {
+public:
+    bool Initialize(const glm::vec2& worldMin, const glm::vec2& worldMax, f32 cellSize);
+    void Shutdown();
+    void Clear();
+
+    u32 Insert(const glm::vec2& min, const glm::vec2& max, u32 userData);
+    // Updates in place when the object stays in its cell, which is the common case.
+    void Move(u32 handle, const glm::vec2& min, const glm::vec2& max);
+    void Remove(u32 handle);
+
+    // Appends the user data of every object overlapping the rectangle (edges
+    // included) and returns how many were added.
+    u32 Query(const glm::vec2& min, const glm::vec2& max, std::vector<u32>& results) const;
+
+    u32 GetObjectCount() const { return ObjectCount; }
+    SpatialGridStats GetStats() const;
+
+private:
+    struct Entry {
+        glm::vec2 Min;
+        glm::vec2 Max;
+        u32 UserData;
+        u32 Handle;
+    };
+
+    struct Slot {
+        u32 Cell;    // SPATIAL_GRID_NONE for the oversized list
+        u32 Index;   // position in the cell, or the next free slot
+        bool Used;
+    };
+
+    u32 FindCell(const glm::vec2& min, const glm::vec2& max) const;
+    std::vector<Entry>& GetCell(u32 cell) { return cell == SPATIAL_GRID_NONE ? Oversized : Cells[cell]; }
+    void AddEntry(u32 cell, const Entry& entry);
+    void RemoveEntry(u32 cell, u32 index);
+
+    glm::vec2 WorldMin = glm::vec2(0.0f);
+    f32 CellSize = 1.0f;
+    f32 InverseCellSize = 1.0f;
+    u32 Columns = 0;
+    u32 Rows = 0;
+
+    std::vector<std::vector<Entry>> Cells;
+    std::vector<Entry> Oversized;
+
+    std::vector<Slot> Slots;
+    u32 FreeSlot = SPATIAL_GRID_NONE;
+    u32 ObjectCount = 0;
+};
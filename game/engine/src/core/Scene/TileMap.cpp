@@ -0,0 +1,169 @@
+#include "TileMap.h"
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <algorithm>
+#include <cmath>
+
+bool TileMap::Initialize(u32 width, u32 height, f32 tileSize, const glm::vec2& origin) {
+    if (width == 0 || height == 0 || tileSize <= 0.0f) {
+        EM_ERROR("Invalid tile map size");
+        return false;
+    }
+
+    Width = width;
+    Height = height;
+    TileSize = tileSize;
+    Origin = origin;
+    ChunkColumns = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    ChunkRows = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+
+    Tiles.assign((size_t)width * height, TILE_EMPTY);
+    Dirty.assign(GetChunkCount(), false);
+    DirtyChunks.clear();
+    DirtyChunks.reserve(GetChunkCount());
+    MarkAllDirty();
+
+    return true;
+}
+
+void TileMap::Shutdown() {
+    Tiles.clear();
+    Tiles.shrink_to_fit();
+    Dirty.clear();
+    Dirty.shrink_to_fit();
+    DirtyChunks.clear();
+    DirtyChunks.shrink_to_fit();
+    Width = 0;
+    Height = 0;
+    ChunkColumns = 0;
+    ChunkRows = 0;
+}
+
+void TileMap::SetTileset(u32 texture, u32 columns, u32 rows) {
+    Texture = texture;
+    TilesetColumns = std::max(columns, 1u);
+    TilesetRows = std::max(rows, 1u);
+
+    // Texture is per map, but cell UVs are baked into every chunk.
+    MarkAllDirty();
+}
+
+void TileMap::SetTile(u32 x, u32 y, u16 tile) {
+    if (x >= Width || y >= Height) {
+        return;
+    }
+
+    u16& current = Tiles[(size_t)y * Width + x];
+    if (current == tile) {
+        return;
+    }
+
+    current = tile;
+    MarkDirty((y / TILE_CHUNK_SIZE) * ChunkColumns + x / TILE_CHUNK_SIZE);
+}
+
+u16 TileMap::GetTile(u32 x, u32 y) const {
+    if (x >= Width || y >= Height) {
+        return TILE_EMPTY;
+    }
+
+    return Tiles[(size_t)y * Width + x];
+}
+
+void TileMap::Fill(u16 tile) {
+    std::fill(Tiles.begin(), Tiles.end(), tile);
+    MarkAllDirty();
+}
+
+glm::vec2 TileMap::GetChunkOrigin(u32 chunk) const {
+    u32 column = chunk % ChunkColumns;
+    u32 row = chunk / ChunkColumns;
+
+    return Origin + glm::vec2((f32)(column * TILE_CHUNK_SIZE), (f32)(row * TILE_CHUNK_SIZE)) * TileSize;
+}
+
+u32 TileMap::FindChunks(const glm::vec2& min, const glm::vec2& max, std::vector<u32>& chunks) const {
+    if (ChunkColumns == 0) {
+        return 0;
+    }
+
+    // Clamped in float first, the view can be far larger than the map.
+    f32 chunkSize = TileSize * TILE_CHUNK_SIZE;
+    glm::vec2 first = glm::floor((min - Origin) / chunkSize);
+    glm::vec2 last = glm::floor((max - Origin) / chunkSize);
+    if (last.x < 0.0f || last.y < 0.0f || first.x >= (f32)ChunkColumns || first.y >= (f32)ChunkRows) {
+        return 0;
+    }
+
+    u32 x0 = (u32)std::max(first.x, 0.0f);
+    u32 y0 = (u32)std::max(first.y, 0.0f);
+    u32 x1 = (u32)std::min(last.x, (f32)(ChunkColumns - 1));
+    u32 y1 = (u32)std::min(last.y, (f32)(ChunkRows - 1));
+
+    size_t start = chunks.size();
+    for (u32 y = y0; y <= y1; y++) {
+        for (u32 x = x0; x <= x1; x++) {
+            chunks.push_back(y * ChunkColumns + x);
+        }
+    }
+
+    return (u32)(chunks.size() - start);
+}
+
+u32 TileMap::BuildChunk(u32 chunk, HalfVertex* vertices) const {
+    u32 firstX = (chunk % ChunkColumns) * TILE_CHUNK_SIZE;
+    u32 firstY = (chunk / ChunkColumns) * TILE_CHUNK_SIZE;
+    u32 endX = std::min(firstX + TILE_CHUNK_SIZE, Width);
+    u32 endY = std::min(firstY + TILE_CHUNK_SIZE, Height);
+
+    glm::vec4 white(1.0f);
+    glm::vec2 cellSize(1.0f / TilesetColumns, 1.0f / TilesetRows);
+    u32 cellCount = TilesetColumns * TilesetRows;
+
+    u32 quads = 0;
+    for (u32 y = firstY; y < endY; y++) {
+        const u16* row = &Tiles[(size_t)y * Width];
+        for (u32 x = firstX; x < endX; x++) {
+            u16 tile = row[x];
+            if (tile == TILE_EMPTY) {
+                continue;
+            }
+
+            u32 cell = (u32)(tile - 1) % cellCount;
+            glm::vec2 uvMin = glm::vec2((f32)(cell % TilesetColumns), (f32)(cell / TilesetColumns)) * cellSize;
+            glm::vec2 uvMax = uvMin + cellSize;
+            glm::vec2 local((f32)(x - firstX), (f32)(y - firstY));
+
+            // Counter-clockwise from the bottom left; world space is y-up
+            // while texture rows run top to bottom.
+            HalfVertex* quad = &vertices[quads * 4];
+            quad[0] = PackHalfVertex(local, white, glm::vec2(uvMin.x, uvMax.y));
+            quad[1] = PackHalfVertex(local + glm::vec2(1.0f, 0.0f), white, uvMax);
+            quad[2] = PackHalfVertex(local + glm::vec2(1.0f, 1.0f), white, glm::vec2(uvMax.x, uvMin.y));
+            quad[3] = PackHalfVertex(local + glm::vec2(0.0f, 1.0f), white, uvMin);
+            quads++;
+        }
+    }
+
+    return quads;
+}
+
+void TileMap::ClearDirty() {
+    for (u32 chunk : DirtyChunks) {
+        Dirty[chunk] = false;
+    }
+    DirtyChunks.clear();
+}
+
+void TileMap::MarkDirty(u32 chunk) {
+    if (!Dirty[chunk]) {
+        Dirty[chunk] = true;
+        DirtyChunks.push_back(chunk);
+    }
+}
+
+void TileMap::MarkAllDirty() {
+    for (u32 chunk = 0; chunk < GetChunkCount(); chunk++) {
+        MarkDirty(chunk);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "core/Math/Vertex.h"
+#include "defines.h"
+#include <vendor/glm/glm/glm.hpp>
+#include <vector>
+
+const u32 TILE_CHUNK_SIZE = 32;   // tiles along each side of a chunk
+const u32 TILE_CHUNK_MAX_QUADS = TILE_CHUNK_SIZE * TILE_CHUNK_SIZE;
+const u16 TILE_EMPTY = 0;
+
+STATIC_ASSERT(TILE_CHUNK_MAX_QUADS * 4 <= 65536, "Expected a full tile chunk to be addressable with 16-bit indices.");
+
+// Grid of tiles split into TILE_CHUNK_SIZE square chunks, which are the unit
+// the renderer caches geometry for. Tile (x, y) covers
+// origin + [x, x + 1] * tileSize in y-up world space. A tile value t other
+// than TILE_EMPTY draws cell t - 1 of the tileset, counted left to right
+// from the top row of the texture.
+//
+// Changing a tile only marks its chunk dirty; the renderer rebuilds dirty
+// chunks on its next Draw and leaves every other chunk's buffer alone.
+class TileMap {
+public:
+    bool Initialize(u32 width, u32 height, f32 tileSize, const glm::vec2& origin = glm::vec2(0.0f));
+    void Shutdown();
+
+    // Texture is a bindless index from Renderer::CreateTexture.
+    void SetTileset(u32 texture, u32 columns, u32 rows);
+    void SetTile(u32 x, u32 y, u16 tile);
+    u16 GetTile(u32 x, u32 y) const;
+    void Fill(u16 tile);
+
+    u32 GetWidth() const { return Width; }
+    u32 GetHeight() const { return Height; }
+    f32 GetTileSize() const { return TileSize; }
+    u32 GetTexture() const { return Texture; }
+    u32 GetChunkCount() const { return ChunkColumns * ChunkRows; }
+    glm::vec2 GetChunkOrigin(u32 chunk) const;
+
+    // Appends the chunks overlapping the rectangle and returns how many were added.
+    u32 FindChunks(const glm::vec2& min, const glm::vec2& max, std::vector<u32>& chunks) const;
+
+    // Writes four vertices per non-empty tile of the chunk, in tile units
+    // from the chunk's origin, and returns the number of quads. vertices must
+    // hold TILE_CHUNK_MAX_QUADS * 4.
+    u32 BuildChunk(u32 chunk, HalfVertex* vertices) const;
+
+    // Chunks changed since the last ClearDirty, each listed once.
+    const std::vector<u32>& GetDirtyChunks() const { return DirtyChunks; }
+    void ClearDirty();
+
+private:
+    void MarkDirty(u32 chunk);
+    void MarkAllDirty();
+
+    u32 Width = 0;
+    u32 Height = 0;
+    f32 TileSize = 1.0f;
+    glm::vec2 Origin = glm::vec2(0.0f);
+    u32 ChunkColumns = 0;
+    u32 ChunkRows = 0;
+
+    u32 Texture = 0;
+    u32 TilesetColumns = 1;
+    u32 TilesetRows = 1;
+
+    std::vector<u16> Tiles;
+    std::vector<u32> DirtyChunks;
+    std::vector<bool> Dirty;
+};
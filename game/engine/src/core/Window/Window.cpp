@@ -1,13 +1,17 @@
 #include "Window.h"
 #include "core/Logger/Logger.h"
 #include "defines.h"
+#include <stdlib.h>
+
+#if EM_PLATFORM_WINDOWS
 #include <windows.h>
 #include <windowsx.h>
-#include <stdlib.h>
-#define GLFW_INCLUDE_VULKAN
-#include <vendor/GLFW/glfw3.h>
 
 LRESULT CALLBACK WindowProc(HWND hwnd, u32 msg, WPARAM w_param, LPARAM l_param);
+#endif
+
+#define GLFW_INCLUDE_VULKAN
+#include <vendor/GLFW/glfw3.h>
 
 Window::Window(/* args */) {
     EM_INFO("Constructing window");
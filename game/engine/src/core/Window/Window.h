@@ -1,19 +1,29 @@
 #pragma once
 
-#include <windows.h>
-#include <windowsx.h>
+#include "core/Logger/Logger.h"
+#include "defines.h"
 #include <stdlib.h>
 #include <vulkan/vulkan.h>
+
+#if EM_PLATFORM_WINDOWS
+#include <windows.h>
+#include <windowsx.h>
 #include <vulkan/vulkan_win32.h>
+#endif
+
 #define GLFW_INCLUDE_VULKAN
 #include <vendor/GLFW/glfw3.h>
+
+#if EM_PLATFORM_WINDOWS
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <vendor/GLFW/glfw3native.h>
+#endif
 
 struct WindowState {
     GLFWwindow* GlfwWindow;
     VkSurfaceKHR Surface;
 
+#if EM_PLATFORM_WINDOWS
     HWND GetHWND()
     {
         return glfwGetWin32Window(GlfwWindow);
@@ -23,6 +33,7 @@ struct WindowState {
     {
         return GetModuleHandle(nullptr);
     }
+#endif
 };
 
 class Window {
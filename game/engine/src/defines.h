@@ -83,6 +83,16 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected f64 to be 8 bytes.");
 #define LOG_TRACE_ENABLED 0
 #endif
 
+// Global operator new/delete replacement that counts heap traffic and
+// guards steady-state frames (see core/Memory/AllocationHook.h).
+#ifndef EM_ALLOCATION_HOOK
+#if EM_RELEASE == 1
+#define EM_ALLOCATION_HOOK 0
+#else
+#define EM_ALLOCATION_HOOK 1
+#endif
+#endif
+
 #define EM_FATAL(message, ...) {\
     Logger::Log(LogLevel::LOG_LEVEL_FATAL , message, ##__VA_ARGS__);\
 }
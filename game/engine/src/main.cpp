@@ -1,22 +1,55 @@
 #include <iostream>
+#include "core/Jobs/JobSystem.h"
 #include "core/Logger/Logger.h"
+#include "core/Loop/GameLoop.h"
+#include "core/Memory/AllocationHook.h"
+#include "core/Memory/Memory.h"
 #include "core/Renderer/Renderer.h"
 #include "defines.h"
 #include "core/Window/Window.h"
 #include "core/Input/InputHandler.h"
 #include <windows.h>
+#include <vendor/glm/glm/gtc/matrix_transform.hpp>
 
 const i32 WIDTH = 800;
 const i32 HEIGHT = 600;
 const i32 SPRITE_SIZE = 64;
+const f32 DEMO_QUAD_SIZE = 256.0f;
+const f64 SUSPENDED_WAIT_SECONDS = 0.1;
+
+// Simulation state; the loop keeps the last two ticks' and draws between them.
+struct DemoState {
+    f32 Angle;
+};
+
+static void StepDemo(DemoState& state, f64 seconds) {
+    state.Angle += (f32)seconds * glm::radians(90.0f);
+}
+
+static LoopActivity GetWindowActivity(GLFWwindow* window) {
+    if (glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
+        return LOOP_SUSPENDED;
+    }
+
+    return glfwGetWindowAttrib(window, GLFW_FOCUSED) ? LOOP_ACTIVE : LOOP_BACKGROUND;
+}
 
 int WINAPI main() {
 
     Window mainWindow;
     Renderer mainRenderer;
+    JobSystem jobs;
 
+    if (!Memory::Initialize()) {
+        return -1;
+    }
 
-    if (!mainWindow.Open("Splintered - Vulkan", 0, 0, 800, 600)) {
+    if (!jobs.Initialize()) {
+        return -1;
+    }
+    mainRenderer.Jobs = &jobs;
+
+    if (!mainWindow.Open("Splintered - Vulkan", 0, 0, WIDTH, HEIGHT)) {
         return -1;
     }
 
@@ -26,12 +59,72 @@ int WINAPI main() {
 
     Input::Init(mainWindow.State.GlfwWindow);
 
+    // Poll again right before the camera is written so input reaches the screen a frame sooner.
+    mainRenderer.LateUpdate = [] { Input::Handle(); };
+
+    u32 checker[8 * 8];
+    for (u32 i = 0; i < 8 * 8; i++) {
+        checker[i] = ((i % 8) + (i / 8)) % 2 ? 0xffffffff : 0xff404040;
+    }
+    u32 checkerTexture = mainRenderer.CreateTexture(checker, 8, 8);
+
+    GameLoop loop;
+    loop.Initialize();
+
+    // Sleep off whatever the display can't show; MAILBOX and IMMEDIATE would otherwise spin.
+    const GLFWvidmode* videoMode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    loop.SetFrameRateLimits(videoMode != nullptr ? (f64)videoMode->refreshRate : 0.0);
+    mainRenderer.SetFrameRateLimit(loop.GetFrameRateLimit());
+
+    DemoState previous{};
+    DemoState current{};
+
+    // Once warmed up, frames must not touch the heap; report whatever does.
+    AllocationHook::SetGuard(ALLOCATION_GUARD_REPORT);
+
     while(!glfwWindowShouldClose(mainWindow.State.GlfwWindow)) 
     {
         Input::Handle();
+
+        if (loop.SetActivity(GetWindowActivity(mainWindow.State.GlfwWindow))) {
+            mainRenderer.SetFrameRateLimit(loop.GetFrameRateLimit());
+        }
+        if (loop.GetActivity() == LOOP_SUSPENDED) {
+            glfwWaitEventsTimeout(SUSPENDED_WAIT_SECONDS);
+            continue;
+        }
+
+        u32 ticks = loop.BeginFrame();
+        for (u32 i = 0; i < ticks; i++) {
+            previous = current;
+            StepDemo(current, loop.GetTickSeconds());
+        }
+
+        for (i32 y = 0; y < HEIGHT / SPRITE_SIZE; y++) {
+            for (i32 x = 0; x < WIDTH / SPRITE_SIZE; x++) {
+                Sprite sprite{};
+                sprite.Position = glm::vec2((x + 0.5f) * SPRITE_SIZE, (y + 0.5f) * SPRITE_SIZE);
+                sprite.Size = glm::vec2(SPRITE_SIZE - 4.0f);
+                sprite.Color = PackColor(glm::vec4((f32)x / (WIDTH / SPRITE_SIZE), (f32)y / (HEIGHT / SPRITE_SIZE), 0.5f, 0.5f));
+                sprite.UV = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+                sprite.Texture = (x + y) % 2 ? checkerTexture : WHITE_TEXTURE;
+                mainRenderer.Sprites.Submit(sprite);
+            }
+        }
+
+        f32 angle = glm::mix(previous.Angle, current.Angle, loop.GetAlpha());
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(WIDTH * 0.5f, HEIGHT * 0.5f, 0.0f));
+        model = glm::rotate(model, angle, glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::scale(model, glm::vec3(DEMO_QUAD_SIZE, DEMO_QUAD_SIZE, 1.0f));
+        mainRenderer.SubmitObject(model);
+
         mainRenderer.Draw();
+        Memory::EndFrame();
     }
 
+    AllocationHook::SetGuard(ALLOCATION_GUARD_OFF);
+
     VkDevice device = mainRenderer.GetLogicalDevice();
     vkDeviceWaitIdle(device);
 
@@ -40,6 +133,10 @@ int WINAPI main() {
     glfwTerminate();
 
     mainRenderer.Shutdown();
+    jobs.Shutdown();
+
+    Memory::LogUsage();
+    Memory::Shutdown();
 
     return 0;
 }
\ No newline at end of file
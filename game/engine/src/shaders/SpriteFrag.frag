@@ -0,0 +1,21 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Texels below this alpha are discarded; 0 keeps everything.
+layout(constant_id = 0) const float ALPHA_CUTOFF = 0.0;
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragUV;
+layout(location = 2) flat in uint fragTexture;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+void main() {
+    outColor = fragColor * texture(textures[nonuniformEXT(fragTexture)], fragUV);
+
+    if (outColor.a < ALPHA_CUTOFF) {
+        discard;
+    }
+}
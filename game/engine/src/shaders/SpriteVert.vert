@@ -0,0 +1,32 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+
+layout(location = 2) in vec2 inSpritePosition;
+layout(location = 3) in vec2 inSpriteSize;
+layout(location = 4) in vec4 inSpriteUV;
+layout(location = 5) in float inSpriteRotation;
+layout(location = 6) in vec4 inSpriteColor;
+layout(location = 7) in uint inSpriteTexture;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragUV;
+layout(location = 2) flat out uint fragTexture;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+void main() {
+    vec2 local = inPosition * inSpriteSize;
+    float s = sin(inSpriteRotation);
+    float c = cos(inSpriteRotation);
+    vec2 world = inSpritePosition + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+    gl_Position = ubo.proj * ubo.view * vec4(world, 0.0, 1.0);
+    fragColor = inSpriteColor;
+    fragTexture = inSpriteTexture;
+    // World space is y-up while texture rows run top to bottom.
+    fragUV = mix(inSpriteUV.xy, inSpriteUV.zw, vec2(inPosition.x + 0.5, 0.5 - inPosition.y));
+}
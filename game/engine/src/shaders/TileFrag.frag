@@ -0,0 +1,20 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform TileChunk {
+    vec2 origin;
+    float tileSize;
+    uint textureIndex;
+} chunk;
+
+void main() {
+    // The tileset index is the same for the whole draw, so no nonuniformEXT.
+    outColor = fragColor * texture(textures[chunk.textureIndex], fragUV);
+}
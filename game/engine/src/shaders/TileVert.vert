@@ -0,0 +1,28 @@
+#version 450
+
+// Chunk geometry is in tile units from the chunk's corner.
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec4 inColor;
+layout(location = 2) in vec2 inUV;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragUV;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(push_constant) uniform TileChunk {
+    vec2 origin;
+    float tileSize;
+    uint textureIndex;
+} chunk;
+
+void main() {
+    vec2 world = chunk.origin + inPosition * chunk.tileSize;
+
+    gl_Position = ubo.proj * ubo.view * vec4(world, 0.0, 1.0);
+    fragColor = inColor;
+    fragUV = inUV;
+}
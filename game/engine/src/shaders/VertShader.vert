@@ -6,12 +6,21 @@ layout(location = 1) in vec3 inColor;
 layout(location = 0) out vec3 fragColor;
 
 layout(binding = 0) uniform UniformBufferObject {
-    mat4 model;
     mat4 view;
     mat4 proj;
 } ubo;
 
+struct ObjectData {
+    mat4 model;
+    vec4 bounds;
+};
+
+layout(std430, binding = 1) readonly buffer ObjectBuffer {
+    ObjectData objects[];
+};
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 0.0, 1.0);
+    mat4 model = objects[gl_InstanceIndex].model;
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 0.0, 1.0);
     fragColor = inColor;
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+REM Build script for the sprite atlas packer
+@ECHO OFF
+SetLocal EnableDelayedExpansion
+
+SET cFilenames=
+FOR /R src %%f in (*.cpp) do (
+    SET cFilenames=!cFilenames! %%f
+)
+
+SET assembly=AtlasPacker
+SET compilerFlags=-g -O2 -Wvarargs -Wall -Werror
+SET includeFlags=-std=c++17 -Isrc -I../../engine/src
+SET linkerFlags=
+SET defines=-D_CRT_SECURE_NO_WARNINGS
+
+ECHO "Building %assembly%%..."
+g++ %cFilenames% %compilerFlags% -o ../../bin/%assembly%.exe %defines% %includeFlags% %linkerFlags%
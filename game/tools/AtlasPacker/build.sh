@@ -0,0 +1,13 @@
+#!/bin/bash
+# Build script for the sprite atlas packer
+set -e
+
+cFilenames="$(find src -type f -name '*.cpp')"
+
+assembly=AtlasPacker
+compilerFlags="-g -O2 -Wvarargs -Wall"
+includeFlags="-std=c++17 -Isrc -I../../engine/src"
+
+mkdir -p ../../bin
+echo "Building $assembly..."
+g++ $cFilenames $compilerFlags -o ../../bin/$assembly $includeFlags
@@ -0,0 +1,100 @@
+#include "MaxRectsPacker.h"
+#include <algorithm>
+
+static bool Contains(const PackRect& outer, const PackRect& inner) {
+    return inner.X >= outer.X && inner.Y >= outer.Y &&
+           inner.X + inner.Width <= outer.X + outer.Width &&
+           inner.Y + inner.Height <= outer.Y + outer.Height;
+}
+
+void MaxRectsPacker::Reset(u32 width, u32 height) {
+    Width = width;
+    Height = height;
+    UsedArea = 0;
+    FreeRects.clear();
+    FreeRects.push_back({0, 0, width, height});
+}
+
+bool MaxRectsPacker::Insert(u32 width, u32 height, PackRect& placed) {
+    u32 bestShortSide = ~0u;
+    u32 bestLongSide = ~0u;
+    bool found = false;
+
+    for (const PackRect& free : FreeRects) {
+        if (free.Width < width || free.Height < height) {
+            continue;
+        }
+
+        u32 leftoverX = free.Width - width;
+        u32 leftoverY = free.Height - height;
+        u32 shortSide = std::min(leftoverX, leftoverY);
+        u32 longSide = std::max(leftoverX, leftoverY);
+
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+            placed = {free.X, free.Y, width, height};
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    SplitFreeRects(placed);
+    PruneFreeRects();
+    UsedArea += (u64)width * height;
+    return true;
+}
+
+f32 MaxRectsPacker::GetOccupancy() const {
+    return (f32)((f64)UsedArea / ((f64)Width * Height));
+}
+
+void MaxRectsPacker::SplitFreeRects(const PackRect& used) {
+    NewFreeRects.clear();
+
+    for (const PackRect& free : FreeRects) {
+        bool overlaps = used.X < free.X + free.Width && used.X + used.Width > free.X &&
+                        used.Y < free.Y + free.Height && used.Y + used.Height > free.Y;
+        if (!overlaps) {
+            NewFreeRects.push_back(free);
+            continue;
+        }
+
+        // Up to four maximal rectangles remain around the used area.
+        if (used.X > free.X) {
+            NewFreeRects.push_back({free.X, free.Y, used.X - free.X, free.Height});
+        }
+        if (used.X + used.Width < free.X + free.Width) {
+            u32 x = used.X + used.Width;
+            NewFreeRects.push_back({x, free.Y, free.X + free.Width - x, free.Height});
+        }
+        if (used.Y > free.Y) {
+            NewFreeRects.push_back({free.X, free.Y, free.Width, used.Y - free.Y});
+        }
+        if (used.Y + used.Height < free.Y + free.Height) {
+            u32 y = used.Y + used.Height;
+            NewFreeRects.push_back({free.X, y, free.Width, free.Y + free.Height - y});
+        }
+    }
+
+    FreeRects.swap(NewFreeRects);
+}
+
+void MaxRectsPacker::PruneFreeRects() {
+    for (size_t i = 0; i < FreeRects.size(); i++) {
+        for (size_t j = i + 1; j < FreeRects.size(); j++) {
+            if (Contains(FreeRects[j], FreeRects[i])) {
+                FreeRects.erase(FreeRects.begin() + i);
+                i--;
+                break;
+            }
+            if (Contains(FreeRects[i], FreeRects[j])) {
+                FreeRects.erase(FreeRects.begin() + j);
+                j--;
+            }
+        }
+    }
+}
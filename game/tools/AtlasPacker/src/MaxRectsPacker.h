@@ -0,0 +1,33 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <vector>
+
+struct PackRect {
+    u32 X;
+    u32 Y;
+    u32 Width;
+    u32 Height;
+};
+
+// MaxRects bin packer (Jukka Jylänki, "A Thousand Ways to Pack the Bin")
+// using the best-short-side-fit heuristic. Keeps the list of maximal free
+// rectangles; each placement splits every free rectangle it overlaps and
+// prunes the ones contained in another.
+class MaxRectsPacker {
+public:
+    void Reset(u32 width, u32 height);
+    bool Insert(u32 width, u32 height, PackRect& placed);
+    f32 GetOccupancy() const;
+
+private:
+    void SplitFreeRects(const PackRect& used);
+    void PruneFreeRects();
+
+    u32 Width = 0;
+    u32 Height = 0;
+    u64 UsedArea = 0;
+    std::vector<PackRect> FreeRects;
+    std::vector<PackRect> NewFreeRects;
+};
@@ -0,0 +1,440 @@
+#include "Png.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// ---------------------------------------------------------------------------
+// Inflate (RFC 1951)
+
+struct BitReader {
+    const u8* Data;
+    size_t Size;
+    size_t Position;
+    u32 Bits;
+    u32 BitCount;
+
+    bool Need(u32 count) {
+        while (BitCount < count) {
+            if (Position >= Size) {
+                return false;
+            }
+            Bits |= (u32)Data[Position++] << BitCount;
+            BitCount += 8;
+        }
+        return true;
+    }
+
+    bool Read(u32 count, u32& value) {
+        if (count == 0) {
+            value = 0;
+            return true;
+        }
+        if (!Need(count)) {
+            return false;
+        }
+        value = Bits & ((1u << count) - 1);
+        Bits >>= count;
+        BitCount -= count;
+        return true;
+    }
+};
+
+// Canonical Huffman decoding table: counts per code length and the symbols
+// sorted by code.
+struct Huffman {
+    u16 Counts[16];
+    u16 Symbols[320];
+};
+
+static bool BuildHuffman(Huffman& huffman, const u8* lengths, u32 count) {
+    memset(huffman.Counts, 0, sizeof(huffman.Counts));
+    for (u32 i = 0; i < count; i++) {
+        huffman.Counts[lengths[i]]++;
+    }
+    huffman.Counts[0] = 0;
+
+    u16 offsets[16];
+    offsets[1] = 0;
+    for (u32 length = 1; length < 15; length++) {
+        offsets[length + 1] = offsets[length] + huffman.Counts[length];
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        if (lengths[i] != 0) {
+            huffman.Symbols[offsets[lengths[i]]++] = (u16)i;
+        }
+    }
+
+    return true;
+}
+
+static bool DecodeSymbol(BitReader& reader, const Huffman& huffman, u32& symbol) {
+    i32 code = 0;
+    i32 first = 0;
+    i32 index = 0;
+
+    for (u32 length = 1; length < 16; length++) {
+        u32 bit;
+        if (!reader.Read(1, bit)) {
+            return false;
+        }
+
+        code |= (i32)bit;
+        i32 count = huffman.Counts[length];
+        if (code - count < first) {
+            symbol = huffman.Symbols[index + (code - first)];
+            return true;
+        }
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    return false;
+}
+
+static const u16 LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const u8 LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const u16 DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const u8 DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static bool InflateBlock(BitReader& reader, std::vector<u8>& out, const Huffman& lengths, const Huffman& distances) {
+    while (true) {
+        u32 symbol;
+        if (!DecodeSymbol(reader, lengths, symbol)) {
+            return false;
+        }
+
+        if (symbol < 256) {
+            out.push_back((u8)symbol);
+            continue;
+        }
+
+        if (symbol == 256) {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            return false;
+        }
+
+        u32 extra;
+        if (!reader.Read(LENGTH_EXTRA[symbol], extra)) {
+            return false;
+        }
+        u32 length = LENGTH_BASE[symbol] + extra;
+
+        u32 distanceSymbol;
+        if (!DecodeSymbol(reader, distances, distanceSymbol) || distanceSymbol >= 30) {
+            return false;
+        }
+        if (!reader.Read(DISTANCE_EXTRA[distanceSymbol], extra)) {
+            return false;
+        }
+        u32 distance = DISTANCE_BASE[distanceSymbol] + extra;
+
+        if (distance > out.size()) {
+            return false;
+        }
+
+        // Byte by byte: the source range may overlap what we are writing.
+        size_t from = out.size() - distance;
+        for (u32 i = 0; i < length; i++) {
+            out.push_back(out[from + i]);
+        }
+    }
+}
+
+static bool Inflate(const u8* data, size_t size, std::vector<u8>& out) {
+    // zlib wrapper: CMF/FLG header, deflate stream, adler32 (not checked).
+    if (size < 2 || (data[0] & 0x0f) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) {
+        return false;
+    }
+
+    BitReader reader{data, size, 2, 0, 0};
+
+    u32 last = 0;
+    while (!last) {
+        u32 type;
+        if (!reader.Read(1, last) || !reader.Read(2, type)) {
+            return false;
+        }
+
+        if (type == 0) {
+            // Stored block: realign to a byte boundary.
+            reader.Bits = 0;
+            reader.BitCount = 0;
+
+            if (reader.Position + 4 > size) {
+                return false;
+            }
+            u32 length = data[reader.Position] | (data[reader.Position + 1] << 8);
+            reader.Position += 4;
+
+            if (reader.Position + length > size) {
+                return false;
+            }
+            out.insert(out.end(), data + reader.Position, data + reader.Position + length);
+            reader.Position += length;
+        } else if (type == 1) {
+            u8 lengths[288 + 30];
+            for (u32 i = 0; i < 144; i++) lengths[i] = 8;
+            for (u32 i = 144; i < 256; i++) lengths[i] = 9;
+            for (u32 i = 256; i < 280; i++) lengths[i] = 7;
+            for (u32 i = 280; i < 288; i++) lengths[i] = 8;
+            for (u32 i = 0; i < 30; i++) lengths[288 + i] = 5;
+
+            Huffman literals, distances;
+            BuildHuffman(literals, lengths, 288);
+            BuildHuffman(distances, lengths + 288, 30);
+
+            if (!InflateBlock(reader, out, literals, distances)) {
+                return false;
+            }
+        } else if (type == 2) {
+            u32 literalCount, distanceCount, codeLengthCount;
+            if (!reader.Read(5, literalCount) || !reader.Read(5, distanceCount) || !reader.Read(4, codeLengthCount)) {
+                return false;
+            }
+            literalCount += 257;
+            distanceCount += 1;
+            codeLengthCount += 4;
+
+            static const u8 CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+            u8 codeLengths[19] = {};
+            for (u32 i = 0; i < codeLengthCount; i++) {
+                u32 value;
+                if (!reader.Read(3, value)) {
+                    return false;
+                }
+                codeLengths[CODE_LENGTH_ORDER[i]] = (u8)value;
+            }
+
+            Huffman codeLengthHuffman;
+            BuildHuffman(codeLengthHuffman, codeLengths, 19);
+
+            u8 lengths[288 + 32] = {};
+            u32 count = 0;
+            while (count < literalCount + distanceCount) {
+                u32 symbol;
+                if (!DecodeSymbol(reader, codeLengthHuffman, symbol)) {
+                    return false;
+                }
+
+                if (symbol < 16) {
+                    lengths[count++] = (u8)symbol;
+                    continue;
+                }
+
+                u32 repeat;
+                u8 value = 0;
+                if (symbol == 16) {
+                    if (count == 0 || !reader.Read(2, repeat)) {
+                        return false;
+                    }
+                    value = lengths[count - 1];
+                    repeat += 3;
+                } else if (symbol == 17) {
+                    if (!reader.Read(3, repeat)) {
+                        return false;
+                    }
+                    repeat += 3;
+                } else {
+                    if (!reader.Read(7, repeat)) {
+                        return false;
+                    }
+                    repeat += 11;
+                }
+
+                if (count + repeat > literalCount + distanceCount) {
+                    return false;
+                }
+                while (repeat--) {
+                    lengths[count++] = value;
+                }
+            }
+
+            Huffman literals, distances;
+            BuildHuffman(literals, lengths, literalCount);
+            BuildHuffman(distances, lengths + literalCount, distanceCount);
+
+            if (!InflateBlock(reader, out, literals, distances)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PNG
+
+static u32 ReadBigEndian(const u8* data) {
+    return ((u32)data[0] << 24) | ((u32)data[1] << 16) | ((u32)data[2] << 8) | (u32)data[3];
+}
+
+static u8 Paeth(u8 a, u8 b, u8 c) {
+    i32 p = (i32)a + (i32)b - (i32)c;
+    i32 pa = abs(p - (i32)a);
+    i32 pb = abs(p - (i32)b);
+    i32 pc = abs(p - (i32)c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+bool LoadPng(const std::string& path, Image& image, std::string& error) {
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        error = "could not open file";
+        return false;
+    }
+
+    size_t fileSize = (size_t)file.tellg();
+    std::vector<u8> data(fileSize);
+    file.seekg(0);
+    file.read((char*)data.data(), fileSize);
+
+    static const u8 SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if (fileSize < 8 || memcmp(data.data(), SIGNATURE, 8) != 0) {
+        error = "not a PNG file";
+        return false;
+    }
+
+    u32 width = 0, height = 0;
+    u8 bitDepth = 0, colorType = 0, interlace = 0;
+    std::vector<u8> compressed;
+    std::vector<u8> palette;
+    std::vector<u8> paletteAlpha;
+
+    size_t position = 8;
+    while (position + 12 <= fileSize) {
+        u32 length = ReadBigEndian(&data[position]);
+        const u8* type = &data[position + 4];
+        const u8* chunk = &data[position + 8];
+
+        if (position + 12 + (size_t)length > fileSize) {
+            error = "truncated chunk";
+            return false;
+        }
+
+        if (memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+            width = ReadBigEndian(chunk);
+            height = ReadBigEndian(chunk + 4);
+            bitDepth = chunk[8];
+            colorType = chunk[9];
+            interlace = chunk[12];
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            palette.assign(chunk, chunk + length);
+        } else if (memcmp(type, "tRNS", 4) == 0) {
+            paletteAlpha.assign(chunk, chunk + length);
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+
+        position += 12 + length;
+    }
+
+    if (width == 0 || height == 0) {
+        error = "missing IHDR";
+        return false;
+    }
+    if (bitDepth != 8) {
+        error = "only 8-bit images are supported";
+        return false;
+    }
+    if (interlace != 0) {
+        error = "interlaced images are not supported";
+        return false;
+    }
+
+    u32 channels;
+    switch (colorType) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default:
+            error = "unsupported color type";
+            return false;
+    }
+
+    std::vector<u8> raw;
+    raw.reserve((size_t)(width * channels + 1) * height);
+    if (!Inflate(compressed.data(), compressed.size(), raw)) {
+        error = "corrupt image data";
+        return false;
+    }
+
+    size_t stride = (size_t)width * channels;
+    if (raw.size() < (stride + 1) * height) {
+        error = "image data too short";
+        return false;
+    }
+
+    // Undo the per-row filters in place; each row starts with its filter type.
+    std::vector<u8> pixels(stride * height);
+    for (u32 y = 0; y < height; y++) {
+        u8 filter = raw[y * (stride + 1)];
+        const u8* source = &raw[y * (stride + 1) + 1];
+        u8* row = &pixels[y * stride];
+        const u8* previous = y > 0 ? &pixels[(y - 1) * stride] : nullptr;
+
+        for (size_t x = 0; x < stride; x++) {
+            u8 left = x >= channels ? row[x - channels] : 0;
+            u8 up = previous ? previous[x] : 0;
+            u8 upLeft = (previous && x >= channels) ? previous[x - channels] : 0;
+
+            switch (filter) {
+                case 0: row[x] = source[x]; break;
+                case 1: row[x] = source[x] + left; break;
+                case 2: row[x] = source[x] + up; break;
+                case 3: row[x] = source[x] + (u8)(((u32)left + (u32)up) / 2); break;
+                case 4: row[x] = source[x] + Paeth(left, up, upLeft); break;
+                default:
+                    error = "unknown row filter";
+                    return false;
+            }
+        }
+    }
+
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.resize((size_t)width * height * 4);
+
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        u8* out = &image.Pixels[i * 4];
+        const u8* in = &pixels[i * channels];
+
+        switch (colorType) {
+            case 0: out[0] = out[1] = out[2] = in[0]; out[3] = 255; break;
+            case 2: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 255; break;
+            case 4: out[0] = out[1] = out[2] = in[0]; out[3] = in[1]; break;
+            case 6: memcpy(out, in, 4); break;
+            case 3: {
+                size_t entry = in[0];
+                if (entry * 3 + 2 >= palette.size()) {
+                    error = "palette index out of range";
+                    return false;
+                }
+                out[0] = palette[entry * 3];
+                out[1] = palette[entry * 3 + 1];
+                out[2] = palette[entry * 3 + 2];
+                out[3] = entry < paletteAlpha.size() ? paletteAlpha[entry] : 255;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
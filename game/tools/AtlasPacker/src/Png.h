@@ -0,0 +1,17 @@
+#pragma once
+
+#include "core/Logger/Logger.h"
+#include "defines.h"
+#include <string>
+#include <vector>
+
+struct Image {
+    u32 Width = 0;
+    u32 Height = 0;
+    std::vector<u8> Pixels;  // RGBA8, rows top to bottom
+};
+
+// Minimal PNG reader for sprite sources: 8-bit gray, gray+alpha, RGB, RGBA
+// and palette images (with tRNS), non-interlaced. Returns false with a
+// message in error for anything else.
+bool LoadPng(const std::string& path, Image& image, std::string& error);
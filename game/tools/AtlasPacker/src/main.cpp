@@ -0,0 +1,256 @@
+// Offline sprite atlas packer.
+//
+// Usage: AtlasPacker <input dir> <output file> [page size] [padding]
+//
+// Packs every PNG under the input directory into square RGBA8 pages and
+// writes them, together with a name hash table, in the format described in
+// engine/src/core/Renderer/AtlasFormat.h. Sprites are trimmed to their
+// non-transparent bounds and padded with their own edge texels so linear
+// filtering and mipmapping never bleed between neighbours.
+
+#include "Png.h"
+#include "MaxRectsPacker.h"
+#include "core/Renderer/AtlasFormat.h"
+#include <algorithm>
+#include <filesystem>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace fs = std::filesystem;
+
+struct SourceSprite {
+    std::string Name;
+    Image Pixels;
+    u32 TrimX, TrimY, TrimWidth, TrimHeight;
+    u32 Page;
+    PackRect Rect;  // padded rect on the page
+};
+
+// Shrinks the sprite to the bounding box of texels with non-zero alpha.
+// Fully transparent images keep a single texel so they still have a region.
+static void Trim(SourceSprite& sprite) {
+    const Image& image = sprite.Pixels;
+    u32 minX = image.Width, minY = image.Height, maxX = 0, maxY = 0;
+
+    for (u32 y = 0; y < image.Height; y++) {
+        for (u32 x = 0; x < image.Width; x++) {
+            if (image.Pixels[((size_t)y * image.Width + x) * 4 + 3] == 0) {
+                continue;
+            }
+            minX = std::min(minX, x);
+            minY = std::min(minY, y);
+            maxX = std::max(maxX, x);
+            maxY = std::max(maxY, y);
+        }
+    }
+
+    if (minX > maxX) {
+        sprite.TrimX = sprite.TrimY = 0;
+        sprite.TrimWidth = sprite.TrimHeight = 1;
+        return;
+    }
+
+    sprite.TrimX = minX;
+    sprite.TrimY = minY;
+    sprite.TrimWidth = maxX - minX + 1;
+    sprite.TrimHeight = maxY - minY + 1;
+}
+
+// Copies the trimmed sprite into the page and extrudes its border texels
+// into the padding around it.
+static void Blit(const SourceSprite& sprite, u32 padding, u32 pageSize, u8* page) {
+    const Image& image = sprite.Pixels;
+
+    for (u32 y = 0; y < sprite.Rect.Height; y++) {
+        i32 sourceY = (i32)y - (i32)padding;
+        sourceY = std::clamp(sourceY, 0, (i32)sprite.TrimHeight - 1) + (i32)sprite.TrimY;
+
+        for (u32 x = 0; x < sprite.Rect.Width; x++) {
+            i32 sourceX = (i32)x - (i32)padding;
+            sourceX = std::clamp(sourceX, 0, (i32)sprite.TrimWidth - 1) + (i32)sprite.TrimX;
+
+            const u8* from = &image.Pixels[((size_t)sourceY * image.Width + sourceX) * 4];
+            u8* to = &page[((size_t)(sprite.Rect.Y + y) * pageSize + sprite.Rect.X + x) * 4];
+            memcpy(to, from, 4);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printf("usage: AtlasPacker <input dir> <output file> [page size=2048] [padding=2]\n");
+        return 1;
+    }
+
+    fs::path inputDir = argv[1];
+    const char* outputPath = argv[2];
+    u32 pageSize = argc > 3 ? (u32)atoi(argv[3]) : 2048;
+    u32 padding = argc > 4 ? (u32)atoi(argv[4]) : 2;
+
+    if (pageSize == 0 || pageSize > 65535) {
+        printf("page size must be between 1 and 65535\n");
+        return 1;
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(inputDir, ec)) {
+        printf("'%s' is not a directory\n", argv[1]);
+        return 1;
+    }
+
+    // Gather sources in a stable order so repeated runs produce identical files.
+    std::vector<fs::path> paths;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(inputDir)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".png") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    if (paths.empty()) {
+        printf("no PNG files found in '%s'\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<SourceSprite> sprites(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        SourceSprite& sprite = sprites[i];
+        sprite.Name = fs::relative(paths[i], inputDir).replace_extension().generic_string();
+
+        std::string error;
+        if (!LoadPng(paths[i].string(), sprite.Pixels, error)) {
+            printf("%s: %s\n", paths[i].string().c_str(), error.c_str());
+            return 1;
+        }
+        if (sprite.Pixels.Width > 65535 || sprite.Pixels.Height > 65535) {
+            printf("%s: image is too large\n", paths[i].string().c_str());
+            return 1;
+        }
+
+        Trim(sprite);
+    }
+
+    // Largest first packs noticeably tighter with MaxRects.
+    std::vector<u32> order(sprites.size());
+    for (u32 i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        u32 sideA = std::max(sprites[a].TrimWidth, sprites[a].TrimHeight);
+        u32 sideB = std::max(sprites[b].TrimWidth, sprites[b].TrimHeight);
+        return sideA > sideB;
+    });
+
+    // Pack into the first page with room, opening new pages as needed.
+    std::vector<MaxRectsPacker> pages;
+    for (u32 index : order) {
+        SourceSprite& sprite = sprites[index];
+        u32 width = sprite.TrimWidth + padding * 2;
+        u32 height = sprite.TrimHeight + padding * 2;
+
+        if (width > pageSize || height > pageSize) {
+            printf("%s: %ux%u (with padding) does not fit a %u page\n", sprite.Name.c_str(), width, height, pageSize);
+            return 1;
+        }
+
+        bool placed = false;
+        for (u32 page = 0; page < pages.size() && !placed; page++) {
+            if (pages[page].Insert(width, height, sprite.Rect)) {
+                sprite.Page = page;
+                placed = true;
+            }
+        }
+
+        if (!placed) {
+            pages.emplace_back();
+            pages.back().Reset(pageSize, pageSize);
+            pages.back().Insert(width, height, sprite.Rect);
+            sprite.Page = (u32)pages.size() - 1;
+        }
+    }
+
+    if (pages.size() > 65535) {
+        printf("too many pages\n");
+        return 1;
+    }
+
+    // Lookup table: open addressing at no more than half load.
+    u32 tableSize = 1;
+    while (tableSize < sprites.size() * 2) {
+        tableSize <<= 1;
+    }
+
+    std::vector<AtlasFileEntry> table(tableSize);
+    memset(table.data(), 0, table.size() * sizeof(AtlasFileEntry));
+
+    for (const SourceSprite& sprite : sprites) {
+        u64 hash = HashSpriteName(sprite.Name.c_str());
+        u32 slot = (u32)hash & (tableSize - 1);
+
+        while (table[slot].NameHash != 0) {
+            if (table[slot].NameHash == hash) {
+                printf("%s: name hash collides with another sprite, rename one of them\n", sprite.Name.c_str());
+                return 1;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        AtlasFileEntry& entry = table[slot];
+        entry.NameHash = hash;
+        entry.Page = (u16)sprite.Page;
+        entry.X = (u16)(sprite.Rect.X + padding);
+        entry.Y = (u16)(sprite.Rect.Y + padding);
+        entry.Width = (u16)sprite.TrimWidth;
+        entry.Height = (u16)sprite.TrimHeight;
+        entry.TrimX = (u16)sprite.TrimX;
+        entry.TrimY = (u16)sprite.TrimY;
+        entry.SourceWidth = (u16)sprite.Pixels.Width;
+        entry.SourceHeight = (u16)sprite.Pixels.Height;
+    }
+
+    FILE* file = fopen(outputPath, "wb");
+    if (!file) {
+        printf("could not open '%s' for writing\n", outputPath);
+        return 1;
+    }
+
+    AtlasFileHeader header{};
+    header.Magic = ATLAS_MAGIC;
+    header.Version = ATLAS_VERSION;
+    header.PageCount = (u32)pages.size();
+    header.PageSize = pageSize;
+    header.EntryCount = (u32)sprites.size();
+    header.TableSize = tableSize;
+    fwrite(&header, sizeof(header), 1, file);
+
+    std::vector<u8> pixels((size_t)pageSize * pageSize * 4);
+    for (u32 page = 0; page < pages.size(); page++) {
+        std::fill(pixels.begin(), pixels.end(), 0);
+        for (const SourceSprite& sprite : sprites) {
+            if (sprite.Page == page) {
+                Blit(sprite, padding, pageSize, pixels.data());
+            }
+        }
+        fwrite(pixels.data(), 1, pixels.size(), file);
+
+        printf("page %u: %.1f%% occupied\n", page, pages[page].GetOccupancy() * 100.0f);
+    }
+
+    fwrite(table.data(), sizeof(AtlasFileEntry), table.size(), file);
+
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed) {
+        printf("failed writing '%s'\n", outputPath);
+        return 1;
+    }
+
+    printf("packed %zu sprites into %zu page(s) of %ux%u\n", sprites.size(), pages.size(), pageSize, pageSize);
+    return 0;
+}